@@ -569,28 +569,53 @@ uint8_t *bpsec_bhsscutl_computeSignature(BpsecSerializeData preamble, Object zco
     }
 
 
-    /* Step 6 - add any remaining ZCO data to the digest. */
-    while((success) && (zcoRemaining > 0))
+    /*
+     * Step 6 - add any remaining ZCO data to the digest. The chunks are
+     *          read ahead and handed to a CSI job, whose worker adds
+     *          each one to the digest while the following chunks are
+     *          being read.
+     */
+    if((success) && (zcoRemaining > 0))
     {
-        if(zcoRemaining < chunkSize)
-        {
-            chunkSize = zcoRemaining;
-            chunkData.len = chunkSize;
-        }
+        csi_job_t *job = csi_job_start(csi_suite, csi_ctx, svc);
+        csi_val_t  nothing;
+        int        inFlight = 0;
 
-        zcoRead = zco_transmit(sdr, &dataReader, chunkSize, (char *) chunkData.contents);
-        if(zcoRead != chunkSize)
+        success = (job != NULL);
+        while((success) && (zcoRemaining > 0 || inFlight > 0))
         {
-            BPSEC_DEBUG_ERR("Read %d bytes, but expected %d.", zcoRead, chunkSize);
-            success = 0;
+            if((zcoRemaining > 0) && (inFlight < CSI_JOB_DEPTH))
+            {
+                if(zcoRemaining < chunkSize)
+                {
+                    chunkSize = zcoRemaining;
+                }
+
+                zcoRead = bpsec_util_zcoChunkSubmit(sdr, &dataReader, chunkSize, job);
+                if(zcoRead != chunkSize)
+                {
+                    BPSEC_DEBUG_ERR("Read %d bytes, but expected %d.", zcoRead, chunkSize);
+                    success = 0;
+                }
+
+                zcoRemaining -= chunkSize;
+                inFlight++;
+            }
+            else if(csi_job_collect(job, &nothing) != 1)
+            {
+                BPSEC_DEBUG_ERR("Error updating signature.", NULL);
+                success = 0;
+            }
+            else
+            {
+                inFlight--;
+            }
         }
-        else if(csi_sign_update(csi_suite, csi_ctx, chunkData, svc) == ERROR)
+
+        if((job != NULL) && (csi_job_end(job) == ERROR))
         {
-            BPSEC_DEBUG_ERR("Error updating signature.", NULL);
             success = 0;
         }
-
-        zcoRemaining -= chunkSize;
     }
 
     /* Step 7 - Cleanup, to include handling error. */
@@ -1708,6 +1708,53 @@ sc_value bpsec_util_keyRetrieve(char *keyName)
 
 
 
+/******************************************************************************
+ * @brief Read the next chunk of a ZCO and submit it to a CSI job.
+ *
+ * @param[in]     sdr        The ION SDR.
+ * @param[in|out] dataReader The ZCO reader.
+ * @param[in]     length     The maximum number of bytes to read.
+ * @param[in]     job        The CSI job that is to process the chunk.
+ *
+ * The chunk is read into a buffer that is handed to the job; the caller may
+ * read and submit further chunks, up to CSI_JOB_DEPTH in all, before
+ * collecting the job's output for this one.  Must be called within an SDR
+ * transaction.
+ *
+ * @retval >0 - The number of bytes read and submitted.
+ * @retval 0  - No more data.
+ * @retval -1 - System error
+ *****************************************************************************/
+
+vast bpsec_util_zcoChunkSubmit(Sdr sdr, ZcoReader *dataReader, uvast length, csi_job_t *job)
+{
+    csi_val_t chunk;
+
+    CHKERR(job);
+    if ((chunk.contents = MTAKE(length)) == NULL)
+    {
+        BPSEC_DEBUG_ERR("Can't allocate buffer of size " UVAST_FIELDSPEC ".", length);
+        return -1;
+    }
+
+    chunk.len = zco_transmit(sdr, dataReader, length, (char *) chunk.contents);
+    if (chunk.len <= 0)
+    {
+        MRELEASE(chunk.contents);
+        return chunk.len;
+    }
+
+    if (csi_job_submit(job, chunk) == ERROR)
+    {
+        BPSEC_DEBUG_ERR("Can't submit chunk to CSI job.", NULL);
+        return -1;
+    }
+
+    return chunk.len;
+}
+
+
+
 /******************************************************************************
  * @brief Encrypt/Decrypt a block held in the SDR.
  *
@@ -1730,6 +1777,9 @@ sc_value bpsec_util_keyRetrieve(char *keyName)
  * is the ciphertext. When performing decryption, the input is the ciphertext
  * and the output is the plaintext.
  *
+ * The caller must be in an SDR transaction.  Each output chunk is written
+ * into the SDR as soon as it is collected from the CSI job.
+ *
  * @todo See if some parms need to be passed in, or if they can be calculated
  *       in the function.
  *
@@ -1744,10 +1794,13 @@ int32_t bpsec_util_sdrBlkConvert(uint32_t suite, uint8_t *csi_ctx,
 							     uvast outputBufLen, Object *outputZco, uint8_t function)
 {
     Sdr          sdr = getIonsdr();
-    csi_val_t    csiInputChunk;
     csi_val_t    csiOutputChunk;
+    csi_job_t    *job = NULL;
+    vast         chunkLen = 0;
     uvast        chunkSize = 0;
     uvast        bytesRemaining = 0;
+    int          inFlight = 0;
+    int          converted = 1;
     Object       outputBuffer = 0;
     uvast        writeOffset = 0;
     SdrUsageSummary    summary;
@@ -1766,6 +1819,8 @@ int32_t bpsec_util_sdrBlkConvert(uint32_t suite, uint8_t *csi_ctx,
     CHKERR(dataReader);
     CHKERR(outputZco);
 
+    *outputZco = 0;
+
     /*
      * Step 1 - Get information about the SDR storage space. If the expected
      *          cipher text length is less than half the available space, we
@@ -1795,36 +1850,34 @@ int32_t bpsec_util_sdrBlkConvert(uint32_t suite, uint8_t *csi_ctx,
      */
     if ((outputBuffer = sdr_malloc(sdr, outputBufLen)) == 0)
     {
-        BPSEC_DEBUG_ERR("Cannot allocate" UVAST_FIELDSPEC " from SDR.", NULL);
+        BPSEC_DEBUG_ERR("Cannot allocate" UVAST_FIELDSPEC " from SDR.", outputBufLen);
         BPSEC_DEBUG_PROC("--> -1", NULL);
         return -1;
     }
 
     if ((*outputZco = zco_create(sdr, ZcoSdrSource, outputBuffer, 0,
-                                 0 - outputBufLen, ZcoOutbound)) == 0)
+                                 0 - outputBufLen, ZcoOutbound)) == 0
+             || *outputZco == (Object) ERROR)
     {
         BPSEC_DEBUG_ERR("Cannot create zco.", NULL);
         sdr_free(sdr, outputBuffer);
+        *outputZco = 0;
         BPSEC_DEBUG_PROC("--> -1", NULL);
         return -1;
     }
 
 
     /*
-     * Step 3 - Set up read buffers to read input text in chunk sizes
-     *          and pass them to the cipher suite until there are no
-     *          more chunks remaining.
+     * Step 3 - Hand the conversion to a CSI job, which will be given the
+     *          input text in chunk sizes until there are no more chunks
+     *          remaining.
      */
-
     chunkSize = blocksize->chunkSize;
     bytesRemaining = blocksize->plaintextLen;
 
-    csiInputChunk.len = chunkSize;
-    if((csiInputChunk.contents = MTAKE(chunkSize)) == NULL)
+    if ((job = csi_job_start(suite, csi_ctx, function)) == NULL)
     {
-        BPSEC_DEBUG_ERR("Can't allocate buffer of size %d.", chunkSize);
-
-        sdr_free(sdr, outputBuffer);
+        BPSEC_DEBUG_ERR("Can't start CSI job.", NULL);
         zco_destroy(sdr, *outputZco);
         *outputZco = 0;
         BPSEC_DEBUG_PROC("--> -1", NULL);
@@ -1834,51 +1887,62 @@ int32_t bpsec_util_sdrBlkConvert(uint32_t suite, uint8_t *csi_ctx,
 
     /*
      * Step 4: Walk through the data object converting input chunks to
-     *         output chunks. We will read an input chunk, pass it to
-     *         the cipher suite for conversion, and then write the
-     *         output to the output buffer.
+     *         output chunks. Input chunks are read ahead and handed to
+     *         a CSI job, whose worker converts them while the following
+     *         chunks are being read; each output chunk is written to the
+     *         output buffer as it is collected.
      */
-    while (bytesRemaining > 0)
+    while (converted && (bytesRemaining > 0 || inFlight > 0))
     {
-         /* Step 4.1 - Catch "final" iteration. */
-         if (bytesRemaining < chunkSize)
-         {
-             chunkSize = bytesRemaining;
-         }
+        /* Step 4.1 - Read and submit an input chunk if the job has room. */
+        if (bytesRemaining > 0 && inFlight < CSI_JOB_DEPTH)
+        {
+            if (bytesRemaining < chunkSize)
+            {
+                chunkSize = bytesRemaining;
+            }
 
-         /* Step 4.2 - Read an input chunk. */
-         csiInputChunk.len = zco_transmit(sdr, dataReader, chunkSize, (char *) csiInputChunk.contents);
-         if (csiInputChunk.len <= 0)
-         {
-             BPSEC_DEBUG_ERR("Can't do priming read of length %d.", chunkSize);
-        	 break;
-         }
+            if ((chunkLen = bpsec_util_zcoChunkSubmit(sdr, dataReader, chunkSize, job)) <= 0)
+            {
+                BPSEC_DEBUG_ERR("Can't read input chunk of length %d.", chunkSize);
+                converted = 0;
+                break;
+            }
 
-         /* Step 4.3 - Pass input to the cipher suite and generate output. */
-         csiOutputChunk = csi_crypt_update(suite, csi_ctx, function, csiInputChunk);
-         if (csiOutputChunk.contents == NULL)
-         {
-            BPSEC_DEBUG_ERR("Could not encrypt input of %d with chunk size of %d.", csiInputChunk.len, chunkSize);
+            bytesRemaining -= chunkLen;
+            inFlight++;
+            continue;
+        }
+
+        /* Step 4.2 - Collect the next output chunk. */
+        if (csi_job_collect(job, &csiOutputChunk) != 1)
+        {
+            BPSEC_DEBUG_ERR("Could not convert input with chunk size of %d.", chunkSize);
+            converted = 0;
             break;
-         }
+        }
+
+        inFlight--;
+
+        /* Step 4.3 - Write output chunk to the output buffer. */
+        if (writeOffset + csiOutputChunk.len > outputBufLen)
+        {
+            BPSEC_DEBUG_ERR("Output exceeds predicted length " UVAST_FIELDSPEC ".", outputBufLen);
+            MRELEASE(csiOutputChunk.contents);
+            converted = 0;
+            break;
+        }
 
-         /* Step 4.4 - Write output chunk to the output buffer. */
         sdr_write(sdr, outputBuffer + writeOffset, (char *) csiOutputChunk.contents, csiOutputChunk.len);
         MRELEASE(csiOutputChunk.contents);
-
-        /* Step 4.5 - Prep for next iteration. */
-        bytesRemaining -= csiInputChunk.len;
         writeOffset += csiOutputChunk.len;
     }
 
-    MRELEASE(csiInputChunk.contents);
-
-    if(bytesRemaining > 0)
+    if (csi_job_end(job) == ERROR || !converted || writeOffset == 0)
     {
-    	result = ERROR;
-    	sdr_free(sdr, outputBuffer);
-    	zco_destroy(sdr, *outputZco);
-    	*outputZco = 0;
+        zco_destroy(sdr, *outputZco);
+        *outputZco = 0;
+        result = -1;
     }
 
     BPSEC_DEBUG_PROC("--> %d", result);
@@ -1924,10 +1988,13 @@ int32_t bpsec_util_fileBlkConvert(uint32_t suite, uint8_t *csi_ctx,
 								  uvast outputBufLen, Object *outputZco, char *filename, uint8_t function)
 {
     Sdr        sdr = getIonsdr();
-    csi_val_t  csiInputChunk;
     csi_val_t  csiOutputChunk;
+    csi_job_t  *job = NULL;
+    vast       chunkLen = 0;
     uvast      chunkSize = 0;
     uvast      bytesRemaining = 0;
+    int        inFlight = 0;
+    int        converted = 1;
     Object     fileRef = 0;
     int        result = 1;
 
@@ -1950,14 +2017,13 @@ int32_t bpsec_util_fileBlkConvert(uint32_t suite, uint8_t *csi_ctx,
 
 
     /*
-     * Step 2 - Set up read buffers to read input text in chunk sizes
-     *          and pass them to the cipher suite until there are no
-     *          more chunks remaining.
+     * Step 2 - Hand the conversion to a CSI job, which will be given the
+     *          input text in chunk sizes until there are no more chunks
+     *          remaining.
      */
-    csiInputChunk.len = chunkSize;
-    if((csiInputChunk.contents = MTAKE(chunkSize)) == NULL)
+    if ((job = csi_job_start(suite, csi_ctx, function)) == NULL)
     {
-        BPSEC_DEBUG_ERR("Can't allocate buffer of size %d.", chunkSize);
+        BPSEC_DEBUG_ERR("Can't start CSI job.", NULL);
         BPSEC_DEBUG_PROC("--> -1", NULL);
         return -1;
     }
@@ -1965,52 +2031,57 @@ int32_t bpsec_util_fileBlkConvert(uint32_t suite, uint8_t *csi_ctx,
 
     /*
      * Step 3: Walk through the data object converting input chunks to
-     *         output chunks. We will read an input chunk, pass it to
-     *         the cipher suite for conversion, and then write the
-     *         output to the output buffer.
+     *         output chunks. Input chunks are read ahead and handed to
+     *         the CSI job, whose worker converts them while the following
+     *         chunks are being read; each output chunk is written to the
+     *         file as it is collected.
      */
-     while (bytesRemaining > 0)
-     {
-         /* Step 3.1 - Catch "final" iteration. */
-         if (bytesRemaining < chunkSize)
-         {
-             chunkSize = bytesRemaining;
-         }
+    while (converted && (bytesRemaining > 0 || inFlight > 0))
+    {
+        /* Step 3.1 - Read and submit an input chunk if the job has room. */
+        if (bytesRemaining > 0 && inFlight < CSI_JOB_DEPTH)
+        {
+            if (bytesRemaining < chunkSize)
+            {
+                chunkSize = bytesRemaining;
+            }
 
-         /* Step 3.2 - Read an input chunk. */
-         csiInputChunk.len = zco_transmit(sdr, dataReader, chunkSize, (char *) csiInputChunk.contents);
-         if (csiInputChunk.len <= 0)
-         {
-             BPSEC_DEBUG_ERR("Can't do priming read of length %d.", chunkSize);
-             break;
-         }
+            if ((chunkLen = bpsec_util_zcoChunkSubmit(sdr, dataReader, chunkSize, job)) <= 0)
+            {
+                BPSEC_DEBUG_ERR("Can't do priming read of length %d.", chunkSize);
+                converted = 0;
+                break;
+            }
 
-         /* Step 3.3 - Pass input to the cipher suite and generate output. */
-         csiOutputChunk = csi_crypt_update(suite, csi_ctx, function, csiInputChunk);
-         if (csiOutputChunk.contents == NULL)
-         {
-            BPSEC_DEBUG_ERR("Could not encrypt.", csiInputChunk.len, chunkSize);
+            bytesRemaining -= chunkLen;
+            inFlight++;
+            continue;
+        }
+
+        /* Step 3.2 - Collect the next output chunk. */
+        if (csi_job_collect(job, &csiOutputChunk) != 1)
+        {
+            BPSEC_DEBUG_ERR("Could not encrypt.", NULL);
+            converted = 0;
             break;
-         }
+        }
 
-         /* Step 3.4 - Write output chunk to file. */
-         if (bpsec_util_zcoFileSourceTransferTo(sdr, outputZco, &fileRef,
-        		filename, (char *) csiOutputChunk.contents, csiOutputChunk.len) <= 0)
-         {
+        inFlight--;
+
+        /* Step 3.3 - Write output chunk to file. */
+        if (bpsec_util_zcoFileSourceTransferTo(sdr, outputZco, &fileRef,
+               filename, (char *) csiOutputChunk.contents, csiOutputChunk.len) <= 0)
+        {
             BPSEC_DEBUG_ERR("Transfer of chunk has failed..", NULL);
             MRELEASE(csiOutputChunk.contents);
+            converted = 0;
             break;
-         }
+        }
 
-         /* Step 3.5 - Prep for next iteration. */
-         bytesRemaining -= csiInputChunk.len;
-         //microsnooze(1000); // TODO: COnsider if a sleep here will help filesystem catch up.
-         MRELEASE(csiOutputChunk.contents);
+        MRELEASE(csiOutputChunk.contents);
     }
 
-    MRELEASE(csiInputChunk.contents);
-
-    if(bytesRemaining > 0)
+    if (csi_job_end(job) == ERROR || !converted)
     {
     	result = ERROR;
     }
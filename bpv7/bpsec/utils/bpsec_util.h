@@ -236,6 +236,8 @@ int bpsec_util_acqBlkDataAsZco(AcqExtBlock *blk, Object *zco);
 
 sc_value bpsec_util_keyRetrieve(char *keyName);
 
+vast bpsec_util_zcoChunkSubmit(Sdr sdr, ZcoReader *dataReader, uvast length, csi_job_t *job);
+
 int32_t bpsec_util_sdrBlkConvert(uint32_t suite, uint8_t *context, csi_blocksize_t *blocksize,
                                  ZcoReader *dataReader, uvast outputBufLen, Object *outputZco, uint8_t function);
 
@@ -454,7 +454,7 @@ number>");
 			continue;		/*	Get next one.	*/
 		}
 
-		CHKZERO(sdr_begin_xn(sdr));
+		CHKZERO(sdr_begin_read_xn(sdr));
 		bundleLength = zco_length(sdr, bundleZco);
 		sdr_exit_xn(sdr);
 		pthread_mutex_lock(&mutex);
@@ -113,7 +113,7 @@ static void	*sendBundles(void *parm)
 			continue;		/*	Get next one.	*/
 		}
 
-		CHKNULL(sdr_begin_xn(sdr));
+		CHKNULL(sdr_begin_read_xn(sdr));
 		bundleLength = zco_length(sdr, bundleZco);
 		sdr_exit_xn(sdr);
 		bytesSent = sendBundleByStcp("", "", &(parms->bundleSocket),
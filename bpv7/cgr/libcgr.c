@@ -131,11 +131,20 @@ static void	removeRoute(PsmPartition ionwm, PsmAddress routeElt)
 	psm_free(ionwm, routeAddr);
 }
 
-static void	discardRouteList(PsmPartition ionwm, PsmAddress routes)
+static void	emptyRouteList(PsmPartition ionwm, PsmAddress routes)
 {
 	PsmAddress	elt;
 	PsmAddress	nextElt;
 
+	for (elt = sm_list_first(ionwm, routes); elt; elt = nextElt)
+	{
+		nextElt = sm_list_next(ionwm, elt);
+		removeRoute(ionwm, elt);
+	}
+}
+
+static void	discardRouteList(PsmPartition ionwm, PsmAddress routes)
+{
 	/*	Destroy all routes in list.				*/
 
 	if (routes == 0)
@@ -143,11 +152,7 @@ static void	discardRouteList(PsmPartition ionwm, PsmAddress routes)
 		return;
 	}
 
-	for (elt = sm_list_first(ionwm, routes); elt; elt = nextElt)
-	{
-		nextElt = sm_list_next(ionwm, elt);
-		removeRoute(ionwm, elt);
-	}
+	emptyRouteList(ionwm, routes);
 
 	/*	Destroy the list itself.				*/
 
@@ -217,8 +222,6 @@ void	cgr_clear_vdb(CgrVdb *vdb)
 	}
 }
 
-#if !UNIBO_CGR
-
 static int	disabledRoute(PsmPartition ionwm, PsmAddress routeElt,
 			PsmAddress *routeAddr, CgrRoute **route)
 {
@@ -243,8 +246,6 @@ static int	disabledRoute(PsmPartition ionwm, PsmAddress routeElt,
 	return 0;
 }
 
-#endif
-
 CgrVdb	*cgr_get_vdb()
 {
 	static char	*name = CGRVDB_NAME;
@@ -424,6 +425,197 @@ static int	edgeIsExcluded(PsmPartition ionwm, PsmAddress excludedEdges,
 	return 0;
 }
 
+/*	The Dijkstra frontier is a binary min-heap of reached but
+ *	not yet visited contacts, ordered by best-case arrival time,
+ *	then by hop count, then by position in the contact index (so
+ *	that ties are broken exactly as by a scan of the index).  A
+ *	contact is pushed again each time its arrival time improves;
+ *	entries that have been superseded in this way, or whose
+ *	contacts have since been visited, are simply discarded when
+ *	they reach the top of the heap.					*/
+
+typedef struct
+{
+	IonCXref	*contact;
+	time_t		arrivalTime;
+	unsigned int	hopCount;
+} CgrFrontierEntry;
+
+typedef struct
+{
+	CgrFrontierEntry	*entries;
+	int			length;
+	int			capacity;
+} CgrFrontier;
+
+#define	CGR_FRONTIER_INITIAL_CAPACITY	64
+
+static int	frontierPrecedes(PsmPartition ionwm, CgrFrontierEntry *a,
+			CgrFrontierEntry *b)
+{
+	if (a->arrivalTime != b->arrivalTime)
+	{
+		return (a->arrivalTime < b->arrivalTime);
+	}
+
+	if (a->hopCount != b->hopCount)
+	{
+		return (a->hopCount < b->hopCount);
+	}
+
+	return (rfx_order_contacts(ionwm, psa(ionwm, a->contact),
+			(void *) (b->contact)) < 0);
+}
+
+static int	frontierInsert(PsmPartition ionwm, CgrFrontier *frontier,
+			IonCXref *contact, CgrContactNote *work)
+{
+	CgrFrontierEntry	*entries;
+	CgrFrontierEntry	entry;
+	int			i;
+	int			parent;
+
+	if (frontier->length == frontier->capacity)
+	{
+		entries = (CgrFrontierEntry *) MTAKE(2 * frontier->capacity
+				* sizeof(CgrFrontierEntry));
+		if (entries == NULL)
+		{
+			putErrmsg("Can't expand CGR frontier.",
+					itoa(frontier->capacity));
+			return -1;
+		}
+
+		memcpy((char *) entries, (char *) (frontier->entries),
+				frontier->length * sizeof(CgrFrontierEntry));
+		MRELEASE(frontier->entries);
+		frontier->entries = entries;
+		frontier->capacity *= 2;
+	}
+
+	entry.contact = contact;
+	entry.arrivalTime = work->arrivalTime;
+	entry.hopCount = work->hopCount;
+	i = frontier->length;
+	frontier->length++;
+	while (i > 0)
+	{
+		parent = (i - 1) / 2;
+		if (!frontierPrecedes(ionwm, &entry, frontier->entries + parent))
+		{
+			break;
+		}
+
+		frontier->entries[i] = frontier->entries[parent];
+		i = parent;
+	}
+
+	frontier->entries[i] = entry;
+	return 0;
+}
+
+static void	frontierRemoveFirst(PsmPartition ionwm, CgrFrontier *frontier)
+{
+	CgrFrontierEntry	*entries = frontier->entries;
+	CgrFrontierEntry	last;
+	int			i;
+	int			child;
+
+	frontier->length--;
+	last = entries[frontier->length];
+	i = 0;
+	while (1)
+	{
+		child = (2 * i) + 1;
+		if (child >= frontier->length)
+		{
+			break;
+		}
+
+		if (child + 1 < frontier->length
+		&& frontierPrecedes(ionwm, entries + child + 1, entries + child))
+		{
+			child++;
+		}
+
+		if (!frontierPrecedes(ionwm, entries + child, &last))
+		{
+			break;
+		}
+
+		entries[i] = entries[child];
+		i = child;
+	}
+
+	entries[i] = last;
+}
+
+static IonCXref	*frontierTakeNext(PsmPartition ionwm, CgrFrontier *frontier)
+{
+	CgrFrontierEntry	*first;
+	IonCXref		*contact;
+	CgrContactNote		*work;
+
+	while (frontier->length > 0)
+	{
+		first = frontier->entries;
+		contact = first->contact;
+		work = (CgrContactNote *) psp(ionwm, contact->routingObject);
+		if (work->visited || work->suppressed
+		|| work->arrivalTime != first->arrivalTime
+		|| work->hopCount != first->hopCount)
+		{
+			contact = NULL;		/*	Stale entry.	*/
+		}
+
+		frontierRemoveFirst(ionwm, frontier);
+		if (contact)
+		{
+			return contact;
+		}
+	}
+
+	return NULL;
+}
+
+static int	citeContact(PsmPartition ionwm, PsmAddress hops,
+			IonCXref *contact, PsmAddress contactAddr)
+{
+	PsmAddress	citation;
+
+	citation = sm_list_insert_first(ionwm, hops, contactAddr);
+
+	/*	Content of citation (which is a list element) is the
+	 *	address of the contact that is this hop of this route.
+	 *
+	 *	Content of new member of contact's citations list is
+	 *	the address of this list element.			*/
+
+	if (citation == 0)
+	{
+		putErrmsg("Can't insert contact into route.", NULL);
+		return -1;
+	}
+
+	if (contact->citations == 0)
+	{
+		contact->citations = sm_list_create(ionwm);
+		if (contact->citations == 0)
+		{
+			putErrmsg("Can't create citation list.", NULL);
+			return -1;
+		}
+	}
+
+	if (sm_list_insert_last(ionwm, contact->citations, citation) == 0)
+	{
+		putErrmsg("Can't insert contact into route.", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
 static int	computeDistanceToTerminus(IonCXref *rootContact,
 			CgrContactNote *rootWork, IonNode *terminusNode,
 			time_t currentTime, PsmAddress excludedEdges,
@@ -445,16 +637,23 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 	time_t		arrivalTime;
 	IonCXref	*finalContact = NULL;
 	time_t		earliestFinalArrivalTime = MAX_TIME;
-	IonCXref	*nextCurrentContact;
-	time_t		earliestArrivalTime;
-	unsigned int	fewestHops;
+	CgrFrontier	frontier;
 	time_t		earliestEndTime;
 	PsmAddress	addr;
-	PsmAddress	citation;
 	IonCXref	*firstContact;
 
 	/*	This is an implementation of Dijkstra's Algorithm.	*/
 
+	frontier.length = 0;
+	frontier.capacity = CGR_FRONTIER_INITIAL_CAPACITY;
+	frontier.entries = (CgrFrontierEntry *) MTAKE(frontier.capacity
+			* sizeof(CgrFrontierEntry));
+	if (frontier.entries == NULL)
+	{
+		putErrmsg("Can't create CGR frontier.", NULL);
+		return -1;
+	}
+
 	TRACE(CgrBeginRoute);
 	current = rootContact;
 	currentWork = rootWork;
@@ -474,10 +673,10 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 		 *	(suppression, prior visitation) that apply to
 		 *	this invocation of Dijkstra's Algorithm.
 		 *
-		*	Each time we cycle through the outer loop, we
-		*	perform two inner loops.  
-		*
-		 *	In the first innner loop, we consider all
+		 *	Each time we cycle through the outer loop, we
+		 *	perform an inner loop and then a selection.
+		 *
+		 *	In the innner loop, we consider all
 		 *	unvisited successors (i.e., topologically
 		 *	adjacent "next-hop" contacts; the "frontier")
 		 *	of the current contact, in each case computing
@@ -520,7 +719,14 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 
 			TRACE(CgrConsiderContact, contact->fromNode,
 					contact->toNode);
-			CHKERR(work = getWorkArea(ionwm, contact));
+			work = getWorkArea(ionwm, contact);
+			if (work == NULL)
+			{
+				putErrmsg("Can't get CGR work area.", NULL);
+				MRELEASE(frontier.entries);
+				return -1;
+			}
+
 			if (work->suppressed)
 			{
 				TRACE(CgrIgnoreContact, CgrSuppressed);
@@ -626,6 +832,16 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 				work->predecessor = current;
 				work->hopCount = currentWork->hopCount;
 				work->hopCount++;
+
+				/*	Any earlier frontier entry for
+				 *	this contact is now stale.	*/
+
+				if (frontierInsert(ionwm, &frontier, contact,
+						work) < 0)
+				{
+					MRELEASE(frontier.entries);
+					return -1;
+				}
 			}
 		}
 
@@ -635,74 +851,25 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 
 		currentWork->visited = 1;
 
-		/*	Now the second inner loop: among ALL non-
-		 *	suppressed contacts in the graph (not just the
-		 *	successors to the current contact), select the
-		 *	one with the earliest arrival time (the least
-		 *	distance from the root vertex) -- and, in the
-		 *	event of a tie, the one comprising the smallest
-		 *	number of successive contacts ("hops") -- to be
-		 *	the new "current" vertex to analyze.		*/
-
-		nextCurrentContact = NULL;
-		earliestArrivalTime = MAX_TIME;
-		fewestHops = (unsigned int) -1;
-		for (elt = sm_rbt_first(ionwm, ionvdb->contactIndex); elt;
-				elt = sm_rbt_next(ionwm, elt))
-		{
-			contact = (IonCXref *) psp(ionwm, sm_rbt_data(ionwm,
-					elt));
-			CHKERR(contact);
-			if (contact->toTime <= currentTime)
-			{
-				/*	Contact is ended, is about to
-				 *	be purged.			*/
-
-				continue;
-			}
-
-			CHKERR(work = getWorkArea(ionwm, contact));
-			if (work->suppressed || work->visited)
-			{
-				continue;	/*	Ineligible.	*/
-			}
-
-			if (work->arrivalTime == MAX_TIME)
-			{
-				/*	Not reachable from root.	*/
-
-				continue;
-			}
-
-			/*	Dijkstra search edge cost function.	*/
-
-			if (work->arrivalTime > earliestArrivalTime)
-			{
-				/*	Not the lowest-cost edge.	*/
-
-				continue;
-			}
-
-			if (work->arrivalTime == earliestArrivalTime
-					&& work->hopCount >= fewestHops)
-			{
-				/*	Not the lowest-cost edge.	*/
-
-				continue;
-			}
-
-			/*	Best candidate "next current" contact
-			 *	seen so far.				*/
-
-			nextCurrentContact = contact;
-			earliestArrivalTime = work->arrivalTime;
-			fewestHops = work->hopCount;
-		}
+		/*	Now the selection: among ALL non-suppressed,
+		 *	unvisited contacts in the graph that have been
+		 *	reached so far (not just the successors to the
+		 *	current contact), select the one with the
+		 *	earliest arrival time (the least distance from
+		 *	the root vertex) -- and, in the event of a tie,
+		 *	the one comprising the smallest number of
+		 *	successive contacts ("hops") -- to be the new
+		 *	"current" vertex to analyze.  These contacts
+		 *	are exactly the ones in the frontier heap, so
+		 *	the selection costs O(log C) rather than a scan
+		 *	of the entire contact index.			*/
+
+		current = frontierTakeNext(ionwm, &frontier);
 
 		/*	If search is complete, stop.  Else repeat,
 		 *	with new value of "current".			*/
 
-		if (nextCurrentContact == NULL)
+		if (current == NULL)
 		{
 			/*	End of search; can't proceed any
 			 *	further toward the terminal contact.	*/
@@ -710,7 +877,6 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 			break;	/*	Out of outer loop; no path.	*/
 		}
 
-		current = nextCurrentContact;
 		currentWork = (CgrContactNote *)
 				psp(ionwm, current->routingObject);
 		if (current->toNode == terminusNode->nodeNbr)
@@ -724,6 +890,8 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 	/*	Have finished a single Dijkstra search of the contact
 	 *	graph, excluding those contacts that were suppressed.	*/
 
+	MRELEASE(frontier.entries);
+
 	if (finalContact)	/*	Got route to terminal contact.	*/
 	{
 		/*	We have found the best path from the local node
@@ -744,6 +912,13 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 			return -1;
 		}
 
+		/*	The terminus node is noted in the hops list
+		 *	so that removal of any contact cited by this
+		 *	route can flag the node's routes as stale.	*/
+
+		oK(sm_list_user_data_set(ionwm, route->hops,
+				psa(ionwm, terminusNode)));
+
 		earliestEndTime = MAX_TIME;
 		contact = finalContact;
 		while (contact)
@@ -758,40 +933,8 @@ static int	computeDistanceToTerminus(IonCXref *rootContact,
 			route->arrivalConfidence *= contact->confidence;
 			addr = psa(ionwm, contact);
 			TRACE(CgrHop, contact->fromNode, contact->toNode);
-			citation = sm_list_insert_first(ionwm, route->hops,
-					addr);
-
-			/*	Content of citation (which is a list
-			 *	element) is the address of the contact
-			 *	that is this hop of this route.
-			 *
-			 *	Content of new member of contact's
-			 *	citations list is the address of this
-			 *	list element.				*/
-
-			if (citation == 0)
+			if (citeContact(ionwm, route->hops, contact, addr) < 0)
 			{
-				putErrmsg("Can't insert contact into route.",
-						NULL);
-				return -1;
-			}
-
-			if (contact->citations == 0)
-			{
-				contact->citations = sm_list_create(ionwm);
-				if (contact->citations == 0)
-				{
-					putErrmsg("Can't create citation list.",
-							NULL);
-					return -1;
-				}
-			}
-
-			if (sm_list_insert_last(ionwm, contact->citations,
-					citation) == 0)
-			{
-				putErrmsg("Can't insert contact into route.",
-						NULL);
 				return -1;
 			}
 
@@ -1159,8 +1302,8 @@ excluded edge.", NULL);
 		contactAddr = sm_list_data(ionwm, contactElt);
 		contact = (IonCXref *) psp(ionwm, contactAddr);
 		TRACE(CgrHop, contact->fromNode, contact->toNode);
-		if (sm_list_insert_first(ionwm, newRoute->hops, contactAddr)
-				== 0)
+		if (citeContact(ionwm, newRoute->hops, contact, contactAddr)
+				< 0)
 		{
 			putErrmsg("Can't prepend trunk to spur route.", NULL);
 			return -1;
@@ -1730,7 +1873,6 @@ static int	tryRoute(CgrRoute *route, time_t currentTime, Bundle *bundle,
 {
 	Sdr		sdr = getIonsdr();
 	PsmPartition	wm = getIonwm();
-	char		eid[SDRSTRING_BUFSZ];
 	VPlan		*vplan;
 	PsmAddress	vplanElt;
 	Object		planObj;
@@ -1739,9 +1881,7 @@ static int	tryRoute(CgrRoute *route, time_t currentTime, Bundle *bundle,
 	LystElt		candidateElt;
 	CgrRoute	*candidateRoute;
 
-	isprintf(eid, sizeof eid, "ipn:" UVAST_FIELDSPEC ".0",
-			route->toNodeNbr);
-	findPlan(eid, &vplan, &vplanElt);
+	findPlanForNode(route->toNodeNbr, &vplan, &vplanElt);
 	if (vplanElt == 0)
 	{
 		TRACE(CgrExcludeRoute, CgrNoPlan);
@@ -2392,6 +2532,18 @@ int	cgr_identify_best_routes(IonNode *terminusNode, Bundle *bundle,
 		}
 	}
 
+	if (terminusNode->routesAreStale)
+	{
+		/*	Some contact cited by a route to this node
+		 *	has been removed from the contact plan, so
+		 *	the routes to this node - but not to any
+		 *	other node - must be recomputed.		*/
+
+		emptyRouteList(ionwm, routingObj->selectedRoutes);
+		emptyRouteList(ionwm, routingObj->knownRoutes);
+		terminusNode->routesAreStale = 0;
+	}
+
 	TRACE(CgrIdentifyRoutes, deadline);
 	if (bundle->ancillaryData.flags & BP_MINIMUM_LATENCY)
 	{
@@ -2540,6 +2692,12 @@ int	cgr_prospect(uvast terminusNodeNbr, time_t deadline)
 			continue;
 		}
 
+		if (terminusNode->routesAreStale
+		&& disabledRoute(wm, elt, &addr, &route))
+		{
+			continue;	/*	Cites removed contact.	*/
+		}
+
 		if (route->arrivalTime > deadline)
 		{
 			continue;	/*	Not a plausible route.	*/
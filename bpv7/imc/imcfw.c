@@ -229,12 +229,16 @@ static uvast 	getBestEntryNode(Bundle *bundle, IonNode *terminusNode,
 	 *	delivered to the terminus node.  If so, return the
 	 *	number of the entry node of the best route.		*/
 
-	if (ionvdb->lastEditTime.tv_sec > cgrvdb->lastLoadTime.tv_sec
-	|| (ionvdb->lastEditTime.tv_sec == cgrvdb->lastLoadTime.tv_sec
-	    && ionvdb->lastEditTime.tv_usec > cgrvdb->lastLoadTime.tv_usec)) 
+	if (ionvdb->lastResetTime.tv_sec > cgrvdb->lastLoadTime.tv_sec
+	|| (ionvdb->lastResetTime.tv_sec == cgrvdb->lastLoadTime.tv_sec
+	    && ionvdb->lastResetTime.tv_usec > cgrvdb->lastLoadTime.tv_usec)) 
 	{
-		/*	Contact plan has been modified, so must discard
-		 *	all route lists and reconstruct them as needed.	*/
+		/*	Contact plan has been modified in a way that
+		 *	may affect routes to any node, so must discard
+		 *	all route lists and reconstruct them as needed.
+		 *	(Removal of a contact only voids the route
+		 *	lists of the nodes whose routes cite it; CGR
+		 *	discards those lists itself.)			*/
 
 		cgr_clear_vdb(cgrvdb);
 		getCurrentTime(&(cgrvdb->lastLoadTime));
@@ -427,6 +427,15 @@ extern int		bp_receive(	BpSAP sap,
 			 *
 			 *	Returns 0 on success, -1 on any error.	*/
 
+extern int		bp_receive_ms(	BpSAP sap,
+					BpDelivery *dlvBuffer,
+					int timeoutMsec);
+			/*	Same as bp_receive, except that the
+			 *	timeout interval is expressed in
+			 *	milliseconds rather than seconds.
+			 *	BP_POLL and BP_BLOCKING have the
+			 *	same meanings as for bp_receive.	*/
+
 extern void		bp_interrupt(BpSAP);
 			/*	Interrupts a bp_receive invocation
 			 *	that is currently blocked.  Designed
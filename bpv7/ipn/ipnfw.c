@@ -101,7 +101,6 @@ static int	applyRoutingOverride(Bundle *bundle, Object bundleObj,
 			uvast nodeNbr)
 {
 	Sdr		sdr = getIonsdr();
-	char		eid[MAX_EID_LEN + 1];
 	VPlan		*vplan;
 	PsmAddress	vplanElt;
 	BpPlan		plan;
@@ -113,9 +112,7 @@ static int	applyRoutingOverride(Bundle *bundle, Object bundleObj,
 
 	/*	Must forward to override neighbor.			*/
 
-	isprintf(eid, sizeof eid, "ipn:" UVAST_FIELDSPEC ".0",
-			bundle->ovrdNeighbor);
-	findPlan(eid, &vplan, &vplanElt);
+	findPlanForNode(bundle->ovrdNeighbor, &vplan, &vplanElt);
 	if (vplanElt == 0)	/*	Not a usable override.		*/
 	{
 		return 0;
@@ -126,7 +123,8 @@ static int	applyRoutingOverride(Bundle *bundle, Object bundleObj,
 	if (plan.viaEid)	/*	Potential loop.			*/
 	{
 		writeMemoNote("[?] Routing override to this neighbor selects \
-an egress plan that redirects to another EID; potential forwarding loop", eid);
+an egress plan that redirects to another EID; potential forwarding loop",
+				vplan->neighborEid);
 		return 0;
 	}
 
@@ -348,7 +346,6 @@ static int	enqueueToEntryNode(CgrRoute *route, Bundle *bundle,
 	Sdr		sdr = getIonsdr();
 	PsmPartition	ionwm = getIonwm();
 	BpEvent		event;
-	char		neighborEid[MAX_EID_LEN + 1];
 	VPlan		*vplan;
 	PsmAddress	vplanElt;
 	int		priority;
@@ -418,9 +415,7 @@ static int	enqueueToEntryNode(CgrRoute *route, Bundle *bundle,
 	 *	be in the list of best routes), the bundle can't go
 	 *	into limbo at this point.				*/
 
-	isprintf(neighborEid, sizeof neighborEid, "ipn:" UVAST_FIELDSPEC ".0",
-			route->toNodeNbr);
-	findPlan(neighborEid, &vplan, &vplanElt);
+	findPlanForNode(route->toNodeNbr, &vplan, &vplanElt);
 	CHKERR(vplanElt);
 	if (bpEnqueue(vplan, bundle, bundleObj) < 0)
 	{
@@ -520,7 +515,6 @@ static int	manageOverbooking(CgrRoute *route, Bundle *newBundle,
 			CgrTrace *trace)
 {
 	Sdr		sdr = getIonsdr();
-	char		neighborEid[MAX_EID_LEN + 1];
 	VPlan		*vplan;
 	PsmAddress	vplanElt;
 	Object		planObj;
@@ -536,8 +530,6 @@ static int	manageOverbooking(CgrRoute *route, Bundle *newBundle,
 	Bundle		bundle;
 	int		eccc;
 
-	isprintf(neighborEid, sizeof neighborEid, "ipn:" UVAST_FIELDSPEC ".0",
-			route->toNodeNbr);
 	priority = newBundle->priority;
 	if (priority == 0)
 	{
@@ -565,7 +557,7 @@ static int	manageOverbooking(CgrRoute *route, Bundle *newBundle,
 		TRACE(CgrFullOverbooking, overbooked);
 	}
 
-	findPlan(neighborEid, &vplan, &vplanElt);
+	findPlanForNode(route->toNodeNbr, &vplan, &vplanElt);
 	if (vplanElt == 0)
 	{
 		TRACE(CgrSkipRoute, CgrNoPlan);
@@ -837,12 +829,16 @@ static int 	tryCGR(Bundle *bundle, Object bundleObj, IonNode *terminusNode,
 	TRACE(CgrBuildRoutes, terminusNode->nodeNbr, bundle->payload.length,
 			(unsigned int) atTime);
 
-	if (ionvdb->lastEditTime.tv_sec > cgrvdb->lastLoadTime.tv_sec
-	|| (ionvdb->lastEditTime.tv_sec == cgrvdb->lastLoadTime.tv_sec
-	    && ionvdb->lastEditTime.tv_usec > cgrvdb->lastLoadTime.tv_usec)) 
+	if (ionvdb->lastResetTime.tv_sec > cgrvdb->lastLoadTime.tv_sec
+	|| (ionvdb->lastResetTime.tv_sec == cgrvdb->lastLoadTime.tv_sec
+	    && ionvdb->lastResetTime.tv_usec > cgrvdb->lastLoadTime.tv_usec)) 
 	{
-		/*	Contact plan has been modified, so must discard
-		 *	all route lists and reconstruct them as needed.	*/
+		/*	Contact plan has been modified in a way that
+		 *	may affect routes to any node, so must discard
+		 *	all route lists and reconstruct them as needed.
+		 *	(Removal of a contact only voids the route
+		 *	lists of the nodes whose routes cite it; CGR
+		 *	discards those lists itself.)			*/
 
 		cgr_clear_vdb(cgrvdb);
 		getCurrentTime(&(cgrvdb->lastLoadTime));
@@ -988,13 +984,11 @@ static int	enqueueToNeighbor(Bundle *bundle, Object bundleObj,
 			uvast nodeNbr)
 {
 	Sdr		sdr = getIonsdr();
-	char		eid[MAX_EID_LEN + 1];
 	VPlan		*vplan;
 	PsmAddress	vplanElt;
 	BpPlan		plan;
 
-	isprintf(eid, sizeof eid, "ipn:" UVAST_FIELDSPEC ".0", nodeNbr);
-	findPlan(eid, &vplan, &vplanElt);
+	findPlanForNode(nodeNbr, &vplan, &vplanElt);
 	if (vplanElt == 0)
 	{
 		return 0;
@@ -17,6 +17,49 @@
 #include "ipnfw.h"
 
 #define	IPN_DBNAME	"ipnRoute"
+#define	IPN_EXIT_INDEX_NAME	"ipnExitIndex"
+#define	IPN_MIN_EXIT_CAPACITY	(16)
+
+/*	The exit index, in ION working memory, enables the exit for
+ *	a given node number to be found by binary search rather than
+ *	by reading every exit in the SDR.  The first and last node
+ *	numbers of all exits divide the range of node numbers into
+ *	segments, throughout each of which the applicable exit (the
+ *	narrowest exit that encompasses the segment, if any) is the
+ *	same.  The index is the array of those segments, ordered by
+ *	first node number, adjacent segments to which the same exit
+ *	applies being merged.
+ *
+ *	The index also retains the node number range of every exit,
+ *	in the order of the list of exits (narrowest first), so that
+ *	when an exit is added or removed only the segments within
+ *	that exit's range need be recomputed and the list position
+ *	of the exit can be found without reading the list.  So no
+ *	exit need be read from the SDR except when the index is
+ *	first loaded.							*/
+
+typedef struct
+{
+	uvast		firstNodeNbr;	/*	Of segment.		*/
+	Object		exitAddr;	/*	0 if no exit applies.	*/
+} IpnExitSegment;
+
+typedef struct
+{
+	uvast		firstNodeNbr;
+	uvast		lastNodeNbr;
+	Object		addr;		/*	IpnExit.		*/
+	Object		elt;		/*	In list of exits.	*/
+} IpnIndexedExit;
+
+typedef struct
+{
+	int		exitCount;
+	int		exitCapacity;
+	PsmAddress	exits;		/*	Array of IpnIndexedExit.*/
+	int		segmentCount;
+	PsmAddress	segments;	/*	Array of IpnExitSegment.*/
+} IpnExitIndex;
 
 /*	*	*	Globals used for IPN scheme service.	*	*/
 
@@ -66,6 +109,627 @@ static IpnDB	*_ipnConstants()
 	return db;
 }
 
+static PsmAddress	_ipnExitIndex(PsmAddress *newIndex)
+{
+	static PsmAddress	indexAddr = 0;
+
+	if (newIndex)
+	{
+		indexAddr = *newIndex;
+	}
+
+	return indexAddr;
+}
+
+/*	*	*	Exit index functions	*	*	*	*/
+
+static int	orderExits(const void *a, const void *b)
+{
+	IpnIndexedExit	*exitA = (IpnIndexedExit *) a;
+	IpnIndexedExit	*exitB = (IpnIndexedExit *) b;
+	uvast		sizeA = exitA->lastNodeNbr - exitA->firstNodeNbr;
+	uvast		sizeB = exitB->lastNodeNbr - exitB->firstNodeNbr;
+
+	/*	Narrowest exits first; among exits of the same size,
+	 *	ascending first node number, as in the list of exits.	*/
+
+	if (sizeA != sizeB)
+	{
+		return (sizeA < sizeB ? -1 : 1);
+	}
+
+	if (exitA->firstNodeNbr != exitB->firstNodeNbr)
+	{
+		return (exitA->firstNodeNbr < exitB->firstNodeNbr ? -1 : 1);
+	}
+
+	return 0;
+}
+
+static int	orderNodeNbrs(const void *a, const void *b)
+{
+	uvast	nbrA = *((uvast *) a);
+	uvast	nbrB = *((uvast *) b);
+
+	if (nbrA != nbrB)
+	{
+		return (nbrA < nbrB ? -1 : 1);
+	}
+
+	return 0;
+}
+
+static int	findIndexedExit(IpnExitIndex *index, uvast firstNodeNbr,
+			uvast lastNodeNbr, int *position)
+{
+	IpnIndexedExit	*exits;
+	IpnIndexedExit	target;
+	int		low = 0;
+	int		high = index->exitCount - 1;
+	int		mid;
+	int		result;
+
+	/*	Returns 1 and the position of the exit if the exit
+	 *	is indexed, else 0 and the position at which it
+	 *	would be inserted.					*/
+
+	exits = (IpnIndexedExit *) psp(getIonwm(), index->exits);
+	target.firstNodeNbr = firstNodeNbr;
+	target.lastNodeNbr = lastNodeNbr;
+	while (low <= high)
+	{
+		mid = low + ((high - low) / 2);
+		result = orderExits(exits + mid, &target);
+		if (result == 0)
+		{
+			*position = mid;
+			return 1;
+		}
+
+		if (result < 0)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	*position = low;
+	return 0;
+}
+
+static int	findBound(uvast *bounds, int boundCount, uvast nodeNbr)
+{
+	int	low = 0;
+	int	high = boundCount - 1;
+	int	mid;
+	int	result = -1;
+
+	/*	Returns the index of the last bound that is less than
+	 *	or equal to nodeNbr, or -1 if there is none.		*/
+
+	while (low <= high)
+	{
+		mid = low + ((high - low) / 2);
+		if (bounds[mid] <= nodeNbr)
+		{
+			result = mid;
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return result;
+}
+
+static Object	applicableExit(IpnExitSegment *segments, int segmentCount,
+			uvast nodeNbr)
+{
+	int	low = 0;
+	int	high = segmentCount - 1;
+	int	mid;
+	Object	exitAddr = 0;
+
+	/*	Find the last segment whose first node number is less
+	 *	than or equal to nodeNbr.				*/
+
+	while (low <= high)
+	{
+		mid = low + ((high - low) / 2);
+		if (segments[mid].firstNodeNbr <= nodeNbr)
+		{
+			exitAddr = segments[mid].exitAddr;
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return exitAddr;
+}
+
+static int	nextUnassigned(int *skip, int segmentNbr)
+{
+	int	unassigned = segmentNbr;
+	int	next;
+
+	while (skip[unassigned] != unassigned)
+	{
+		unassigned = skip[unassigned];
+	}
+
+	while (skip[segmentNbr] != unassigned)	/*	Shorten path.	*/
+	{
+		next = skip[segmentNbr];
+		skip[segmentNbr] = unassigned;
+		segmentNbr = next;
+	}
+
+	return unassigned;
+}
+
+static void	appendSegment(IpnExitSegment *segments, int *segmentCount,
+			uvast firstNodeNbr, Object exitAddr)
+{
+	/*	A segment to which the same exit applies as to the
+	 *	preceding segment is merged into it, and there is
+	 *	no need for a leading segment to which no exit
+	 *	applies.						*/
+
+	if (*segmentCount == 0)
+	{
+		if (exitAddr == 0)
+		{
+			return;
+		}
+	}
+	else
+	{
+		if (segments[*segmentCount - 1].exitAddr == exitAddr)
+		{
+			return;
+		}
+	}
+
+	segments[*segmentCount].firstNodeNbr = firstNodeNbr;
+	segments[*segmentCount].exitAddr = exitAddr;
+	(*segmentCount)++;
+}
+
+static int	spliceSegments(IpnExitIndex *index, uvast from, uvast to,
+			uvast *bounds, Object *applicable, int boundCount)
+{
+	PsmPartition	wm = getIonwm();
+	IpnExitSegment	*oldSegments;
+	IpnExitSegment	*segments;
+	PsmAddress	segmentsAddr;
+	int		segmentCount = 0;
+	Object		tailExit = 0;
+	int		i;
+
+	/*	Replaces the segments from node number "from" through
+	 *	node number "to" with the newly computed segments.	*/
+
+	oldSegments = (IpnExitSegment *) psp(wm, index->segments);
+	if (to + 1 > to)
+	{
+		tailExit = applicableExit(oldSegments, index->segmentCount,
+				to + 1);
+	}
+
+	segmentsAddr = psm_malloc(wm, (index->segmentCount + boundCount + 1)
+			* sizeof(IpnExitSegment));
+	if (segmentsAddr == 0)
+	{
+		putErrmsg("No space for exit index.",
+				itoa(index->segmentCount + boundCount));
+		return -1;
+	}
+
+	segments = (IpnExitSegment *) psp(wm, segmentsAddr);
+	for (i = 0; i < index->segmentCount
+			&& oldSegments[i].firstNodeNbr < from; i++)
+	{
+		appendSegment(segments, &segmentCount,
+				oldSegments[i].firstNodeNbr,
+				oldSegments[i].exitAddr);
+	}
+
+	for (i = 0; i < boundCount; i++)
+	{
+		appendSegment(segments, &segmentCount, bounds[i],
+				applicable[i]);
+	}
+
+	if (to + 1 > to)
+	{
+		appendSegment(segments, &segmentCount, to + 1, tailExit);
+		for (i = 0; i < index->segmentCount; i++)
+		{
+			if (oldSegments[i].firstNodeNbr > to + 1)
+			{
+				appendSegment(segments, &segmentCount,
+						oldSegments[i].firstNodeNbr,
+						oldSegments[i].exitAddr);
+			}
+		}
+	}
+
+	if (index->segments)
+	{
+		psm_free(wm, index->segments);
+	}
+
+	index->segmentCount = segmentCount;
+	index->segments = segmentsAddr;
+	return 0;
+}
+
+static int	reindexRange(IpnExitIndex *index, uvast from, uvast to)
+{
+	IpnIndexedExit	*exits;
+	int		overlapCount = 0;
+	int		*overlapping;
+	uvast		*bounds;
+	Object		*applicable;
+	int		*skip;
+	int		boundCount = 0;
+	int		segmentCount = 0;
+	IpnIndexedExit	*exit;
+	int		first;
+	int		last;
+	int		result;
+	int		i;
+	int		j;
+
+	/*	Recomputes the segments within node numbers "from"
+	 *	through "to" from the exits whose ranges overlap
+	 *	that range.						*/
+
+	exits = (IpnIndexedExit *) psp(getIonwm(), index->exits);
+	for (i = 0; i < index->exitCount; i++)
+	{
+		if (exits[i].lastNodeNbr >= from && exits[i].firstNodeNbr <= to)
+		{
+			overlapCount++;
+		}
+	}
+
+	overlapping = (int *) MTAKE((overlapCount + 1) * sizeof(int));
+	bounds = (uvast *) MTAKE(((2 * overlapCount) + 1) * sizeof(uvast));
+	applicable = (Object *) MTAKE(((2 * overlapCount) + 1)
+			* sizeof(Object));
+	skip = (int *) MTAKE(((2 * overlapCount) + 2) * sizeof(int));
+	if (overlapping == NULL || bounds == NULL || applicable == NULL
+	|| skip == NULL)
+	{
+		if (overlapping) MRELEASE(overlapping);
+		if (bounds) MRELEASE(bounds);
+		if (applicable) MRELEASE(applicable);
+		if (skip) MRELEASE(skip);
+		putErrmsg("No space for exit index.", itoa(overlapCount));
+		return -1;
+	}
+
+	/*	The range starts a segment, as does each overlapping
+	 *	exit's first node number and the node number
+	 *	following its last node number, within the range.	*/
+
+	bounds[boundCount++] = from;
+	for (i = 0, j = 0; i < index->exitCount; i++)
+	{
+		exit = exits + i;
+		if (exit->lastNodeNbr < from || exit->firstNodeNbr > to)
+		{
+			continue;
+		}
+
+		overlapping[j++] = i;
+		if (exit->firstNodeNbr > from)
+		{
+			bounds[boundCount++] = exit->firstNodeNbr;
+		}
+
+		if (exit->lastNodeNbr < to)
+		{
+			bounds[boundCount++] = exit->lastNodeNbr + 1;
+		}
+	}
+
+	qsort(bounds, boundCount, sizeof(uvast), orderNodeNbrs);
+	for (i = 0; i < boundCount; i++)
+	{
+		if (segmentCount == 0 || bounds[i] != bounds[segmentCount - 1])
+		{
+			bounds[segmentCount++] = bounds[i];
+		}
+	}
+
+	/*	Assign each segment to the narrowest exit that
+	 *	encompasses it: take the exits narrowest first (the
+	 *	order in which they are indexed) and assign to each
+	 *	exit all of its segments that are not yet assigned,
+	 *	skipping over the assigned ones.			*/
+
+	for (i = 0; i < segmentCount; i++)
+	{
+		applicable[i] = 0;
+		skip[i] = i;
+	}
+
+	skip[segmentCount] = segmentCount;
+	for (i = 0; i < overlapCount; i++)
+	{
+		exit = exits + overlapping[i];
+		first = (exit->firstNodeNbr > from ? findBound(bounds,
+				segmentCount, exit->firstNodeNbr) : 0);
+		last = (exit->lastNodeNbr < to ? findBound(bounds,
+				segmentCount, exit->lastNodeNbr + 1) - 1
+				: segmentCount - 1);
+		for (j = nextUnassigned(skip, first); j <= last;
+				j = nextUnassigned(skip, j + 1))
+		{
+			applicable[j] = exit->addr;
+			skip[j] = j + 1;
+		}
+	}
+
+	result = spliceSegments(index, from, to, bounds, applicable,
+			segmentCount);
+	MRELEASE(overlapping);
+	MRELEASE(bounds);
+	MRELEASE(applicable);
+	MRELEASE(skip);
+	return result;
+}
+
+static int	loadExitIndex(IpnExitIndex *index)
+{
+	Sdr		sdr = getIonsdr();
+	PsmPartition	wm = getIonwm();
+	Object		exits = (_ipnConstants())->exits;
+	IpnExitIndex	newIndex;
+	IpnIndexedExit	*indexedExits;
+	Object		elt;
+	IpnExit		exit;
+	int		i;
+
+	/*	Loads the index from the list of exits, replacing
+	 *	the index's prior content.				*/
+
+	memset((char *) &newIndex, 0, sizeof(IpnExitIndex));
+	newIndex.exitCapacity = sdr_list_length(sdr, exits);
+	if (newIndex.exitCapacity < IPN_MIN_EXIT_CAPACITY)
+	{
+		newIndex.exitCapacity = IPN_MIN_EXIT_CAPACITY;
+	}
+
+	newIndex.exits = psm_malloc(wm, newIndex.exitCapacity
+			* sizeof(IpnIndexedExit));
+	if (newIndex.exits == 0)
+	{
+		putErrmsg("No space for exit index.",
+				itoa(newIndex.exitCapacity));
+		return -1;
+	}
+
+	indexedExits = (IpnIndexedExit *) psp(wm, newIndex.exits);
+	i = 0;
+	for (elt = sdr_list_first(sdr, exits);
+			elt && i < newIndex.exitCapacity;
+			elt = sdr_list_next(sdr, elt))
+	{
+		indexedExits[i].addr = sdr_list_data(sdr, elt);
+		indexedExits[i].elt = elt;
+		sdr_read(sdr, (char *) &exit, indexedExits[i].addr,
+				sizeof(IpnExit));
+		indexedExits[i].firstNodeNbr = exit.firstNodeNbr;
+		indexedExits[i].lastNodeNbr = exit.lastNodeNbr;
+		i++;
+	}
+
+	newIndex.exitCount = i;
+	qsort(indexedExits, newIndex.exitCount, sizeof(IpnIndexedExit),
+			orderExits);
+	if (reindexRange(&newIndex, 0, (uvast) -1) < 0)
+	{
+		psm_free(wm, newIndex.exits);
+		putErrmsg("Can't load exit index.", NULL);
+		return -1;
+	}
+
+	if (index->exits)
+	{
+		psm_free(wm, index->exits);
+	}
+
+	if (index->segments)
+	{
+		psm_free(wm, index->segments);
+	}
+
+	memcpy((char *) index, (char *) &newIndex, sizeof(IpnExitIndex));
+	return 0;
+}
+
+static int	indexExit(IpnExitIndex *index, uvast firstNodeNbr,
+			uvast lastNodeNbr, Object addr, Object elt)
+{
+	PsmPartition	wm = getIonwm();
+	IpnIndexedExit	*exits;
+	PsmAddress	exitsAddr;
+	int		position;
+
+	if (findIndexedExit(index, firstNodeNbr, lastNodeNbr, &position))
+	{
+		return 0;	/*	Already indexed.		*/
+	}
+
+	if (index->exitCount == index->exitCapacity)
+	{
+		exitsAddr = psm_malloc(wm, 2 * index->exitCapacity
+				* sizeof(IpnIndexedExit));
+		if (exitsAddr == 0)
+		{
+			putErrmsg("No space for exit index.",
+					itoa(2 * index->exitCapacity));
+			return -1;
+		}
+
+		memcpy((char *) psp(wm, exitsAddr),
+				(char *) psp(wm, index->exits),
+				index->exitCount * sizeof(IpnIndexedExit));
+		psm_free(wm, index->exits);
+		index->exits = exitsAddr;
+		index->exitCapacity *= 2;
+	}
+
+	exits = (IpnIndexedExit *) psp(wm, index->exits);
+	memmove((char *) (exits + position + 1), (char *) (exits + position),
+			(index->exitCount - position) * sizeof(IpnIndexedExit));
+	exits[position].firstNodeNbr = firstNodeNbr;
+	exits[position].lastNodeNbr = lastNodeNbr;
+	exits[position].addr = addr;
+	exits[position].elt = elt;
+	index->exitCount++;
+	if (reindexRange(index, firstNodeNbr, lastNodeNbr) < 0)
+	{
+		index->exitCount--;
+		memmove((char *) (exits + position),
+				(char *) (exits + position + 1),
+				(index->exitCount - position)
+				* sizeof(IpnIndexedExit));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int	unindexExit(IpnExitIndex *index, uvast firstNodeNbr,
+			uvast lastNodeNbr)
+{
+	IpnIndexedExit	*exits;
+	IpnIndexedExit	exit;
+	int		position;
+
+	if (findIndexedExit(index, firstNodeNbr, lastNodeNbr, &position)
+			== 0)
+	{
+		return 0;	/*	Not indexed.			*/
+	}
+
+	exits = (IpnIndexedExit *) psp(getIonwm(), index->exits);
+	exit = exits[position];
+	index->exitCount--;
+	memmove((char *) (exits + position), (char *) (exits + position + 1),
+			(index->exitCount - position) * sizeof(IpnIndexedExit));
+	if (reindexRange(index, firstNodeNbr, lastNodeNbr) < 0)
+	{
+		memmove((char *) (exits + position + 1),
+				(char *) (exits + position),
+				(index->exitCount - position)
+				* sizeof(IpnIndexedExit));
+		exits[position] = exit;
+		index->exitCount++;
+		return -1;
+	}
+
+	return 0;
+}
+
+static IpnExitIndex	*getExitIndex()
+{
+	PsmAddress	indexAddr = _ipnExitIndex(NULL);
+
+	if (indexAddr == 0)
+	{
+		return NULL;	/*	Exits are found by list search.	*/
+	}
+
+	return (IpnExitIndex *) psp(getIonwm(), indexAddr);
+}
+
+static void	reloadExitIndex()
+{
+	Sdr		sdr = getIonsdr();
+	IpnExitIndex	*index = getExitIndex();
+
+	/*	Restores consistency of the index with the list of
+	 *	exits after a transaction that failed.			*/
+
+	if (index && sdr_begin_xn(sdr))	/*	Just to lock memory.	*/
+	{
+		oK(loadExitIndex(index));
+		sdr_exit_xn(sdr);
+	}
+}
+
+static int	raiseExitIndex()
+{
+	Sdr		sdr = getIonsdr();
+	PsmPartition	wm = getIonwm();
+	PsmAddress	indexAddr;
+	PsmAddress	elt;
+	IpnExitIndex	*index;
+
+	CHKERR(sdr_begin_xn(sdr));	/*	Just to lock memory.	*/
+	if (psm_locate(wm, IPN_EXIT_INDEX_NAME, &indexAddr, &elt) < 0)
+	{
+		sdr_exit_xn(sdr);
+		putErrmsg("Failed searching for exit index.", NULL);
+		return -1;
+	}
+
+	if (elt == 0)		/*	Not found; must create it.	*/
+	{
+		indexAddr = psm_zalloc(wm, sizeof(IpnExitIndex));
+		if (indexAddr == 0)
+		{
+			sdr_exit_xn(sdr);
+			putErrmsg("No space for exit index.", NULL);
+			return -1;
+		}
+
+		index = (IpnExitIndex *) psp(wm, indexAddr);
+		memset((char *) index, 0, sizeof(IpnExitIndex));
+		if (loadExitIndex(index) < 0
+		|| psm_catlg(wm, IPN_EXIT_INDEX_NAME, indexAddr) < 0)
+		{
+			if (index->exits)
+			{
+				psm_free(wm, index->exits);
+			}
+
+			if (index->segments)
+			{
+				psm_free(wm, index->segments);
+			}
+
+			psm_free(wm, indexAddr);
+			sdr_exit_xn(sdr);
+			putErrmsg("Can't initialize exit index.", NULL);
+			return -1;
+		}
+	}
+
+	sdr_exit_xn(sdr);
+	oK(_ipnExitIndex(&indexAddr));
+	return 0;
+}
+
+static Object	lookUpExitIndex(IpnExitIndex *index, uvast nodeNbr)
+{
+	return applicableExit((IpnExitSegment *) psp(getIonwm(),
+			index->segments), index->segmentCount, nodeNbr);
+}
+
 /*	*	*	Routing information mgt functions	*	*/
 
 int	ipnInit()
@@ -113,6 +777,12 @@ int	ipnInit()
 
 	oK(_ipndbObject(&ipndbObject));
 	oK(_ipnConstants());
+	if (raiseExitIndex() < 0)
+	{
+		putErrmsg("Can't raise IPN exit index.", NULL);
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -129,7 +799,6 @@ IpnDB	*getIpnConstants()
 void	ipn_findPlan(uvast nodeNbr, Object *planAddr, Object *eltp)
 {
 	Sdr		sdr = getIonsdr();
-	char		eid[MAX_EID_LEN + 1];
 	VPlan		*vplan;
 	PsmAddress	vplanElt;
 
@@ -144,8 +813,7 @@ void	ipn_findPlan(uvast nodeNbr, Object *planAddr, Object *eltp)
 		return;
 	}
 
-	isprintf(eid, sizeof eid, "ipn:" UVAST_FIELDSPEC ".0", nodeNbr);
-	findPlan(eid, &vplan, &vplanElt);
+	findPlanForNode(nodeNbr, &vplan, &vplanElt);
 	if (vplanElt == 0)
 	{
 		return;
@@ -513,10 +1181,13 @@ int	ipn_lookupOvrd(unsigned int dataLabel, uvast destNodeNbr,
 static Object	locateExit(uvast firstNodeNbr, uvast lastNodeNbr,
 			Object *nextExit)
 {
-	Sdr	sdr = getIonsdr();
-	int	targetSize;
-	int	exitSize;
-	Object	elt;
+	Sdr		sdr = getIonsdr();
+	IpnExitIndex	*index = getExitIndex();
+	IpnIndexedExit	*exits;
+	int		position;
+	uvast		targetSize;
+	uvast		exitSize;
+	Object		elt;
 		OBJ_POINTER(IpnExit, exit);
 
 	/*	This function locates the IpnExit for the specified
@@ -525,6 +1196,23 @@ static Object	locateExit(uvast firstNodeNbr, uvast lastNodeNbr,
 	 *	should be inserted.					*/
 
 	if (nextExit) *nextExit = 0;	/*	Default.		*/
+	if (index)
+	{
+		exits = (IpnIndexedExit *) psp(getIonwm(), index->exits);
+		if (findIndexedExit(index, firstNodeNbr, lastNodeNbr,
+				&position))
+		{
+			return exits[position].elt;
+		}
+
+		if (nextExit && position < index->exitCount)
+		{
+			*nextExit = exits[position].elt;
+		}
+
+		return 0;
+	}
+
 	targetSize = lastNodeNbr - firstNodeNbr;
 	for (elt = sdr_list_first(sdr, (_ipnConstants())->exits); elt;
 			elt = sdr_list_next(sdr, elt))
@@ -597,10 +1285,12 @@ void	ipn_findExit(uvast firstNodeNbr, uvast lastNodeNbr, Object *exitAddr,
 
 int	ipn_addExit(uvast firstNodeNbr, uvast lastNodeNbr, char *viaEid)
 {
-	Sdr	sdr = getIonsdr();
-	Object	nextExit;
-	IpnExit	exit;
-	Object	addr;
+	Sdr		sdr = getIonsdr();
+	IpnExitIndex	*index;
+	Object		nextExit;
+	IpnExit		exit;
+	Object		addr;
+	Object		elt = 0;
 
 	CHKERR(viaEid);
 	if (firstNodeNbr == 0)
@@ -641,20 +1331,30 @@ int	ipn_addExit(uvast firstNodeNbr, uvast lastNodeNbr, char *viaEid)
 	{
 		if (nextExit)
 		{
-			sdr_list_insert_before(sdr, nextExit, addr);
+			elt = sdr_list_insert_before(sdr, nextExit, addr);
 		}
 		else
 		{
-			sdr_list_insert_last(sdr, (_ipnConstants())->exits,
-					addr);
+			elt = sdr_list_insert_last(sdr,
+					(_ipnConstants())->exits, addr);
 		}
 
 		sdr_write(sdr, addr, (char *) &exit, sizeof(IpnExit));
 	}
 
+	index = getExitIndex();
+	if (index && elt && indexExit(index, firstNodeNbr, lastNodeNbr,
+			addr, elt) < 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("Can't add exit to index.", NULL);
+		return -1;
+	}
+
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't add exit.", NULL);
+		reloadExitIndex();
 		return -1;
 	}
 
@@ -703,9 +1403,10 @@ int	ipn_updateExit(uvast firstNodeNbr, uvast lastNodeNbr, char *viaEid)
 
 int	ipn_removeExit(uvast firstNodeNbr, uvast lastNodeNbr)
 {
-	Sdr	sdr = getIonsdr();
-	Object	elt;
-	Object	addr;
+	Sdr		sdr = getIonsdr();
+	IpnExitIndex	*index;
+	Object		elt;
+	Object		addr;
 		OBJ_POINTER(IpnExit, exit);
 
 	CHKERR(sdr_begin_xn(sdr));
@@ -725,9 +1426,18 @@ int	ipn_removeExit(uvast firstNodeNbr, uvast lastNodeNbr)
 	sdr_list_delete(sdr, elt, NULL, NULL);
 	sdr_free(sdr, exit->eid);
 	sdr_free(sdr, addr);
+	index = getExitIndex();
+	if (index && unindexExit(index, firstNodeNbr, lastNodeNbr) < 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("Can't remove exit from index.", NULL);
+		return -1;
+	}
+
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't remove exit.", NULL);
+		reloadExitIndex();
 		return -1;
 	}
 
@@ -736,10 +1446,11 @@ int	ipn_removeExit(uvast firstNodeNbr, uvast lastNodeNbr)
 
 int	ipn_lookupExit(uvast nodeNbr, char *eid)
 {
-	Sdr	sdr = getIonsdr();
-	Object	elt;
-	Object	addr;
-	IpnExit	exit;
+	Sdr		sdr = getIonsdr();
+	IpnExitIndex	*index;
+	Object		elt;
+	Object		addr;
+	IpnExit		exit;
 
 	/*	This function determines the applicable egress plan
 	 *	for the specified eid, if any.				*/
@@ -752,11 +1463,29 @@ int	ipn_lookupExit(uvast nodeNbr, char *eid)
 		return 0;
 	}
 
-	/*	Find best matching exit.  Exits are sorted by first
-	 *	node number within exit size, both ascending.  So
-	 *	the first exit whose range encompasses the node number
-	 *	is the best fit (narrowest applicable range), but
-	 *	there's no way to terminate the search early.		*/
+	/*	Find best matching exit: the narrowest exit whose
+	 *	range encompasses the node number.			*/
+
+	index = getExitIndex();
+	if (index)
+	{
+		addr = lookUpExitIndex(index, nodeNbr);
+		if (addr == 0)
+		{
+			return 0;	/*	No exit found.		*/
+		}
+
+		sdr_read(sdr, (char *) &exit, addr, sizeof(IpnExit));
+		sdr_string_read(sdr, eid, exit.eid);
+		return 1;
+	}
+
+	/*	No index, so search the list of exits.  Exits are
+	 *	sorted by first node number within exit size, both
+	 *	ascending.  So the first exit whose range encompasses
+	 *	the node number is the best fit (narrowest applicable
+	 *	range), but there's no way to terminate the search
+	 *	early.							*/
 
 	for (elt = sdr_list_first(sdr, (_ipnConstants())->exits); elt;
 			elt = sdr_list_next(sdr, elt))
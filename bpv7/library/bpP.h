@@ -880,6 +880,7 @@ typedef struct
 
 	PsmAddress	schemes;	/*	SM list: VScheme.	*/
 	PsmAddress	plans;		/*	SM list: VPlan.		*/
+	PsmAddress	planIndex;	/*	SM RB tree: VPlan elts.	*/
 	PsmAddress	inducts;	/*	SM list: VInduct.	*/
 	PsmAddress	outducts;	/*	SM list: VOutduct.	*/
 	PsmAddress	discoveries;	/*	SM list: Discovery.	*/
@@ -1437,6 +1438,13 @@ extern int		serializePayloadBlock(Payload *payload,
 				unsigned char blkProcFlags);
 
 extern void		findPlan(char *eid, VPlan **vplan, PsmAddress *elt);
+extern void		findPlanForNode(uvast nodeNbr, VPlan **vplan,
+				PsmAddress *elt);
+			/*	Same as findPlan for the EID
+			 *	"ipn:<nodeNbr>.0", but uses the
+			 *	index of plans by node number
+			 *	rather than a search of the list
+			 *	of plans by EID.			*/
 
 extern int		addPlan(char *eid, unsigned int nominalRate);
 extern int		updatePlan(char *eid, unsigned int nominalRate);
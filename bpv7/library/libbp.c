@@ -19,11 +19,32 @@
 extern void	bpEndpointTally(VEndpoint *vpoint, unsigned int idx,
 			unsigned int size);
 
+/*	Timed bp_receive() invocations are all served by a single
+ *	timer thread per process.  Each pending timer lives on the
+ *	stack of the thread that is waiting for a bundle; the timer
+ *	thread keeps the pending timers in a list ordered by deadline
+ *	and, when the earliest deadline passes, gives the endpoint
+ *	semaphore to wake up the receiving thread.			*/
+
+typedef struct bprcvtimer_str
+{
+	struct timeval		deadline;
+	sm_SemId		semaphore;
+	int			expired;	/*	Boolean.	*/
+	struct bprcvtimer_str	*next;
+} ReceiveTimer;
+
 typedef struct
 {
-	int		interval;	/*	Seconds.		*/
-	sm_SemId	semaphore;
-} TimerParms;
+	pthread_mutex_t		mutex;
+	pthread_cond_t		cv;
+	pthread_t		thread;
+	int			running;	/*	Boolean.	*/
+	ReceiveTimer		*timers;	/*	By deadline.	*/
+} ReceiveTimerService;
+
+static ReceiveTimerService	_timerService =
+	{ PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
 
 int	bp_attach()
 {
@@ -567,58 +588,134 @@ int	bp_release(Object bundleObj)
 	return 0;
 }
 
+static int	timeIsPast(struct timeval *deadline, struct timeval *now)
+{
+	if (deadline->tv_sec < now->tv_sec)
+	{
+		return 1;
+	}
+
+	return (deadline->tv_sec == now->tv_sec
+			&& deadline->tv_usec <= now->tv_usec);
+}
+
 static void	*timerMain(void *parm)
 {
-	TimerParms	*timer = (TimerParms *) parm;
-	pthread_mutex_t	mutex;
-	pthread_cond_t	cv;
-	struct timeval	workTime;
-	struct timespec	deadline;
-	int		result;
+	ReceiveTimerService	*svc = (ReceiveTimerService *) parm;
+	ReceiveTimer		*timer;
+	struct timeval		workTime;
+	struct timespec		deadline;
 
-	memset((char *) &mutex, 0, sizeof mutex);
-	if (pthread_mutex_init(&mutex, NULL))
+	pthread_mutex_lock(&svc->mutex);
+	while (1)
 	{
-		putSysErrmsg("can't start timer, mutex init failed", NULL);
-		sm_SemGive(timer->semaphore);
-		return NULL;
+		timer = svc->timers;
+		if (timer == NULL)
+		{
+			oK(pthread_cond_wait(&svc->cv, &svc->mutex));
+			continue;
+		}
+
+		getCurrentTime(&workTime);
+		if (timeIsPast(&timer->deadline, &workTime))
+		{
+			/*	Timed out; must wake up the receiver.	*/
+
+			svc->timers = timer->next;
+			timer->next = NULL;
+			timer->expired = 1;
+			sm_SemGive(timer->semaphore);
+			continue;
+		}
+
+		deadline.tv_sec = timer->deadline.tv_sec;
+		deadline.tv_nsec = timer->deadline.tv_usec * 1000;
+		oK(pthread_cond_timedwait(&svc->cv, &svc->mutex, &deadline));
 	}
 
-	memset((char *) &cv, 0, sizeof cv);
-	if (pthread_cond_init(&cv, NULL))
+	pthread_mutex_unlock(&svc->mutex);
+	return NULL;
+}
+
+static int	startTimer(ReceiveTimer *timer, sm_SemId semaphore,
+			struct timeval *interval)
+{
+	ReceiveTimerService	*svc = &_timerService;
+	ReceiveTimer		**ptr;
+
+	getCurrentTime(&timer->deadline);
+	timer->deadline.tv_sec += interval->tv_sec;
+	timer->deadline.tv_usec += interval->tv_usec;
+	if (timer->deadline.tv_usec >= 1000000)
 	{
-		putSysErrmsg("can't start timer, cond init failed", NULL);
-		sm_SemGive(timer->semaphore);
-		return NULL;
+		timer->deadline.tv_sec += 1;
+		timer->deadline.tv_usec -= 1000000;
 	}
 
-	getCurrentTime(&workTime);
-	deadline.tv_sec = workTime.tv_sec + timer->interval;
-	deadline.tv_nsec = workTime.tv_usec * 1000;
-	pthread_mutex_lock(&mutex);
-	result = pthread_cond_timedwait(&cv, &mutex, &deadline);
-	pthread_mutex_unlock(&mutex);
-	pthread_mutex_destroy(&mutex);
-	pthread_cond_destroy(&cv);
-	if (result)
+	timer->semaphore = semaphore;
+	timer->expired = 0;
+	pthread_mutex_lock(&svc->mutex);
+	if (!svc->running)
 	{
-		errno = result;
-		if (errno != ETIMEDOUT)
+		if (pthread_begin(&svc->thread, NULL, timerMain, svc,
+				"bprcvTimer") < 0)
 		{
-			putSysErrmsg("timer failure", NULL);
-			sm_SemGive(timer->semaphore);
-			return NULL;
+			pthread_mutex_unlock(&svc->mutex);
+			putSysErrmsg("Can't start receive timer thread", NULL);
+			return -1;
 		}
+
+		oK(pthread_detach(svc->thread));
+		svc->running = 1;
 	}
 
-	/*	Timed out; must wake up the main thread.		*/
+	/*	Insert in deadline order; wake the timer thread if
+	 *	this is now the earliest deadline.			*/
 
-	timer->interval = 0;	/*	Indicate genuine timeout.	*/
-	sm_SemGive(timer->semaphore);
-	return NULL;
+	for (ptr = &svc->timers; *ptr; ptr = &((*ptr)->next))
+	{
+		if (timeIsPast(&timer->deadline, &(*ptr)->deadline))
+		{
+			break;
+		}
+	}
+
+	timer->next = *ptr;
+	*ptr = timer;
+	if (ptr == &svc->timers)
+	{
+		pthread_cond_signal(&svc->cv);
+	}
+
+	pthread_mutex_unlock(&svc->mutex);
+	return 0;
 }
 
-int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
+static int	stopTimer(ReceiveTimer *timer)
+{
+	ReceiveTimerService	*svc = &_timerService;
+	ReceiveTimer		**ptr;
+	int			expired;
+
+	/*	Returns 1 if the timer had already expired, else 0.	*/
+
+	pthread_mutex_lock(&svc->mutex);
+	for (ptr = &svc->timers; *ptr; ptr = &((*ptr)->next))
+	{
+		if (*ptr == timer)
+		{
+			*ptr = timer->next;
+			break;
+		}
+	}
+
+	expired = timer->expired;
+	pthread_mutex_unlock(&svc->mutex);
+	return expired;
+}
+
+static int	receiveBundle(BpSAP sap, BpDelivery *dlvBuffer,
+			struct timeval *interval)
 {
 	Sdr		sdr = getIonsdr();
 	VEndpoint	*vpoint;
@@ -626,16 +723,11 @@ int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
 	Object		dlvElt;
 	Object		bundleAddr;
 	Bundle		bundle;
-	TimerParms	timerParms;
-	pthread_t	timerThread;
+	ReceiveTimer	timer;
 	int		result;
 
-	CHKERR(sap && dlvBuffer);
-	if (timeoutSeconds < BP_BLOCKING)
-	{
-		putErrmsg("Illegal timeout interval.", itoa(timeoutSeconds));
-		return -1;
-	}
+	/*	interval NULL means block indefinitely; zero interval
+	 *	means poll.						*/
 
 	vpoint = sap->vpoint;
 	CHKERR(sdr_begin_xn(sdr));
@@ -667,7 +759,8 @@ int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
 	if (dlvElt == 0)
 	{
 		sdr_exit_xn(sdr);
-		if (timeoutSeconds == BP_POLL)
+		if (interval && interval->tv_sec == 0
+		&& interval->tv_usec == 0)
 		{
 			dlvBuffer->result = BpReceptionTimedOut;
 			return 0;
@@ -676,19 +769,11 @@ int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
 		/*	Wait for semaphore to be given, either by the
 		 *	deliverBundle() function or by timer thread.	*/
 
-		if (timeoutSeconds == BP_BLOCKING)
-		{
-			timerParms.interval = -1;
-		}
-		else	/*	This is a receive() with a deadline.	*/
+		if (interval)	/*	This receive has a deadline.	*/
 		{
-			timerParms.interval = timeoutSeconds;
-			timerParms.semaphore = vpoint->semaphore;
-			if (pthread_begin(&timerThread, NULL, timerMain,
-					&timerParms, "bprcvTimer") < 0)
+			if (startTimer(&timer, vpoint->semaphore, interval) < 0)
 			{
-				putSysErrmsg("Can't enable interval timer",
-						NULL);
+				putErrmsg("Can't enable interval timer.", NULL);
 				return -1;
 			}
 		}
@@ -697,10 +782,16 @@ int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
 
 		if (sm_SemTake(vpoint->semaphore) < 0)
 		{
+			if (interval)
+			{
+				oK(stopTimer(&timer));
+			}
+
 			putErrmsg("Can't take endpoint semaphore.", NULL);
 			return -1;
 		}
 
+		result = (interval ? stopTimer(&timer) : 0);
 		if (sm_SemEnded(vpoint->semaphore))
 		{
 			writeMemo("[i] Endpoint has been stopped.");
@@ -721,33 +812,17 @@ int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
 			 *	or else timer thread gave semaphore.	*/
 
 			sdr_exit_xn(sdr);
-			if (timerParms.interval == 0)
+			if (result)	/*	Timer expired.		*/
 			{
-				/*	Timer expired.			*/
-
 				dlvBuffer->result = BpReceptionTimedOut;
-				pthread_join(timerThread, NULL);
 			}
-			else	/*	Interrupted.			*/
+			else		/*	Interrupted.		*/
 			{
 				dlvBuffer->result = BpReceptionInterrupted;
-				if (timerParms.interval != -1)
-				{
-					pthread_end(timerThread);
-					pthread_join(timerThread, NULL);
-				}
 			}
 
 			return 0;
 		}
-		else		/*	Bundle was delivered.		*/
-		{
-			if (timerParms.interval != -1)
-			{
-				pthread_end(timerThread);
-				pthread_join(timerThread, NULL);
-			}
-		}
 	}
 
 	/*	At this point, we have got a dlvElt and are in an SDR
@@ -826,6 +901,48 @@ int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
 	return 0;
 }
 
+int	bp_receive(BpSAP sap, BpDelivery *dlvBuffer, int timeoutSeconds)
+{
+	struct timeval	interval;
+
+	CHKERR(sap && dlvBuffer);
+	if (timeoutSeconds < BP_BLOCKING)
+	{
+		putErrmsg("Illegal timeout interval.", itoa(timeoutSeconds));
+		return -1;
+	}
+
+	if (timeoutSeconds == BP_BLOCKING)
+	{
+		return receiveBundle(sap, dlvBuffer, NULL);
+	}
+
+	interval.tv_sec = timeoutSeconds;
+	interval.tv_usec = 0;
+	return receiveBundle(sap, dlvBuffer, &interval);
+}
+
+int	bp_receive_ms(BpSAP sap, BpDelivery *dlvBuffer, int timeoutMsec)
+{
+	struct timeval	interval;
+
+	CHKERR(sap && dlvBuffer);
+	if (timeoutMsec < BP_BLOCKING)
+	{
+		putErrmsg("Illegal timeout interval.", itoa(timeoutMsec));
+		return -1;
+	}
+
+	if (timeoutMsec == BP_BLOCKING)
+	{
+		return receiveBundle(sap, dlvBuffer, NULL);
+	}
+
+	interval.tv_sec = timeoutMsec / 1000;
+	interval.tv_usec = (timeoutMsec % 1000) * 1000;
+	return receiveBundle(sap, dlvBuffer, &interval);
+}
+
 void	bp_interrupt(BpSAP sap)
 {
 	/*	Give semaphore, simulating reception notice.		*/
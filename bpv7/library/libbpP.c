@@ -759,6 +759,55 @@ static void	resetPlan(VPlan *vplan)
 	vplan->clmPid = ERROR;
 }
 
+/*	The planIndex of the volatile database is an RB tree of
+ *	references to the elements of the list of VPlans, ordered by
+ *	node number, for the plans whose neighbor EIDs are of the form
+ *	"ipn:<node number>.0".  It enables the forwarders to find the
+ *	plan for a neighboring node without formatting an EID string
+ *	and comparing it to the EIDs of all plans.			*/
+
+static int	isNodePlan(VPlan *vplan)
+{
+	char	eid[MAX_EID_LEN + 1];
+
+	if (vplan->neighborNodeNbr == 0)
+	{
+		return 0;
+	}
+
+	isprintf(eid, sizeof eid, "ipn:" UVAST_FIELDSPEC ".0",
+			vplan->neighborNodeNbr);
+	return (strcmp(vplan->neighborEid, eid) == 0);
+}
+
+static int	orderPlans(PsmPartition partition, PsmAddress nodeData,
+			void *dataBuffer)
+{
+	VPlan	*vplan;
+	uvast	nodeNbr;
+
+	if (partition == NULL || nodeData == 0 || dataBuffer == 0)
+	{
+		putErrmsg("Error calling smrbt plan index compare function.",
+				NULL);
+		return 0;
+	}
+
+	vplan = (VPlan *) psp(partition, sm_list_data(partition, nodeData));
+	nodeNbr = *((uvast *) dataBuffer);
+	if (vplan->neighborNodeNbr < nodeNbr)
+	{
+		return -1;
+	}
+
+	if (vplan->neighborNodeNbr > nodeNbr)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
 static int	raisePlan(Object planElt, BpVdb *bpvdb)
 {
 	Sdr		sdr = getIonsdr();
@@ -821,16 +870,33 @@ static int	raisePlan(Object planElt, BpVdb *bpvdb)
 	vplan->semaphore = SM_SEM_NONE;
 	vplan->xmitThrottle.nominalRate = plan.nominalRate;
 	vplan->xmitThrottle.capacity = plan.nominalRate;
+	if (isNodePlan(vplan))
+	{
+		if (sm_rbt_insert(bpwm, bpvdb->planIndex, elt, orderPlans,
+				&vplan->neighborNodeNbr) == 0)
+		{
+			oK(sm_list_delete(bpwm, elt, NULL, NULL));
+			psm_free(bpwm, addr);
+			return -1;
+		}
+	}
+
 	resetPlan(vplan);
 	return 0;
 }
 
-static void	dropPlan(VPlan *vplan, PsmAddress vplanElt)
+static void	dropPlan(VPlan *vplan, PsmAddress vplanElt, BpVdb *bpvdb)
 {
 	PsmPartition	bpwm = getIonwm();
 	PsmAddress	vplanAddr;
 
 	vplanAddr = sm_list_data(bpwm, vplanElt);
+	if (isNodePlan(vplan))
+	{
+		sm_rbt_delete(bpwm, bpvdb->planIndex, orderPlans,
+				&vplan->neighborNodeNbr, NULL, NULL);
+	}
+
 	if (vplan->semaphore != SM_SEM_NONE)
 	{
 		sm_SemEnd(vplan->semaphore);
@@ -1283,6 +1349,7 @@ static BpVdb	*_bpvdb(char **name)
 		vdb->watching = db->watching;
 		if ((vdb->schemes = sm_list_create(wm)) == 0
 		|| (vdb->plans = sm_list_create(wm)) == 0
+		|| (vdb->planIndex = sm_rbt_create(wm)) == 0
 		|| (vdb->inducts = sm_list_create(wm)) == 0
 		|| (vdb->outducts = sm_list_create(wm)) == 0
 		|| (vdb->discoveries = sm_list_create(wm)) == 0
@@ -1526,10 +1593,11 @@ static void	dropVdb(PsmPartition wm, PsmAddress vdbAddress)
 	while ((elt = sm_list_first(wm, vdb->plans)) != 0)
 	{
 		vplan = (VPlan *) psp(wm, sm_list_data(wm, elt));
-		dropPlan(vplan, elt);
+		dropPlan(vplan, elt, vdb);
 	}
 
 	sm_list_destroy(wm, vdb->plans, NULL, NULL);
+	sm_rbt_destroy(wm, vdb->planIndex, NULL, NULL);
 	while ((elt = sm_list_first(wm, vdb->inducts)) != 0)
 	{
 		vinduct = (VInduct *) psp(wm, sm_list_data(wm, elt));
@@ -3919,6 +3987,25 @@ void	findPlan(char *eidIn, VPlan **vplan, PsmAddress *vplanElt)
 	}
 }
 
+void	findPlanForNode(uvast nodeNbr, VPlan **vplan, PsmAddress *vplanElt)
+{
+	PsmPartition	bpwm = getIonwm();
+	PsmAddress	node;
+
+	CHKVOID(vplanElt);
+	*vplanElt = 0;			/*	Default.		*/
+	CHKVOID(vplan);
+	node = sm_rbt_search(bpwm, (_bpvdb(NULL))->planIndex, orderPlans,
+			&nodeNbr, NULL);
+	if (node == 0)
+	{
+		return;
+	}
+
+	*vplanElt = sm_rbt_data(bpwm, node);
+	*vplan = (VPlan *) psp(bpwm, sm_list_data(bpwm, *vplanElt));
+}
+
 int	addPlan(char *eidIn, unsigned int nominalRate)
 {
 	Sdr		sdr = getIonsdr();
@@ -4128,7 +4215,7 @@ int	removePlan(char *eidIn)
 
 	/*	First remove the plan's volatile state.			*/
 
-	dropPlan(vplan, vplanElt);
+	dropPlan(vplan, vplanElt, _bpvdb(NULL));
 
 	/*	Then remove the plan's non-volatile state.		*/
 
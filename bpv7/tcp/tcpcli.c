@@ -26,6 +26,10 @@
 #endif
 #endif
 
+#ifndef TCPCL_READAHEAD
+#define	TCPCL_READAHEAD		(4096)
+#endif
+
 #ifndef KEEPALIVE_INTERVAL
 #define KEEPALIVE_INTERVAL	(15)
 #endif
@@ -81,7 +85,9 @@
  *	that executes most of the TCPCL protocol, and has a
  *	transmission thread that dequeues bundles from one of
  *	the outducts assigned to the egress plan corresponding
- *	to the Neighbor and transmits data segments.
+ *	to the Neighbor and transmits data segments.  The
+ *	acknowledgments and keepalives of all sessions are
+ *	sent by a single signaler thread.
  *
  *	When TCPCL data segments are acknowledged, the
  *	acknowledgments are applied to transmitted bundles
@@ -122,13 +128,11 @@ typedef struct
 
 	/*	Administration function.				*/
 
-	pthread_t		admin;
-	int			hasAdmin;	/*	Boolean.	*/
 	Lyst			signals;
 	pthread_mutex_t		sigMutex;	/*	For signals.	*/
 	int			hasSigMutex;	/*	Boolean.	*/
-	struct llcv_str		triggerLlcv;
-	Llcv			trigger;	/*	On signals.	*/
+	int			signalsPending;	/*	Boolean.	*/
+	int			signalsDeferred;/*	Boolean.	*/
 
 	/*	Transmission function.					*/
 
@@ -175,7 +179,123 @@ static void	handleStopTcpcli(int signum)
 
 /*	*	*	Utility functions	*	*	*	*/
 
-static int	receiveSdnv(TcpclSession *p, uvast *val)
+/*	*	Session and neighbor management functions	*	*/
+
+typedef struct
+{
+	Lyst		neighbors;
+	TcpclSession	*session;
+	char		*buffer;
+	int		bufStart;	/*	Next unparsed byte.	*/
+	int		bufEnd;		/*	End of bytes read.	*/
+	AcqWorkArea	*work;
+	ReqAttendant	attendant;
+} ReceiverThreadParms;
+
+typedef struct
+{
+	TcpclSession	*session;
+	char		*buffer;
+	Outflow		outflows[3];
+} SenderThreadParms;
+
+/*	The receiver thread reads from the session's socket into
+ *	its buffer as many bytes as are available, up to the size of
+ *	the buffer, and parses message headers and SDNVs out of the
+ *	buffer; several small messages can thus be received in one
+ *	recv() call.  Large data segment extents are read without
+ *	read-ahead, so that they don't have to be moved within the
+ *	buffer.								*/
+
+static int	fillBuffer(ReceiverThreadParms *rtp, int length)
+{
+	TcpclSession	*session = rtp->session;
+	int		bytesBuffered = rtp->bufEnd - rtp->bufStart;
+	int		bytesToRead;
+	int		bytesRead;
+
+	if (bytesBuffered == 0)
+	{
+		rtp->bufStart = 0;
+		rtp->bufEnd = 0;
+	}
+	else if (rtp->bufStart + length > TCPCL_BUFSZ)
+	{
+		memmove(rtp->buffer, rtp->buffer + rtp->bufStart,
+				bytesBuffered);
+		rtp->bufStart = 0;
+		rtp->bufEnd = bytesBuffered;
+	}
+
+	while (bytesBuffered < length)
+	{
+		if (session->sock == -1)	/*	Closed.		*/
+		{
+			return 0;
+		}
+
+		if (length > TCPCL_READAHEAD)
+		{
+			bytesToRead = length - bytesBuffered;
+		}
+		else
+		{
+			bytesToRead = TCPCL_BUFSZ - rtp->bufEnd;
+		}
+
+		bytesRead = irecv(session->sock, rtp->buffer + rtp->bufEnd,
+				bytesToRead, 0);
+		switch (bytesRead)
+		{
+		case -1:
+			if (errno != EINTR)	/*	(Shutdown)	*/
+			{
+				putSysErrmsg("irecv() error on TCP socket",
+						session->outductName);
+			}
+
+			/*	Intentional fall-through to next case.	*/
+
+		case 0:			/*	Neighbor closed.	*/
+			return 0;
+		}
+
+		rtp->bufEnd += bytesRead;
+		bytesBuffered += bytesRead;
+	}
+
+	return length;
+}
+
+static int	receiveBytes(ReceiverThreadParms *rtp, char *into, int length)
+{
+	int	bytesReceived = 0;
+	int	bytesToCopy;
+
+	while (length > 0)
+	{
+		bytesToCopy = length;
+		if (bytesToCopy > TCPCL_BUFSZ)
+		{
+			bytesToCopy = TCPCL_BUFSZ;
+		}
+
+		if (fillBuffer(rtp, bytesToCopy) < 1)
+		{
+			return 0;
+		}
+
+		memcpy(into, rtp->buffer + rtp->bufStart, bytesToCopy);
+		rtp->bufStart += bytesToCopy;
+		into += bytesToCopy;
+		length -= bytesToCopy;
+		bytesReceived += bytesToCopy;
+	}
+
+	return bytesReceived;
+}
+
+static int	receiveSdnv(ReceiverThreadParms *rtp, uvast *val)
 {
 	int		sdnvLength = 0;
 	unsigned char	byte;
@@ -200,23 +320,16 @@ static int	receiveSdnv(TcpclSession *p, uvast *val)
 
 		*val <<= 7;
 
-		/*	Receive next byte of SDNV.			*/
+		/*	Take next byte of SDNV from the buffer.		*/
 
-		switch (irecv(p->sock, (char *) &byte, 1, 0))
+		if (fillBuffer(rtp, 1) < 1)
 		{
-		case -1:
-			if (errno != EINTR)	/*	(Shutdown)	*/
-			{
-				putSysErrmsg("irecv() error on TCP socket",
-						p->outductName);
-			}
-
-			/*	Intentional fall-through to next case.	*/
-
-		case 0:			/*	Neighbor closed.	*/
 			return 0;
 		}
 
+		byte = rtp->buffer[rtp->bufStart];
+		rtp->bufStart++;
+
 		/*	Insert SDNV byte value (with its high-order
 		 *	bit masked off) as low-order 7 bits of the
 		 *	numeric value.					*/
@@ -231,24 +344,6 @@ static int	receiveSdnv(TcpclSession *p, uvast *val)
 	return sdnvLength;		/*	Succeeded.		*/
 }
 
-/*	*	Session and neighbor management functions	*	*/
-
-typedef struct
-{
-	Lyst		neighbors;
-	TcpclSession	*session;
-	char		*buffer;
-	AcqWorkArea	*work;
-	ReqAttendant	attendant;
-} ReceiverThreadParms;
-
-typedef struct
-{
-	TcpclSession	*session;
-	char		*buffer;
-	Outflow		outflows[3];
-} SenderThreadParms;
-
 static LystElt	findNeighborForEid(Lyst neighbors, char *eid)
 {
 	LystElt		elt;
@@ -394,27 +489,11 @@ static int	beginSession(LystElt neighborElt, int newSocket, int sessionIdx)
 		return -1;
 	}
 
-	session->trigger = llcv_open(session->signals, &(session->triggerLlcv));
-	if (session->trigger == NULL)
-	{
-		lyst_destroy(session->signals);
-		session->signals = NULL;
-		llcv_close(session->throttle);
-		session->throttle = NULL;
-		lyst_destroy(session->pipeline);
-		session->pipeline = NULL;
-		putErrmsg("tcpcli can't open signals list.", NULL);
-		ionKillMainThread(procName());
-		return -1;
-	}
-
 	/*	Receiver thread.					*/
 
 	rtp = (ReceiverThreadParms *) MTAKE(sizeof(ReceiverThreadParms));
 	if (rtp == NULL)
 	{
-		llcv_close(session->trigger);
-		session->trigger = NULL;
 		lyst_destroy(session->signals);
 		session->signals = NULL;
 		llcv_close(session->throttle);
@@ -447,8 +526,6 @@ static int	beginSession(LystElt neighborElt, int newSocket, int sessionIdx)
 		pthread_mutex_unlock(&(session->socketMutex));
 		pthread_mutex_destroy(&(session->socketMutex));
 		session->hasSocketMutex = 0;
-		llcv_close(session->trigger);
-		session->trigger = NULL;
 		lyst_destroy(session->signals);
 		session->signals = NULL;
 		llcv_close(session->throttle);
@@ -516,9 +593,45 @@ static int pipeline_not_full(Llcv llcv)
 	return (lyst_length(llcv->list) < MAX_PIPELINE_LENGTH ? 1 : 0);
 }
 
+/*	The signaler thread sends the acknowledgments and
+ *	keepalives queued for all sessions.  A session with queued
+ *	signals is appended to the signaler's list of ready
+ *	sessions; the signaler sends the signals of each ready
+ *	session whose socket is not in use.  A sender thread that
+ *	is using its session's socket sends the session's queued
+ *	signals itself before releasing the socket.  A ready
+ *	session whose socket is in use is instead deferred until
+ *	the socket is released, at which time it is made ready
+ *	again.								*/
+
+typedef struct
+{
+	Lyst		ready;		/*	(TcpclSession *)	*/
+	struct llcv_str	readyLlcv;
+	Llcv		trigger;	/*	On ready list.	*/
+	TcpclSession	*current;	/*	Being serviced.	*/
+	pthread_cond_t	idle;		/*	current cleared	*/
+	int		running;	/*	Boolean.	*/
+	pthread_t	thread;
+} TcpclSignaler;
+
+static TcpclSignaler	*_signaler()
+{
+	static TcpclSignaler	signaler;
+
+	return &signaler;
+}
+
+static int	signals_ready(Llcv llcv)
+{
+	CHKZERO(llcv);
+	return (lyst_length(llcv->list) > 0 || _signaler()->running == 0);
+}
+
 static int	sendSignal(TcpclSession *session, saddr lengthReceived)
 {
-	LystElt	result;
+	TcpclSignaler	*signaler = _signaler();
+	LystElt		result;
 
 	pthread_mutex_lock(&session->sigMutex);
 	result = lyst_insert_last(session->signals, (void *) lengthReceived);
@@ -529,24 +642,150 @@ static int	sendSignal(TcpclSession *session, saddr lengthReceived)
 		return -1;
 	}
 
-	llcv_signal(session->trigger, llcv_lyst_not_empty);
+	llcv_lock(signaler->trigger);
+	if (session->signalsPending == 0)
+	{
+		if (lyst_insert_last(signaler->ready, (void *) session)
+				== NULL)
+		{
+			llcv_unlock(signaler->trigger);
+			putErrmsg("tcpcli can't note signals pending", NULL);
+			return -1;
+		}
+
+		session->signalsPending = 1;
+		llcv_signal_while_locked(signaler->trigger, signals_ready);
+	}
+
+	llcv_unlock(signaler->trigger);
 	return 0;
 }
 
-static void	stopAdminThread(TcpclSession *session)
+static void	forgetSignals(TcpclSession *session)
 {
-	/*	Signal thread in case it's not already stopping.	*/
+	TcpclSignaler	*signaler = _signaler();
+	LystElt		elt;
 
-	if (session->sock != -1)
+	/*	Ensure that the signaler no longer references this
+	 *	session, which is being closed or moved.		*/
+
+	if (signaler->trigger == NULL)
 	{
-		shutdown(session->sock, SD_BOTH);
-		closesocket(session->sock);
-		session->sock = -1;
+		return;
+	}
+
+	llcv_lock(signaler->trigger);
+	if (session->signalsPending)
+	{
+		for (elt = lyst_first(signaler->ready); elt;
+				elt = lyst_next(elt))
+		{
+			if (lyst_data(elt) == (void *) session)
+			{
+				lyst_delete(elt);
+				break;
+			}
+		}
+
+		session->signalsPending = 0;
+		session->signalsDeferred = 0;
+	}
+
+	while (signaler->current == session)
+	{
+		pthread_cond_wait(&signaler->idle, &signaler->trigger->mutex);
+	}
+
+	llcv_unlock(signaler->trigger);
+}
+
+static void	releaseSocket(TcpclSession *session)
+{
+	TcpclSignaler	*signaler = _signaler();
+
+	pthread_mutex_unlock(&(session->socketMutex));
+	if (signaler->trigger == NULL)
+	{
+		return;
+	}
+
+	/*	If the signaler found this socket in use, make the
+	 *	session ready again now that the socket is free.	*/
+
+	llcv_lock(signaler->trigger);
+	if (session->signalsDeferred)
+	{
+		session->signalsDeferred = 0;
+		if (lyst_insert_last(signaler->ready, (void *) session)
+				== NULL)
+		{
+			session->signalsPending = 0;
+		}
+		else
+		{
+			llcv_signal_while_locked(signaler->trigger,
+					signals_ready);
+		}
 	}
 
-	oK(sendSignal(session, -1));		/*	Shutdown.	*/
-	pthread_join(session->admin, NULL);
-	session->hasAdmin = 0;
+	llcv_unlock(signaler->trigger);
+}
+
+static int	flushSignals(TcpclSession *session)
+{
+	TcpclNeighbor	*neighbor = session->neighbor;
+	char		*tag = session->outductName;
+	LystElt		elt;
+	saddr		lengthReceived;
+	char		keepalive[1] = { 0x40 };
+	char		ack[11];
+	Sdnv		ackLengthSdnv;
+	int		len;
+
+	/*	Caller must have locked the session's socket.		*/
+
+	if (neighbor->vplan)
+	{
+		tag = neighbor->vplan->neighborEid;
+	}
+
+	while (1)
+	{
+		pthread_mutex_lock(&session->sigMutex);
+		elt = lyst_first(session->signals);
+		if (elt == NULL)
+		{
+			pthread_mutex_unlock(&session->sigMutex);
+			return 1;
+		}
+
+		lengthReceived = (saddr) lyst_data(elt);
+		lyst_delete(elt);
+		pthread_mutex_unlock(&session->sigMutex);
+		if (lengthReceived == 0)	/*	Keepalive.	*/
+		{
+			if (itcp_send(&(session->sock), keepalive, 1) < 1)
+			{
+				writeMemoNote("[?] tcpcl session lost \
+(keepalive)", tag);
+				return 0;
+			}
+
+			continue;
+		}
+
+		/*	Signal is an acknowledgment.			*/
+
+		ack[0] = 0x20;
+		encodeSdnv(&ackLengthSdnv, lengthReceived);
+		memcpy(ack + 1, ackLengthSdnv.text, ackLengthSdnv.length);
+		len = 1 + ackLengthSdnv.length;
+		if (itcp_send(&(session->sock), ack, len) < 1)
+		{
+			writeMemoNote("[?] tcpcl session lost (ack)", tag);
+			return 0;
+		}
+	}
 }
 
 static void	stopSenderThread(TcpclSession *session)
@@ -647,11 +886,6 @@ static void	closeSession(TcpclSession *session)
 	}
 
 	session->secUntilKeepalive = -1;
-	if (session->hasAdmin)
-	{
-		stopAdminThread(session);
-	}
-
 	if (session->hasSender)
 	{
 		stopSenderThread(session);
@@ -667,6 +901,7 @@ static void	closeSession(TcpclSession *session)
 	oK(sdr_begin_xn(sdr));
 	lyst_clear(session->pipeline);
 	oK(sdr_end_xn(sdr));
+	forgetSignals(session);
 	if (session->hasSigMutex)
 	{
 		pthread_mutex_lock(&session->sigMutex);
@@ -734,7 +969,7 @@ static int	sendShutdown(TcpclSession *session, char reason,
 
 	pthread_mutex_lock(&(session->socketMutex));
 	result = itcp_send(&(session->sock), shutdown, len);
-	pthread_mutex_unlock(&(session->socketMutex));
+	releaseSocket(session);
 	return result;
 }
 
@@ -796,13 +1031,7 @@ static void	endSession(TcpclSession *session, char reason)
 		lyst_destroy(session->pipeline);
 	}
 
-	if (session->trigger)
-	{
-		llcv_signal(session->trigger, llcv_lyst_not_empty);
-		llcv_close(session->trigger);
-		session->trigger = NULL;
-	}
-
+	forgetSignals(session);
 	if (session->signals)
 	{
 		lyst_destroy(session->signals);
@@ -855,7 +1084,6 @@ static int	sendBundleByTcpcl(SenderThreadParms *stp, Object bundleZco)
 	int		flags;
 	ZcoReader	reader;
 	uvast		bytesToLoad;
-	uvast		bytesToSend;
 	int		firstByte;
 	Sdnv		segLengthSdnv;
 	char		segHeader[4];
@@ -903,16 +1131,6 @@ pipeline.", session->outductName);
 			flags |= 0x01;		/*	Last segment.	*/
 		}
 
-		CHKERR(sdr_begin_xn(sdr));
-		bytesToSend = zco_transmit(sdr, &reader, bytesToLoad,
-				stp->buffer);
-		if (sdr_end_xn(sdr) < 0 || bytesToSend != bytesToLoad)
-		{
-			putErrmsg("Incomplete zco_transmit.",
-					session->outductName);
-			return -1;
-		}
-
 		firstByte = 0x10 | flags;
 		segHeader[0] = firstByte;
 		encodeSdnv(&segLengthSdnv, bytesToLoad);
@@ -921,23 +1139,46 @@ pipeline.", session->outductName);
 		pthread_mutex_lock(&(session->socketMutex));
 		if (itcp_send(&(session->sock), segHeader, segHeaderLen) < 1)
 		{
-			pthread_mutex_unlock(&(session->socketMutex));
+			releaseSocket(session);
 			writeMemoNote("[?] tcpcl session lost (seg header)",
 					neighbor->vplan->neighborEid);
 			return 0;
 		}
 
-		if (itcp_send(&(session->sock), stp->buffer, bytesToSend) < 1)
+		/*	Segment content that is sourced from a file
+		 *	is sent directly from the file.			*/
+
+		switch (ionSendZcoSpansByTCP(&(session->sock), &reader,
+				bytesToLoad, stp->buffer))
 		{
-			pthread_mutex_unlock(&(session->socketMutex));
+		case -1:
+			releaseSocket(session);
+			putErrmsg("Can't send segment content.",
+					session->outductName);
+			return -1;
+
+		case 0:
+			releaseSocket(session);
 			writeMemoNote("[?] tcpcl session lost (seg content)",
 					neighbor->vplan->neighborEid);
 			return 0;
+
+		default:
+			break;
 		}
 
-		pthread_mutex_unlock(&(session->socketMutex));
+		/*	Send any acknowledgments and keepalives that
+		 *	were queued while the socket was in use.	*/
+
+		if (flushSignals(session) == 0)
+		{
+			releaseSocket(session);
+			return 0;
+		}
+
+		releaseSocket(session);
 		flags = 0x00;			/*	No longer 1st.	*/
-		bytesRemaining -= bytesToSend;
+		bytesRemaining -= bytesToLoad;
 	}
 
 	if (session->segmentAcks == 0)
@@ -1070,106 +1311,85 @@ static void	*sendBundles(void *parm)
 	return NULL;
 }
 
-/*	*	*	Admin thread functions		*	*	*/
+/*	*	*	Signaler thread functions	*	*	*/
 
 static void	*sendSignals(void *parm)
 {
-	SenderThreadParms	*stp = (SenderThreadParms *) parm;
-	TcpclSession		*session = stp->session;
-	char			*tag = session->outductName;
-	TcpclNeighbor		*neighbor = session->neighbor;
-	int			running = 1;
-	LystElt			elt;
-	saddr			lengthReceived;
-	char			keepalive[1] = { 0x40 };
-	int			result;
-	char			ack[11];
-	Sdnv			ackLengthSdnv;
-	int			len;
-
-	session->hasAdmin = 1;
-	if (neighbor->vplan)
-	{
-		tag = neighbor->vplan->neighborEid;
-	}
-
-	writeMemoNote("[i] tcpcli admin thread has started", tag);
-
-	/*	ready to  start sending signals.			*/
+	TcpclSignaler	*signaler = (TcpclSignaler *) parm;
+	int		sessionsToService;
+	LystElt		elt;
+	TcpclSession	*session;
+	int		result;
 
-	while (running)
+	writeMemo("[i] tcpcli signaler thread has started.");
+	while (1)
 	{
-		if (llcv_wait(session->trigger, llcv_lyst_not_empty,
-				LLCV_BLOCKING))
+		if (llcv_wait(signaler->trigger, signals_ready, LLCV_BLOCKING))
 		{
 			putErrmsg("Wait on TCPCL signal trigger condition \
-failed.", tag);
+failed.", NULL);
 			ionKillMainThread(procName());
-			return NULL;
+			break;
 		}
 
-		/*	Grab the socket, then send all queued-up
-			acknowledgments and keepalives.			*/
-
-		if (session->sock == -1)
+		if (signaler->running == 0)
 		{
-			running = 0;
-			continue;
+			break;
 		}
 
-		pthread_mutex_lock(&(session->socketMutex));
-		while (lyst_length(session->signals) > 0)
+		/*	Service each ready session once.		*/
+
+		llcv_lock(signaler->trigger);
+		sessionsToService = lyst_length(signaler->ready);
+		while (sessionsToService > 0)
 		{
-			pthread_mutex_lock(&session->sigMutex);
-			elt = lyst_first(session->signals);
-			lengthReceived = (saddr) lyst_data(elt);
-			lyst_delete(elt);
-			pthread_mutex_unlock(&session->sigMutex);
-			if (lengthReceived == -1)/*	Shutdown.	*/
+			sessionsToService--;
+			elt = lyst_first(signaler->ready);
+			if (elt == NULL)
 			{
-				running = 0;
 				break;
 			}
 
-			if (lengthReceived == 0)/*	Keepalive.	*/
+			session = (TcpclSession *) lyst_data(elt);
+			if (pthread_mutex_trylock(&(session->socketMutex)))
 			{
-				result = itcp_send(&(session->sock),
-						keepalive, 1);
-				if (result < 1)
-				{
-					writeMemoNote("[?] tcpcl session \
-lost (keepalive)", tag);
-					ionKillMainThread(procName());
-					running = 0;
-					break;
-				}
+				/*	Socket is in use; defer the
+				 *	session until releaseSocket.	*/
 
+				lyst_delete(elt);
+				session->signalsDeferred = 1;
 				continue;
 			}
 
-			/*	Signal is an acknowledgment.		*/
+			lyst_delete(elt);
+			session->signalsPending = 0;
+			signaler->current = session;
+			llcv_unlock(signaler->trigger);
+			if (session->sock == -1)	/*	Closed.	*/
+			{
+				result = 1;
+			}
+			else
+			{
+				result = flushSignals(session);
+			}
 
-			ack[0] = 0x20;
-			encodeSdnv(&ackLengthSdnv, lengthReceived);
-			memcpy(ack + 1, ackLengthSdnv.text,
-					ackLengthSdnv.length);
-			len = 1 + ackLengthSdnv.length;
-			result = itcp_send(&(session->sock), ack, len);
-			if (result < 1)
+			pthread_mutex_unlock(&(session->socketMutex));
+			if (result == 0)
 			{
-				writeMemoNote("[?] tcpcl session lost \
-(ack)", tag);
 				ionKillMainThread(procName());
-				running = 0;
-				break;
 			}
+
+			llcv_lock(signaler->trigger);
+			signaler->current = NULL;
+			pthread_cond_broadcast(&signaler->idle);
 		}
 
-		pthread_mutex_unlock(&(session->socketMutex));
+		llcv_unlock(signaler->trigger);
 	}
 
 	writeErrmsgMemos();
-	writeMemoNote("[i] tcpcli admin thread has ended", tag);
+	writeMemo("[i] tcpcli signaler thread has ended.");
 #if defined(bionic)
 	int task_id = sm_TaskIdSelf();
 	sm_TaskForget(task_id);
@@ -1177,6 +1397,55 @@ lost (keepalive)", tag);
 	return NULL;
 }
 
+static int	startSignaler()
+{
+	TcpclSignaler	*signaler = _signaler();
+
+	memset((char *) signaler, 0, sizeof(TcpclSignaler));
+	signaler->ready = lyst_create_using(getIonMemoryMgr());
+	if (signaler->ready == NULL)
+	{
+		putErrmsg("tcpcli can't create list of ready sessions.", NULL);
+		return -1;
+	}
+
+	signaler->trigger = llcv_open(signaler->ready,
+			&(signaler->readyLlcv));
+	if (signaler->trigger == NULL)
+	{
+		lyst_destroy(signaler->ready);
+		putErrmsg("tcpcli can't open list of ready sessions.", NULL);
+		return -1;
+	}
+
+	pthread_cond_init(&(signaler->idle), NULL);
+	signaler->running = 1;
+	if (pthread_begin(&(signaler->thread), NULL, sendSignals, signaler))
+	{
+		pthread_cond_destroy(&(signaler->idle));
+		llcv_close(signaler->trigger);
+		signaler->trigger = NULL;
+		lyst_destroy(signaler->ready);
+		putSysErrmsg("tcpcli can't create signaler thread", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void	stopSignaler()
+{
+	TcpclSignaler	*signaler = _signaler();
+
+	signaler->running = 0;
+	llcv_signal(signaler->trigger, signals_ready);
+	pthread_join(signaler->thread, NULL);
+	pthread_cond_destroy(&(signaler->idle));
+	llcv_close(signaler->trigger);
+	signaler->trigger = NULL;
+	lyst_destroy(signaler->ready);
+}
+
 /*	*	*	Receiver thread functions	*	*	*/
 
 static int	sendContactHeader(TcpclSession *session)
@@ -1216,7 +1485,7 @@ static int	sendContactHeader(TcpclSession *session)
 
 	pthread_mutex_lock(&(session->socketMutex));
 	result = itcp_send(&(session->sock), contactHeader, len);
-	pthread_mutex_unlock(&(session->socketMutex));
+	releaseSocket(session);
 	return result;
 }
 
@@ -1247,7 +1516,7 @@ static int	receiveContactHeader(ReceiverThreadParms *rtp)
 		return -1;
 	}
 
-	if (itcp_recv(&session->sock, (char *) header, sizeof header) < 1)
+	if (receiveBytes(rtp, (char *) header, sizeof header) < 1)
 	{
 		putErrmsg("Can't get TCPCL contact header.",
 				session->outductName);
@@ -1302,7 +1571,7 @@ static int	receiveContactHeader(ReceiverThreadParms *rtp)
 
 	/*	Next is the neighboring node's ID, an endpoint ID.	*/
 
-	if (receiveSdnv(session, &eidLength) < 1)
+	if (receiveSdnv(rtp, &eidLength) < 1)
 	{
 		putErrmsg("Can't get EID length in TCPCL contact header",
 				session->outductName);
@@ -1317,7 +1586,7 @@ static int	receiveContactHeader(ReceiverThreadParms *rtp)
 		return -1;
 	}
 
-	if (itcp_recv(&session->sock, eidbuf, eidLength) < 1)
+	if (receiveBytes(rtp, eidbuf, eidLength) < 1)
 	{
 		MRELEASE(eidbuf);
 		putErrmsg("Can't get TCPCL contact header EID.",
@@ -1360,6 +1629,7 @@ static int	receiveContactHeader(ReceiverThreadParms *rtp)
 				/*	Copy this session into
 				 *	known neighbor.			*/
 
+				forgetSignals(session);
 				memcpy((char *) chanceSession, (char *) session,
 						sizeof(TcpclSession));
 				chanceSession->neighbor = knownNeighbor;
@@ -1376,7 +1646,6 @@ static int	receiveContactHeader(ReceiverThreadParms *rtp)
 				session->hasReceiver = 0;
 				session->hasSender = 0;
 				session->vduct = NULL;
-				session->hasAdmin = 0;
 				session->pipeline = NULL;
 				session->signals = NULL;
 				session->outductName = NULL;
@@ -1384,14 +1653,6 @@ static int	receiveContactHeader(ReceiverThreadParms *rtp)
 				/*	Point to known neighbor session.*/
 
 				session = rtp->session;
-				if (session->trigger)
-				{
-					llcv_close(session->trigger);
-					session->trigger = NULL;
-				}
-
-				session->trigger = llcv_open(session->signals,
-						&(session->triggerLlcv));
 				if (session->throttle)
 				{
 					llcv_close(session->throttle);
@@ -1534,14 +1795,6 @@ plan for neighbor.", eidbuf);
 		return -1;
 	}
 
-	if (pthread_begin(&(session->admin), NULL, sendSignals, stp))
-	{
-		stopSenderThread(session);
-		putSysErrmsg("tcpcli can't create new admin thread", 
-				neighbor->vplan->neighborEid);
-		return -1;
-	}
-
 	return result;
 }
 
@@ -1556,7 +1809,7 @@ static int	handleDataSegment(ReceiverThreadParms *rtp,
 	int		bytesToRead;
 	int		extentSize;
 
-	result = receiveSdnv(session, &dataLength);
+	result = receiveSdnv(rtp, &dataLength);
 	if (result < 1)
 	{
 		return result;
@@ -1596,8 +1849,10 @@ static int	handleDataSegment(ReceiverThreadParms *rtp,
 			bytesToRead = TCPCL_BUFSZ;
 		}
 
-		extentSize = itcp_recv(&session->sock, rtp->buffer,
-				bytesToRead);
+		/*	Hand the extent to bundle acquisition straight
+		 *	from the receive buffer.			*/
+
+		extentSize = fillBuffer(rtp, bytesToRead);
 		if (extentSize < 1)
 		{
 			writeMemoNote("[?] Lost TCPCL neighbor",
@@ -1605,12 +1860,14 @@ static int	handleDataSegment(ReceiverThreadParms *rtp,
 			return 0;
 		}
 
-		if (bpContinueAcq(rtp->work, rtp->buffer, extentSize,
-				&(rtp->attendant), 0) < 0)
+		if (bpContinueAcq(rtp->work, rtp->buffer + rtp->bufStart,
+				extentSize, &(rtp->attendant), 0) < 0)
 		{
 			return -1;
 		}
 
+		rtp->bufStart += extentSize;
+
 		bytesRemaining -= extentSize;
 		session->lengthReceived += extentSize;
 		if (session->segmentAcks)	/*	Send ack.	*/
@@ -1659,7 +1916,7 @@ static int	handleAck(ReceiverThreadParms *rtp, unsigned char msgtypeByte)
 	LystElt		elt;
 	Object		bundleZco = 0;
 
-	result = receiveSdnv(session, &lengthAcked);
+	result = receiveSdnv(rtp, &lengthAcked);
 	if (result < 1)
 	{
 		return result;
@@ -1813,20 +2070,9 @@ static int	handleShutdown(ReceiverThreadParms *rtp,
 
 	if (msgtypeByte & 0x02)
 	{
-		result = irecv(session->sock, (char *) &reasonCode, 1, 0);
-		switch (result)
+		if (receiveBytes(rtp, (char *) &reasonCode, 1) < 1)
 		{
-		case -1:
-			if (errno != EINTR)	/*	(Shutdown)	*/
-			{
-				putSysErrmsg("irecv() error on TCP socket",
-						neighbor->vplan->neighborEid);
-			}
-
-			/*	Intentional fall-through to next case.	*/
-
-		case 0:			/*	Neighbor closed.	*/
-			return 0;
+			return 0;	/*	Neighbor closed.	*/
 		}
 
 		if (reasonCode == 0x01)	/*	Version mismatch.	*/
@@ -1837,7 +2083,7 @@ static int	handleShutdown(ReceiverThreadParms *rtp,
 
 	if (msgtypeByte & 0x01)
 	{
-		result = receiveSdnv(session, &reconnectInterval);
+		result = receiveSdnv(rtp, &reconnectInterval);
 		if (result < 1)
 		{
 			return result;
@@ -1859,7 +2105,7 @@ static int	handleLength(ReceiverThreadParms *rtp,
 	int	result;
 	uvast	bundleLength;
 
-	result = receiveSdnv(rtp->session, &bundleLength);
+	result = receiveSdnv(rtp, &bundleLength);
 	if (result < 1)
 	{
 		return result;
@@ -1876,19 +2122,9 @@ static int	handleMessages(ReceiverThreadParms *rtp)
 
 	while (1)
 	{
-		switch (irecv(session->sock, (char *) &msgtypeByte, 1, 0))
+		if (receiveBytes(rtp, (char *) &msgtypeByte, 1) < 1)
 		{
-		case -1:
-			if (errno != EINTR)	/*	Not shutdown.	*/
-			{
-				putSysErrmsg("irecv() error on TCP socket",
-						session->outductName);
-			}
-
-			/*	Intentional fall-through to next case.	*/
-
-		case 0:			/*	Neighbor closed.	*/
-			return 0;
+			return 0;	/*	Neighbor closed.	*/
 		}
 
 		msgType = (msgtypeByte >> 4) & 0x0f;
@@ -2078,6 +2314,8 @@ static void	*handleContacts(void *parm)
 		 *	exchange contact headers.			*/
 
 		session->isOpen = 1;
+		rtp->bufStart = 0;	/*	Discard any old data.	*/
+		rtp->bufEnd = 0;
 		if (sendContactHeader(session) < 1)
 		{
 			writeMemoNote("[i] tcpcli did not send contact header",
@@ -2905,6 +3143,17 @@ int	main(int argc, char *argv[])
 #endif
 	isignal(SIGTERM, handleStopTcpcli);
 
+	/*	Start the signaler thread.				*/
+
+	if (startSignaler() < 0)
+	{
+		closesocket(stp.serverSocket);
+		lyst_destroy(backlog);
+		lyst_destroy(neighbors);
+		putErrmsg("tcpcli can't start signaler.", NULL);
+		return 1;
+	}
+
 	/*	Start the clock thread, which immediately does
 	 *	initial load of the neighbors lyst.			*/
 
@@ -2915,6 +3164,7 @@ int	main(int argc, char *argv[])
 	ctp.backlogMutex = &backlogMutex;
 	if (pthread_begin(&clockThread, NULL, handleEvents, &ctp))
 	{
+		stopSignaler();
 		closesocket(stp.serverSocket);
 		lyst_destroy(backlog);
 		lyst_destroy(neighbors);
@@ -2938,6 +3188,7 @@ int	main(int argc, char *argv[])
 			pthread_join(clockThread, NULL);
 		}
 
+		stopSignaler();
 		closesocket(stp.serverSocket);
 		lyst_destroy(backlog);
 		lyst_destroy(neighbors);
@@ -2977,6 +3228,7 @@ int	main(int argc, char *argv[])
 		pthread_join(clockThread, NULL);
 	}
 
+	stopSignaler();
 	closesocket(stp.serverSocket);
 	pthread_mutex_destroy(&backlogMutex);
 	lyst_destroy(backlog);
@@ -72,6 +72,7 @@ static enum {
 	OUTPUT_JSON      = 1 << 0,
 	OUTPUT_TRACE_MSG = 1 << 1,
 	LIST_OUTDUCTS    = 1 << 2,
+	BENCHMARK        = 1 << 3,
 } flags = OUTPUT_JSON | OUTPUT_TRACE_MSG;
 
 static uvast destNode;
@@ -82,6 +83,7 @@ static int minLatency = 0;
 static FILE *outputFile = NULL;
 static char *outductProto = "udp";
 static char *outductName = "*";
+static unsigned int benchmarkCount = 0;
 
 // Chosen outduct
 static PsmAddress vductElt;
@@ -556,6 +558,65 @@ static void output_json(Lyst routes, time_t dispatchTime,
 	fclose(outputFile);
 }
 
+static unsigned long elapsedUsec(struct timeval *start, struct timeval *end)
+{
+	return ((end->tv_sec - start->tv_sec) * 1000000)
+		+ (end->tv_usec - start->tv_usec);
+}
+
+// Repeat the route computation, from scratch and without tracing, and
+// report its cost along with the size of the contact plan.
+static void run_benchmark(Bundle *bundle, time_t dispatchTime,
+		          unsigned int routeCount)
+{
+	PsmPartition ionwm = getIonwm();
+	IonVdb *ionvdb = getIonVdb();
+	struct timeval start;
+	struct timeval end;
+	unsigned long usec;
+	unsigned long totalUsec = 0;
+	unsigned long minUsec = (unsigned long) -1;
+	unsigned long maxUsec = 0;
+	unsigned int i;
+
+	for (i = 0; i < benchmarkCount; i++)
+	{
+		// Discard the routes computed by the previous run.
+		cgr_clear_vdb(cgr_get_vdb());
+
+		getCurrentTime(&start);
+
+		if (cgr_preview_forward(destNode, bundle, dispatchTime, NULL,
+				NULL) < 0)
+		{
+			DIES("unable to simulate cgr");
+		}
+
+		getCurrentTime(&end);
+		usec = elapsedUsec(&start, &end);
+		totalUsec += usec;
+
+		if (usec < minUsec)
+		{
+			minUsec = usec;
+		}
+
+		if (usec > maxUsec)
+		{
+			maxUsec = usec;
+		}
+	}
+
+	fprintf(outputFile,
+		"contacts %lu nodes %lu routes %u runs %u "
+		"mean_usec %lu min_usec %lu max_usec %lu\n",
+		(unsigned long) sm_rbt_length(ionwm, ionvdb->contactIndex),
+		(unsigned long) sm_rbt_length(ionwm, ionvdb->nodes),
+		routeCount, benchmarkCount, totalUsec / benchmarkCount,
+		minUsec, maxUsec);
+	fflush(outputFile);
+}
+
 static void run_cgrfetch(void)
 {
 	uvast localNode;
@@ -633,6 +694,11 @@ static void run_cgrfetch(void)
 		DIES("unable to simulate cgr");
 	}
 
+	if (flags & BENCHMARK)
+	{
+		run_benchmark(&bundle, dispatchTime, lyst_length(routes));
+	}
+
 	sdr_exit_xn(sdr);
 	ionDetach();
 
@@ -686,7 +752,7 @@ static void usage(const char *name)
 	fprintf(stderr,
 		"Usage: %s [-q] [-j] [-m] [-t DISPATCH-OFFSET]\n"
 		"       [-e EXPIRATION-OFFSET] [-s BUNDLE-SIZE]\n"
-		"       [-o OUTPUT-FILE] [-d PROTO:NAME] DEST-NODE\n"
+		"       [-o OUTPUT-FILE] [-d PROTO:NAME] [-b COUNT] DEST-NODE\n"
 		"\n"
 		"In the first case, run a CGR simulation from the local node to\n"
 		"DEST-NODE. Output trace messages to stderr (unless -q) and JSON\n"
@@ -708,6 +774,9 @@ static void usage(const char *name)
 		"  -d PROTO:NAME         use the outduct with protocol PROTO and\n"
 		"                        name NAME (default: %s:%s)\n"
 		"                        list available outducts with -d list\n"
+		"  -b COUNT              compute the routes COUNT times without\n"
+		"                        tracing and print the computation time\n"
+		"                        and contact plan size instead of JSON\n"
 		,
 		name,
 		(unsigned int)(dispatchOffset),
@@ -786,13 +855,26 @@ int	main(int argc, char **argv)
 			DIEF("invalid outduct '%s'", a8);
 		}
 	}
+
+	if (a9)
+	{
+		benchmarkCount = strtoul((char *)(a9), &end, 10);
+
+		if (end == (char *)(a9) || benchmarkCount == 0)
+		{
+			DIES("invalid benchmark count");
+		}
+
+		flags |= BENCHMARK;
+		flags &= ~(OUTPUT_JSON | OUTPUT_TRACE_MSG);
+	}
 #else
 	int opt;
 	char **args;
 
 	opterr = 0;
 
-	while ((opt = getopt(argc, argv, ":hqjt:e:s:mo:d:")) >= 0)
+	while ((opt = getopt(argc, argv, ":hqjt:e:s:mo:d:b:")) >= 0)
 	{
 		switch (opt)
 		{
@@ -867,6 +949,18 @@ int	main(int argc, char **argv)
 
 			break;
 
+		case 'b':
+			benchmarkCount = strtoul(optarg, &end, 10);
+
+			if (end == optarg || benchmarkCount == 0)
+			{
+				DIEF("invalid benchmark count '%s'", optarg);
+			}
+
+			flags |= BENCHMARK;
+			flags &= ~(OUTPUT_JSON | OUTPUT_TRACE_MSG);
+			break;
+
 		case ':':
 			DIEF("option '-%c' takes an argument", optopt);
 			break;
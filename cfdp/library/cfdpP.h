@@ -11,6 +11,7 @@
 
 #include "lyst.h"
 #include "zco.h"
+#include "sdrhash.h"
 #include "crc.h"
 #include "cfdp.h"
 
@@ -23,6 +24,23 @@ extern "C" {
 
 #define	CFDP_MAX_PDU_SIZE	65535
 
+/*	FDU hash tables are keyed by the right-justified transaction
+ *	number buffer of the transaction ID.				*/
+
+#define	CFDP_FDU_HASH_KEY_LEN	(8)
+#ifndef CFDP_EST_MAX_FDUS
+#define	CFDP_EST_MAX_FDUS	(1000)
+#endif
+#ifndef CFDP_MEAN_SEARCH_LENGTH
+#define	CFDP_MEAN_SEARCH_LENGTH	(4)
+#endif
+
+/*	Maximum number of inbound FDU working files held open at once.	*/
+
+#ifndef CFDP_MAX_OPEN_FILES
+#define	CFDP_MAX_OPEN_FILES	(8)
+#endif
+
 typedef struct
 {
 	Object		text;
@@ -205,6 +223,7 @@ typedef struct
 	CfdpCksumType		inCkType;
 	CfdpCksumType		outCkType;
 	Object			inboundFdus;	/*	sdrlist: InFdu	*/
+	Object			inboundFdusHash;/*	-> FDU list elt	*/
 } Entity;
 
 typedef struct
@@ -257,6 +276,7 @@ typedef struct
 	Object		fsreqLists;	/*	SDR list: MetadataList	*/
 	Object		fsrespLists;	/*	SDR list: MetadataList	*/
 	Object		outboundFdus;	/*	SDR list: OutFdu	*/
+	Object		outboundFdusHash;	/*	-> FDU list elt	*/
 	Object		events;		/*	SDR list: CfdpEvent	*/
 	Object		entities;	/*	SDR list: Entity	*/
 	Object		finishPdus;	/*	SDR list: FinishPdu	*/
@@ -289,12 +309,17 @@ typedef struct
 
 	sm_SemId	fduSemaphore;
 
-	/*	currentFdu identifies the FDU that is currently being
-	 *	reassembled, if any.  currentFile is the FD that is
-	 *	being used to reassemble that FDU.			*/
+	/*	openFdus identifies the FDUs whose working files are
+	 *	currently held open, so that file data PDUs of
+	 *	interleaved transactions can be written without
+	 *	reopening the files.  The file descriptors themselves
+	 *	are private to the process that writes the files,
+	 *	in a table parallel to this one; any process may
+	 *	close an FDU's file by clearing its entry here, and
+	 *	the writing process closes the corresponding file
+	 *	descriptor the next time it opens a working file.	*/
 
-	Object		currentFdu;
-	int		currentFile;
+	Object		openFdus[CFDP_MAX_OPEN_FILES];
 
 	/*	The "attendant" of the CFDP entity is a coordination
 	 *	object used in flow control of ZCO space allocation.
@@ -351,10 +376,8 @@ extern int		checkFile(char *);
 extern int		ckTypeOkay(unsigned int ckType);
 extern void		addToChecksum(unsigned char octet, vast *offset,
 				unsigned int *checksum, CfdpCksumType ckType);
-#ifdef ENABLE_HIGH_SPEED
 extern void		addDataToChecksum(unsigned char *data, int dLen, vast *offset,
 				unsigned int *checksum, CfdpCksumType ckType);
-#endif
 extern int		getReqNbr();	/*	Returns next req nbr.	*/
 
 extern MetadataList	createMetadataList(Object log);
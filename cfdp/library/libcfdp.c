@@ -138,6 +138,12 @@ void	cfdp_update_checksum(unsigned char octet, vast *offset,
 }
 #endif
 
+void	cfdp_update_checksum_block(unsigned char *data, int length,
+		vast *offset, unsigned int *checksum, CfdpCksumType ckType)
+{
+	addDataToChecksum(data, length, offset, checksum, ckType);
+}
+
 static int	defaultReader(int fd, unsigned int *checksum,
 			CfdpCksumType ckType)
 {
@@ -145,10 +151,6 @@ static int	defaultReader(int fd, unsigned int *checksum,
 	CfdpDB		*cfdpConstants = getCfdpConstants();
 	vast		offset;
 	int		length;
-#ifndef ENABLE_HIGH_SPEED
-	int		i;
-	char		*octet;
-#endif
 
 	offset = ilseek(fd, 0, SEEK_CUR);
 	if (offset < 0)
@@ -164,15 +166,8 @@ static int	defaultReader(int fd, unsigned int *checksum,
 		return -1;
 	}
 
-#ifdef ENABLE_HIGH_SPEED
-	addDataToChecksum((unsigned char *) defaultReaderBuf, length, &offset, checksum, ckType);
-#else
-	for (i = 0, octet = defaultReaderBuf; i < length; i++, octet++)
-	{
-		addToChecksum((unsigned char) *octet, &offset, checksum,
-				ckType);
-	}
-#endif
+	addDataToChecksum((unsigned char *) defaultReaderBuf, length, &offset,
+			checksum, ckType);
 
 	return length;
 }
@@ -184,9 +179,6 @@ int	cfdp_read_space_packets(int fd, unsigned int *checksum,
 	CfdpDB		*cfdpConstants = getCfdpConstants();
 	vast		offset;
 	int		length;
-#ifndef ENABLE_HIGH_SPEED
-	int		i;
-#endif
 	char		*octet;
 	unsigned int	recordLen;
 	unsigned short	pktlen;
@@ -262,15 +254,8 @@ int	cfdp_read_space_packets(int fd, unsigned int *checksum,
 
 	/*	Add record to checksum.					*/
 
-#ifdef ENABLE_HIGH_SPEED
-	addDataToChecksum((unsigned char *) pktReaderBuf, length, &offset, checksum, ckType);
-#else
-	for (i = 0, octet = pktReaderBuf; i < length; i++, octet++)
-	{
-		addToChecksum((unsigned char) *octet, &offset, checksum,
-				ckType);
-	}
-#endif
+	addDataToChecksum((unsigned char *) pktReaderBuf, length, &offset,
+			checksum, ckType);
 
 	return length;
 }
@@ -332,15 +317,8 @@ int	cfdp_read_text_lines(int fd, unsigned int *checksum,
 
 	/*	Add record to checksum.					*/
 
-#ifdef ENABLE_HIGH_SPEED
-	addDataToChecksum((unsigned char *) textReaderBuf, length, &offset, checksum, ckType);
-#else
-	for (i = 0, octet = textReaderBuf; i < length; i++, octet++)
-	{
-		addToChecksum((unsigned char) *octet, &offset, checksum,
-				ckType);
-	}
-#endif
+	addDataToChecksum((unsigned char *) textReaderBuf, length, &offset,
+			checksum, ckType);
 
 	return length;
 }
@@ -1152,6 +1130,7 @@ int	createFDU(CfdpNumber *destinationEntityNbr, unsigned int utParmsLength,
 	int		lengthRemaining;
 	char		metadataBuffer[255];
 	Object		fduObj;
+	Object		fduElt;
 	CfdpEvent	event;
 	int		metadataFnRet;
 
@@ -1585,7 +1564,16 @@ too long.", sourceFileName);
 	}
 
 	sdr_write(sdr, fduObj, (char *) &fdu, sizeof(OutFdu));
-	sdr_list_insert_last(sdr, db.outboundFdus, fduObj);
+	fduElt = sdr_list_insert_last(sdr, db.outboundFdus, fduObj);
+	if (fduElt == 0 || sdr_hash_insert(sdr, db.outboundFdusHash,
+			(char *) fdu.transactionId.transactionNbr.buffer,
+			fduElt, NULL) < 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("Can't index CFDP outbound FDU.", sourceFileName);
+		return -1;
+	}
+
 	if (messagesToUser)
 	{
 		destroyUsrmsgList(&messagesToUser);
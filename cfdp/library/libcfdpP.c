@@ -234,37 +234,195 @@ static void	addToModularChecksum(unsigned char octet, vast *offset,
 	(*offset)++;
 }
 
-#ifdef ENABLE_HIGH_SPEED
+/*	Once the file offset is on a 4-byte boundary, the modular
+ *	checksum is simply the sum, modulo 2^32, of the big-endian
+ *	32-bit words of the data.  On x86-64 the words are summed
+ *	32 or 16 bytes at a time by AVX2 or SSSE3 instructions when
+ *	the processor supports them (detected at run time); define
+ *	NO_CFDP_CKSUM_HW_ACCEL to sum one word at a time everywhere.	*/
+
+#if !defined(NO_CFDP_CKSUM_HW_ACCEL) && defined(__x86_64__) \
+	&& (defined(__clang__) || __GNUC__ > 4 \
+	|| (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define	CFDP_CKSUM_HW_ACCEL
+#endif
+
+#ifdef CFDP_CKSUM_HW_ACCEL
+#include <immintrin.h>
+
+#define	CKSUM_SSSE3	(1)
+#define	CKSUM_AVX2	(2)
+
+/*	Detection is idempotent, so concurrent first calls are
+ *	harmless.							*/
+
+static int	cksumHwFeatures()
+{
+	static int	features = -1;
+
+	if (features < 0)
+	{
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{
+			features = CKSUM_AVX2;
+		}
+		else if (__builtin_cpu_supports("ssse3"))
+		{
+			features = CKSUM_SSSE3;
+		}
+		else
+		{
+			features = 0;
+		}
+	}
+
+	return features;
+}
+
+__attribute__((target("avx2")))
+static unsigned int	sumBlocksAvx2(unsigned char *data, int blocks)
+{
+	__m256i		swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+				11, 10, 9, 8, 15, 14, 13, 12,
+				3, 2, 1, 0, 7, 6, 5, 4,
+				11, 10, 9, 8, 15, 14, 13, 12);
+	__m256i		acc = _mm256_setzero_si256();
+	__m128i		sum;
+
+	while (blocks > 0)	/*	32 bytes per block.		*/
+	{
+		acc = _mm256_add_epi32(acc, _mm256_shuffle_epi8(
+				_mm256_loadu_si256((__m256i *) data), swap));
+		data += 32;
+		blocks--;
+	}
+
+	sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+			_mm256_extracti128_si256(acc, 1));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+	return (unsigned int) _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("ssse3")))
+static unsigned int	sumBlocksSsse3(unsigned char *data, int blocks)
+{
+	__m128i		swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+				11, 10, 9, 8, 15, 14, 13, 12);
+	__m128i		acc = _mm_setzero_si128();
+
+	while (blocks > 0)	/*	16 bytes per block.		*/
+	{
+		acc = _mm_add_epi32(acc, _mm_shuffle_epi8(
+				_mm_loadu_si128((__m128i *) data), swap));
+		data += 16;
+		blocks--;
+	}
+
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+	return (unsigned int) _mm_cvtsi128_si32(acc);
+}
+#endif
+
+static unsigned int	sumWords(unsigned char *data, int words)
+{
+	unsigned int	sum = 0;
+#ifdef CFDP_CKSUM_HW_ACCEL
+	int		blocks;
+
+	switch (cksumHwFeatures())
+	{
+	case CKSUM_AVX2:
+		blocks = words >> 3;
+		sum = sumBlocksAvx2(data, blocks);
+		data += blocks << 5;
+		words -= blocks << 3;
+		break;
+
+	case CKSUM_SSSE3:
+		blocks = words >> 2;
+		sum = sumBlocksSsse3(data, blocks);
+		data += blocks << 4;
+		words -= blocks << 2;
+		break;
+
+	default:
+		break;
+	}
+#endif
+	while (words > 0)
+	{
+		sum += (((unsigned int) data[0]) << 24)
+			+ (((unsigned int) data[1]) << 16)
+			+ (((unsigned int) data[2]) << 8)
+			+ data[3];
+		data += 4;
+		words--;
+	}
+
+	return sum;
+}
+
+static void	addDataToModularChecksum(unsigned char *data, int dLen,
+			vast *offset, unsigned int *checksum)
+{
+	int	words;
+
+	/*	Octets up to the next 4-byte boundary in the file.	*/
+
+	while (dLen > 0 && (*offset & 0x03) != 0)
+	{
+		addToModularChecksum(*data, offset, checksum);
+		data++;
+		dLen--;
+	}
+
+	words = dLen >> 2;
+	*checksum += sumWords(data, words);
+	*offset += words << 2;
+	data += words << 2;
+	dLen -= words << 2;
+
+	/*	Octets of the final, partial word.			*/
+
+	while (dLen > 0)
+	{
+		addToModularChecksum(*data, offset, checksum);
+		data++;
+		dLen--;
+	}
+}
+
 void	addDataToChecksum(unsigned char *data, int dLen, vast *offset,
 		unsigned int *checksum, CfdpCksumType ckType)
 {
-	unsigned char *octet;
-	int bytesToWrite;
-	
 	CHKVOID(checksum);
 	switch (ckType)
 	{
 	case ModularChecksum:
 		CHKVOID(offset);
-		octet = data;
-		bytesToWrite = dLen;
-		while (bytesToWrite > 0)
-		{
-			addToModularChecksum(*octet, offset, checksum);
-			octet++;
-			bytesToWrite--;
-		}
+		CHKVOID(data || dLen == 0);
+		addDataToModularChecksum(data, dLen, offset, checksum);
 		break;
 
 	case CRC32CChecksum:
+#ifdef ENABLE_HIGH_SPEED
 		*checksum = ion_CRC32_1EDC6F41_C_slice((char *) data,
 				dLen, *checksum);
+#else
+		*checksum = ion_CRC32_1EDC6F41_C((char *) data, dLen,
+				*checksum);
+#endif
 		break;
 	
+#ifdef ENABLE_HIGH_SPEED
 	case CRC32Checksum:
 		*checksum = ion_CRC32_04C11DB7_slice((char *) data,
 				dLen, *checksum);
 		break;
+#endif
 
 	case NullChecksum:
 		*checksum = 0;
@@ -276,7 +434,6 @@ void	addDataToChecksum(unsigned char *data, int dLen, vast *offset,
 
 	return;
 }
-#endif
 
 #ifndef ENABLE_HIGH_SPEED
 void	addToChecksum(unsigned char octet, vast *offset,
@@ -372,6 +529,134 @@ static char	*_cfdpvdbName()
 	return "cfdpvdb";
 }
 
+/*	*	Inbound FDU working file management	*	*	*/
+
+typedef struct
+{
+	Object		fdu;		/*	0 if entry is unused.	*/
+	int		fd;
+	unsigned long	lastUse;	/*	For LRU eviction.	*/
+} CfdpOpenFile;
+
+static CfdpOpenFile	*_openFiles()
+{
+	static CfdpOpenFile	openFiles[CFDP_MAX_OPEN_FILES];
+
+	/*	Working file descriptors are meaningful only within
+	 *	the process that opened them, so they are retained
+	 *	here rather than in the volatile database.		*/
+
+	return openFiles;
+}
+
+static void	closeStaleFiles(CfdpVdb *vdb)
+{
+	CfdpOpenFile	*file;
+	int		i;
+
+	for (i = 0, file = _openFiles(); i < CFDP_MAX_OPEN_FILES;
+			i++, file++)
+	{
+		if (file->fdu && vdb->openFdus[i] != file->fdu)
+		{
+			close(file->fd);
+			file->fdu = 0;
+		}
+	}
+}
+
+static void	closeFduFile(CfdpVdb *vdb, Object fduObj)
+{
+	int	i;
+
+	/*	If some other process is writing the FDU's working
+	 *	file, it closes its file descriptor when it next
+	 *	notices that the FDU is no longer listed.		*/
+
+	for (i = 0; i < CFDP_MAX_OPEN_FILES; i++)
+	{
+		if (vdb->openFdus[i] == fduObj)
+		{
+			vdb->openFdus[i] = 0;
+		}
+	}
+
+	closeStaleFiles(vdb);
+}
+
+static void	closeFduFiles(CfdpVdb *vdb)
+{
+	memset((char *) vdb->openFdus, 0, sizeof vdb->openFdus);
+	closeStaleFiles(vdb);
+}
+
+static int	openFduFile(CfdpVdb *vdb, Object fduObj, char *fileName)
+{
+	static unsigned long	fileUseCount = 0;
+	CfdpOpenFile		*files = _openFiles();
+	CfdpOpenFile		*file;
+	CfdpOpenFile		*victim = files;
+	int			i;
+
+	closeStaleFiles(vdb);
+	for (i = 0, file = files; i < CFDP_MAX_OPEN_FILES; i++, file++)
+	{
+		if (file->fdu == fduObj)
+		{
+			file->lastUse = ++fileUseCount;
+			return file->fd;
+		}
+
+		if (victim->fdu && (file->fdu == 0
+				|| file->lastUse < victim->lastUse))
+		{
+			victim = file;
+		}
+	}
+
+	/*	Not open; reuse an empty entry or close the least
+	 *	recently used file.					*/
+
+	i = victim - files;
+	if (victim->fdu)
+	{
+		close(victim->fd);
+		victim->fdu = 0;
+		vdb->openFdus[i] = 0;
+	}
+
+	victim->fd = ifopen(fileName, O_RDWR | O_CREAT, 0777);
+	if (victim->fd < 0)
+	{
+		return -1;
+	}
+
+	victim->fdu = fduObj;
+	victim->lastUse = ++fileUseCount;
+	vdb->openFdus[i] = fduObj;
+	return victim->fd;
+}
+
+static int	writeFduFile(int fd, char *data, int length, vast offset)
+{
+#ifdef unix
+	/*	Positioned write, so that the file data PDUs of an
+	 *	FDU may arrive in any order.				*/
+
+	if (pwrite(fd, data, length, offset) != length)
+	{
+		return -1;
+	}
+#else
+	if (ilseek(fd, offset, SEEK_SET) < 0
+	|| write(fd, data, length) != length)
+	{
+		return -1;
+	}
+#endif
+	return 0;
+}
+
 static CfdpVdb	*_cfdpvdb(char **name)
 {
 	static CfdpVdb	*vdb = NULL;
@@ -434,7 +719,6 @@ static CfdpVdb	*_cfdpvdb(char **name)
 
 		sm_SemTake(vdb->eventSemaphore);/*	Lock.		*/
 		sm_SemTake(vdb->fduSemaphore);	/*	Lock.		*/
-		vdb->currentFile = -1;		/*	Nothing open.	*/
 		corruptionModulusString = getenv("CFDP_CORRUPTION_MODULUS");
 		if (corruptionModulusString)
 		{
@@ -526,6 +810,9 @@ int	cfdpInit()
 		cfdpdbBuf.fsreqLists = sdr_list_create(sdr);
 		cfdpdbBuf.fsrespLists = sdr_list_create(sdr);
 		cfdpdbBuf.outboundFdus = sdr_list_create(sdr);
+		cfdpdbBuf.outboundFdusHash = sdr_hash_create(sdr,
+				CFDP_FDU_HASH_KEY_LEN, CFDP_EST_MAX_FDUS,
+				CFDP_MEAN_SEARCH_LENGTH);
 		cfdpdbBuf.events = sdr_list_create(sdr);
 		cfdpdbBuf.entities = sdr_list_create(sdr);
 		cfdpdbBuf.finishPdus = sdr_list_create(sdr);
@@ -578,10 +865,7 @@ static void	dropVdb(PsmPartition wm, PsmAddress vdbAddress)
 		sm_SemDelete(vdb->fduSemaphore);
 	}
 
-	if (vdb->currentFile != -1)
-	{
-		close(vdb->currentFile);
-	}
+	closeFduFiles(vdb);
 }
 
 void	cfdpDropVdb()
@@ -768,13 +1052,7 @@ void	_cfdpStop()		/*	Reverses cfdpStart.		*/
 	}
 
 	sm_SemTake(cfdpvdb->fduSemaphore);		/*	Lock.	*/
-	if (cfdpvdb->currentFile != -1)
-	{
-		close(cfdpvdb->currentFile);
-		cfdpvdb->currentFile = -1;
-	}
-
-	cfdpvdb->currentFdu = 0;
+	closeFduFiles(cfdpvdb);
 	sdr_exit_xn(sdr);	/*	Unlock memory.			*/
 }
 
@@ -1198,8 +1476,11 @@ Object	addEntity(uvast entityId, char *protocolName, char *endpointName,
 	entity.inCkType = inCkType;
 	entity.outCkType = outCkType;
 	entity.inboundFdus = sdr_list_create(sdr);
+	entity.inboundFdusHash = sdr_hash_create(sdr, CFDP_FDU_HASH_KEY_LEN,
+			CFDP_EST_MAX_FDUS, CFDP_MEAN_SEARCH_LENGTH);
 	entityObj = sdr_malloc(sdr, sizeof(Entity));
-	if (entity.inboundFdus == 0 || entityObj == 0
+	if (entity.inboundFdus == 0 || entity.inboundFdusHash == 0
+	|| entityObj == 0
 	|| (nextElt == 0	?
 		sdr_list_insert_last(sdr, db->entities, entityObj)
 		: 
@@ -1305,6 +1586,7 @@ int	removeEntity(uvast entityId)
 	}
 
 	sdr_list_destroy(sdr, entity.inboundFdus, NULL, NULL);
+	sdr_hash_destroy(sdr, entity.inboundFdusHash);
 	sdr_free(sdr, entityObj);
 	sdr_list_delete(sdr, elt, NULL, NULL);
 	return 0;
@@ -1324,20 +1606,17 @@ Object	findOutFdu(CfdpTransactionId *transactionId, OutFdu *fduBuf,
 	CHKZERO(fduBuf);
 	CHKZERO(fduElt);
 	*fduElt = 0;			/*	Default.		*/
-	for (elt = sdr_list_first(sdr, cfdpConstants->outboundFdus); elt;
-			elt = sdr_list_next(sdr, elt))
+	if (sdr_hash_retrieve(sdr, cfdpConstants->outboundFdusHash,
+			(char *) transactionId->transactionNbr.buffer,
+			(Address *) &elt, NULL) != 1)
 	{
-		fduObj = sdr_list_data(sdr, elt);
-		sdr_read(sdr, (char *) fduBuf, fduObj, sizeof(OutFdu));
-		if (memcmp(fduBuf->transactionId.transactionNbr.buffer,
-				transactionId->transactionNbr.buffer, 8) == 0)
-		{
-			*fduElt = elt;
-			return fduObj;
-		}
+		return 0;
 	}
 
-	return 0;
+	fduObj = sdr_list_data(sdr, elt);
+	sdr_read(sdr, (char *) fduBuf, fduObj, sizeof(OutFdu));
+	*fduElt = elt;
+	return fduObj;
 }
 
 static Object	createInFdu(CfdpTransactionId *transactionId, Entity *entity,
@@ -1359,7 +1638,10 @@ static Object	createInFdu(CfdpTransactionId *transactionId, Entity *entity,
 	if (fduObj == 0 || fdubuf->messagesToUser == 0
 	|| fdubuf->filestoreRequests == 0 || fdubuf->extents == 0
 	|| (*fduElt = sdr_list_insert_last(sdr, entity->inboundFdus,
-			fduObj)) == 0)
+			fduObj)) == 0
+	|| sdr_hash_insert(sdr, entity->inboundFdusHash,
+			(char *) transactionId->transactionNbr.buffer,
+			*fduElt, NULL) < 0)
 	{
 		return 0;		/*	System failure.		*/
 	}
@@ -1379,7 +1661,6 @@ Object	findInFdu(CfdpTransactionId *transactionId, InFdu *fduBuf,
 	Object	elt;
 	Object	entityObj;
 	Entity	entity;
-	int	foundIt;
 	Object	fduObj;
 
 	CHKZERO(transactionId);
@@ -1392,24 +1673,15 @@ Object	findInFdu(CfdpTransactionId *transactionId, InFdu *fduBuf,
 	{
 		entityObj = sdr_list_data(sdr, elt);
 		sdr_read(sdr, (char *) &entity, entityObj, sizeof(Entity));
-		foundIt = 0;
-		for (elt = sdr_list_first(sdr, entity.inboundFdus); elt;
-				elt = sdr_list_next(sdr, elt))
+		if (sdr_hash_retrieve(sdr, entity.inboundFdusHash,
+				(char *) transactionId->transactionNbr.buffer,
+				(Address *) &elt, NULL) == 1)
 		{
+			/*	FDU is already started.			*/
+
 			fduObj = sdr_list_data(sdr, elt);
 			sdr_read(sdr, (char *) fduBuf, fduObj,
 					sizeof(InFdu));
-			if (memcmp((char *) &fduBuf->transactionId,
-					(char *) transactionId,
-					sizeof(CfdpTransactionId)) == 0)
-			{
-				foundIt = 1;
-				break;
-			}
-		}
-	
-		if (foundIt)	/*	FDU is already started.		*/
-		{
 			*fduElt = elt;
 			return fduObj;
 		}
@@ -1582,6 +1854,9 @@ void	destroyOutFdu(OutFdu *fdu, Object fduObj, Object fduElt)
 
 	sdr_free(sdr, fduObj);
 	sdr_list_delete(sdr, fduElt, NULL, NULL);
+	oK(sdr_hash_remove(sdr, (_cfdpConstants())->outboundFdusHash,
+			(char *) fdu->transactionId.transactionNbr.buffer,
+			NULL));
 }
 
 static int	abandonOutFdu(CfdpTransactionId *transactionId,
@@ -1621,6 +1896,8 @@ void	destroyInFdu(InFdu *fdu, Object fduObj, Object fduElt)
 {
 	Sdr	sdr = getIonsdr();
 	CfdpVdb	*cfdpvdb = _cfdpvdb(NULL);
+	uvast	sourceEntityId;
+	Entity	entity;
 	Object	elt;
 	Object	obj;
 		OBJ_POINTER(MsgToUser, msg);
@@ -1715,16 +1992,16 @@ void	destroyInFdu(InFdu *fdu, Object fduObj, Object fduElt)
 
 	sdr_free(sdr, fduObj);
 	sdr_list_delete(sdr, fduElt, NULL, NULL);
-	if (cfdpvdb->currentFdu == fduObj)
+	cfdp_decompress_number(&sourceEntityId,
+			&fdu->transactionId.sourceEntityNbr);
+	if (findEntity(sourceEntityId, &entity))
 	{
-		if (cfdpvdb->currentFile != -1)
-		{
-			close(cfdpvdb->currentFile);
-			cfdpvdb->currentFile = -1;
-		}
-
-		cfdpvdb->currentFdu = 0;
+		oK(sdr_hash_remove(sdr, entity.inboundFdusHash,
+				(char *) fdu->transactionId.transactionNbr.buffer,
+				NULL));
 	}
+
+	closeFduFile(cfdpvdb, fduObj);
 }
 
 static int	abandonInFdu(CfdpTransactionId *transactionId,
@@ -3763,13 +4040,14 @@ static int	handleFilestoreRejection(InFdu *fdu, int returnCode,
 	return returnCode;
 }
 
-static int	writeSegmentData(InFdu *fdu, unsigned char **cursor,
+static int	writeSegmentData(InFdu *fdu, int fd, unsigned char **cursor,
 			int *bytesRemaining, vast *segmentOffset,
 			int bytesToWrite)
 {
 	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
 	CfdpHandler	handler;
 	int		remainder;
+	vast		checksumOffset;
 
 	if (cfdpvdb->corruptionModulus)
 	{
@@ -3781,7 +4059,8 @@ static int	writeSegmentData(InFdu *fdu, unsigned char **cursor,
 		}
 	}
 
-	if (write(cfdpvdb->currentFile, *cursor, bytesToWrite) < 0)
+	if (writeFduFile(fd, (char *) *cursor, bytesToWrite, *segmentOffset)
+			< 0)
 	{
 		putSysErrmsg("Can't write to file", itoa(bytesToWrite));
 		return handleFilestoreRejection(fdu, -1, &handler);
@@ -3789,21 +4068,15 @@ static int	writeSegmentData(InFdu *fdu, unsigned char **cursor,
 
 	fdu->bytesReceived += bytesToWrite;
 
-#ifdef ENABLE_HIGH_SPEED
-	addDataToChecksum(*cursor, bytesToWrite, segmentOffset,
+	/*	Only the modular checksum advances the offset passed
+	 *	to it, so track the segment offset separately.		*/
+
+	checksumOffset = *segmentOffset;
+	addDataToChecksum(*cursor, bytesToWrite, &checksumOffset,
 			&fdu->computedChecksum, fdu->ckType);
+	(*segmentOffset) += bytesToWrite;
 	(*cursor) += bytesToWrite;
 	(*bytesRemaining) -= bytesToWrite;
-#else
-	while (bytesToWrite > 0)
-	{
-		addToChecksum(**cursor, segmentOffset, &fdu->computedChecksum,
-				fdu->ckType);
-		(*cursor)++;
-		(*bytesRemaining)--;
-		bytesToWrite--;
-	}
-#endif
 	return 0;
 }
 
@@ -3830,6 +4103,7 @@ static int	handleFileDataPdu(unsigned char *cursor, int bytesRemaining,
 	char		stringBuf[256];
 	char		workingNameBuffer[MAXPATHLEN + 1];
 	vast		endOfFile;
+	int		fd;
 	uvast		fileLength;
 	uvast		fillBufSize;
 	uvast		bufSizeLimit;
@@ -4030,30 +4304,16 @@ extent.offset, extent.offset + extent.length);
 
 	/*	Now open the file, creating it if necessary.		*/
 
-	if (cfdpvdb->currentFdu != fduObj)	/*	Switching FDU.	*/
+	fd = openFduFile(cfdpvdb, fduObj, workingNameBuffer);
+	if (fd < 0)
 	{
-		if (cfdpvdb->currentFile != -1)
-		{
-			close(cfdpvdb->currentFile);
-			cfdpvdb->currentFile = -1;
-		}
-
-		cfdpvdb->currentFdu = 0;
-		cfdpvdb->currentFile = ifopen(workingNameBuffer,
-				O_RDWR | O_CREAT, 0777);
-		if (cfdpvdb->currentFile < 0)
-		{
-			putSysErrmsg("Can't open working file",
-					workingNameBuffer);
-			return handleFilestoreRejection(fdu, 0, &handler);
-		}
-
-		cfdpvdb->currentFdu = fduObj;
+		putSysErrmsg("Can't open working file", workingNameBuffer);
+		return handleFilestoreRejection(fdu, 0, &handler);
 	}
 
 	/*	Write leading fill characters as necessary.		*/
 
-	endOfFile = ilseek(cfdpvdb->currentFile, 0, SEEK_END);
+	endOfFile = ilseek(fd, 0, SEEK_END);
 	if (endOfFile < 0)
 	{
 		putSysErrmsg("Can't lseek in file", workingNameBuffer);
@@ -4110,7 +4370,8 @@ extent.offset, extent.offset + extent.length);
 				fillSize = fillBufSize;
 			}
 
-			if (write(cfdpvdb->currentFile, fillBuf, fillSize) < 0)
+			if (writeFduFile(fd, fillBuf, fillSize, fileLength)
+					< 0)
 			{
 				putSysErrmsg("Can't write to file",
 						workingNameBuffer);
@@ -4125,14 +4386,6 @@ extent.offset, extent.offset + extent.length);
 		MRELEASE(fillBuf);
 	}
 
-	/*	Reposition at offset of new file data bytes.		*/
-
-	if (ilseek(cfdpvdb->currentFile, segmentOffset, SEEK_SET) < 0)
-	{
-		putSysErrmsg("Can't lseek in file", workingNameBuffer);
-		return handleFilestoreRejection(fdu, -1, &handler);
-	}
-
 	/*	Now write new file data, updating checksum in the
 	 *	process.  While doing this, collapse subsequent
 	 *	extents into the current one until an unbridged gap
@@ -4158,7 +4411,7 @@ nextExtent.offset + nextExtent.length, segmentOffset);
 		 *	First, bridge gap to the start of this extent.	*/
 
 		bytesToWrite = nextExtent.offset - segmentOffset;
-		if (writeSegmentData(fdu, &cursor, &bytesRemaining,
+		if (writeSegmentData(fdu, fd, &cursor, &bytesRemaining,
 				&segmentOffset, bytesToWrite) < 0)
 		{
 			putErrmsg("Can't write segment data.",
@@ -4198,7 +4451,7 @@ nextExtent.offset + nextExtent.length, segmentOffset);
 	if (segmentEnd > segmentOffset)
 	{
 		bytesToWrite = segmentEnd - segmentOffset;
-		if (writeSegmentData(fdu, &cursor, &bytesRemaining,
+		if (writeSegmentData(fdu, fd, &cursor, &bytesRemaining,
 				&segmentOffset, bytesToWrite) < 0)
 		{
 			putErrmsg("Can't write segment data.",
@@ -4208,9 +4461,7 @@ nextExtent.offset + nextExtent.length, segmentOffset);
 	}
 
 #ifdef TargetFFS
-	close(cfdpvdb->currentFile);
-	cfdpvdb->currentFile = -1;
-	cfdpvdb->currentFdu = 0;
+	closeFduFile(cfdpvdb, fduObj);
 #endif
 	/*	Deliver File-Segment-Recv indication.			*/
 
@@ -0,0 +1,664 @@
+/*
+	bulk.c:	implementation of "bulk" data I/O functions that keeps
+		all bulk items in a single block-structured store file.
+
+		The store file ("ionbulk.store" in the ION working
+		directory) is divided into fixed-size blocks.  Each
+		item occupies a sequence of blocks, mapped from the
+		item's offsets by a block map that, together with the
+		item's length, is retained in the ION SDR heap and
+		indexed by item number in an SDR hash table.  So the
+		bulk item index is shared by all ION tasks and is
+		subject to ION's transaction mechanism.
+
+		New blocks are appended to the end of the store file,
+		which is preallocated BULK_GROWTH_BLOCKS blocks at a
+		time, so the blocks of each item are normally
+		contiguous and are read and written in large runs.
+		The blocks of destroyed items are recycled before the
+		store file is extended.  Each task holds a single
+		descriptor for the store file open and reads and
+		writes it with positioned I/O.
+
+	Author:	ION development team, JPL; derived from the STUB_BULK
+		implementation by Scott Burleigh, JPL.
+
+	Copyright (c) 2026, California Institute of Technology.
+	ALL RIGHTS RESERVED.  U.S. Government Sponsorship
+	acknowledged.
+									*/
+#include "platform.h"
+#include "ion.h"
+#include "sdrhash.h"
+#include "bulk.h"
+
+#ifndef BULK_BLOCK_SIZE
+#define	BULK_BLOCK_SIZE		(16384)
+#endif
+
+#ifndef BULK_GROWTH_BLOCKS
+#define	BULK_GROWTH_BLOCKS	(1024)
+#endif
+
+#define	BULK_EST_ITEMS		(1000)
+#define	BULK_MEAN_SEARCH_LENGTH	(4)
+#define	BULK_MAP_CHUNK		(256)
+#define	BULK_DB_NAME		"bulkdb"
+#define	BULK_STORE_NAME		"ionbulk.store"
+
+typedef struct
+{
+	unsigned long	storeBlocks;	/*	Blocks in store file.	*/
+	unsigned long	nextBlock;	/*	First never-used block.	*/
+	Object		freeBlocks;	/*	SDR list: block nbrs.	*/
+	Object		items;		/*	SDR hash: BulkItem.	*/
+} BulkDB;
+
+typedef struct
+{
+	unsigned long	item;
+	vast		length;		/*	End of data written.	*/
+	unsigned long	blockCount;	/*	Blocks allocated.	*/
+	unsigned long	mapSize;	/*	Capacity of block map.	*/
+	Object		blockMap;	/*	Array of block nbrs.	*/
+} BulkItem;
+
+static int	_storeFd(int newFd)
+{
+	static int	fd = -1;
+
+	if (newFd != 0)
+	{
+		fd = newFd;
+	}
+
+	return fd;
+}
+
+static int	getStoreFd()
+{
+	static pthread_mutex_t	openMutex = PTHREAD_MUTEX_INITIALIZER;
+	char			fileName[MAXPATHLEN];
+	int			fd = _storeFd(0);
+
+	if (fd >= 0)
+	{
+		return fd;
+	}
+
+	/*	Tasks reading bulk items in concurrent shared
+	 *	transactions must not each open the store file.		*/
+
+	pthread_mutex_lock(&openMutex);
+	fd = _storeFd(0);
+	if (fd < 0)
+	{
+		isprintf(fileName, sizeof fileName, "%s%c%s",
+				getIonWorkingDirectory(), ION_PATH_DELIMITER,
+				BULK_STORE_NAME);
+		fd = iopen(fileName, O_RDWR | O_CREAT, 0666);
+		if (fd < 0)
+		{
+			pthread_mutex_unlock(&openMutex);
+			putSysErrmsg("Can't open bulk store file", fileName);
+			return -1;
+		}
+
+		closeOnExec(fd);
+		oK(_storeFd(fd));
+	}
+
+	pthread_mutex_unlock(&openMutex);
+	return fd;
+}
+
+static int	storeIo(int fd, char *buffer, unsigned long block,
+			vast offset, vast length, int writing)
+{
+	vast	position = (((vast) block) * BULK_BLOCK_SIZE) + offset;
+	vast	result;
+
+#ifdef unix
+	if (writing)
+	{
+		result = pwrite(fd, buffer, length, position);
+	}
+	else
+	{
+		result = pread(fd, buffer, length, position);
+	}
+#else
+	if (lseek(fd, position, SEEK_SET) < 0)
+	{
+		return -1;
+	}
+
+	if (writing)
+	{
+		result = write(fd, buffer, length);
+	}
+	else
+	{
+		result = read(fd, buffer, length);
+	}
+#endif
+	return (result == length ? 0 : -1);
+}
+
+/*	The following functions must be called from within an SDR
+ *	transaction.							*/
+
+static Object	findBulkDb(Sdr sdr)
+{
+	static Object	dbObj = 0;
+
+	if (dbObj == 0)
+	{
+		dbObj = sdr_find(sdr, BULK_DB_NAME, NULL);
+	}
+
+	return dbObj;
+}
+
+static Object	getBulkDb(Sdr sdr, BulkDB *db)
+{
+	Object	dbObj;
+	Object	newDbObj;
+	int	fd;
+
+	dbObj = findBulkDb(sdr);
+	if (dbObj)
+	{
+		sdr_stage(sdr, (char *) db, dbObj, sizeof(BulkDB));
+		return dbObj;
+	}
+
+	/*	Must create bulk database.  It is not cached until
+	 *	the creating transaction has ended, as the transaction
+	 *	might yet be canceled.  Any existing content of the
+	 *	store file is stale.					*/
+
+	fd = getStoreFd();
+	if (fd < 0 || ftruncate(fd, 0) < 0)
+	{
+		putSysErrmsg("Can't initialize bulk store file", NULL);
+		return 0;
+	}
+
+	memset((char *) db, 0, sizeof(BulkDB));
+	db->freeBlocks = sdr_list_create(sdr);
+	db->items = sdr_hash_create(sdr, sizeof(unsigned long),
+			BULK_EST_ITEMS, BULK_MEAN_SEARCH_LENGTH);
+	newDbObj = sdr_malloc(sdr, sizeof(BulkDB));
+	if (db->freeBlocks == 0 || db->items == 0 || newDbObj == 0)
+	{
+		putErrmsg("No space for bulk database.", NULL);
+		return 0;
+	}
+
+	sdr_write(sdr, newDbObj, (char *) db, sizeof(BulkDB));
+	sdr_catlg(sdr, BULK_DB_NAME, 0, newDbObj);
+	return newDbObj;
+}
+
+static Object	locateItem(Sdr sdr, BulkDB *db, unsigned long item)
+{
+	Address	itemObj;
+
+	if (sdr_hash_retrieve(sdr, db->items, (char *) &item, &itemObj,
+			NULL) != 1)
+	{
+		return 0;
+	}
+
+	return itemObj;
+}
+
+static Object	findItem(Sdr sdr, BulkDB *db, unsigned long item,
+			BulkItem *itemBuf)
+{
+	Object	itemObj;
+
+	itemObj = locateItem(sdr, db, item);
+	if (itemObj)
+	{
+		sdr_stage(sdr, (char *) itemBuf, itemObj, sizeof(BulkItem));
+	}
+
+	return itemObj;
+}
+
+static int	allocateBlock(Sdr sdr, BulkDB *db, unsigned long *block)
+{
+	Object	elt;
+	int	fd;
+	vast	newSize;
+
+	elt = sdr_list_first(sdr, db->freeBlocks);
+	if (elt)		/*	Recycle a freed block.		*/
+	{
+		*block = sdr_list_data(sdr, elt);
+		sdr_list_delete(sdr, elt, NULL, NULL);
+		return 0;
+	}
+
+	if (db->nextBlock == db->storeBlocks)
+	{
+		/*	Extend the store file.				*/
+
+		fd = getStoreFd();
+		if (fd < 0)
+		{
+			return -1;
+		}
+
+		newSize = ((vast) (db->storeBlocks + BULK_GROWTH_BLOCKS))
+				* BULK_BLOCK_SIZE;
+#ifdef linux
+		errno = posix_fallocate(fd, 0, newSize);
+		if (errno)
+#else
+		if (ftruncate(fd, newSize) < 0)
+#endif
+		{
+			putSysErrmsg("Can't extend bulk store file", NULL);
+			return -1;
+		}
+
+		db->storeBlocks += BULK_GROWTH_BLOCKS;
+	}
+
+	*block = db->nextBlock;
+	db->nextBlock++;
+	return 0;
+}
+
+static int	growBlockMap(Sdr sdr, BulkItem *itemBuf, unsigned long needed)
+{
+	unsigned long	blocks[BULK_MAP_CHUNK];
+	unsigned long	newSize;
+	Object		newMap;
+	unsigned long	i;
+	unsigned long	count;
+
+	newSize = itemBuf->mapSize * 2;
+	if (newSize < needed)
+	{
+		newSize = needed;
+	}
+
+	if (newSize < 16)
+	{
+		newSize = 16;
+	}
+
+	newMap = sdr_malloc(sdr, newSize * sizeof(unsigned long));
+	if (newMap == 0)
+	{
+		putErrmsg("No space for bulk block map.", utoa(newSize));
+		return -1;
+	}
+
+	for (i = 0; i < itemBuf->blockCount; i += count)
+	{
+		count = itemBuf->blockCount - i;
+		if (count > BULK_MAP_CHUNK)
+		{
+			count = BULK_MAP_CHUNK;
+		}
+
+		sdr_read(sdr, (char *) blocks, itemBuf->blockMap
+				+ (i * sizeof(unsigned long)),
+				count * sizeof(unsigned long));
+		sdr_write(sdr, newMap + (i * sizeof(unsigned long)),
+				(char *) blocks, count * sizeof(unsigned long));
+	}
+
+	if (itemBuf->blockMap)
+	{
+		sdr_free(sdr, itemBuf->blockMap);
+	}
+
+	itemBuf->blockMap = newMap;
+	itemBuf->mapSize = newSize;
+	return 0;
+}
+
+/*	Reads or writes the indicated span of the item's data, one
+ *	run of contiguous store file blocks at a time.			*/
+
+static int	transferData(Sdr sdr, BulkItem *itemBuf, char *buffer,
+			vast offset, vast length, int writing)
+{
+	unsigned long	blocks[BULK_MAP_CHUNK];
+	unsigned long	firstIdx;
+	unsigned long	mapIdx = 0;
+	unsigned long	mapCount = 0;
+	unsigned long	idx;
+	unsigned long	runStart;
+	vast		blockOffset;
+	vast		runLength;
+	int		fd;
+
+	fd = getStoreFd();
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	while (length > 0)
+	{
+		idx = offset / BULK_BLOCK_SIZE;
+		blockOffset = offset % BULK_BLOCK_SIZE;
+		if (idx < mapIdx || idx >= mapIdx + mapCount)
+		{
+			mapIdx = idx;
+			mapCount = itemBuf->blockCount - idx;
+			if (mapCount > BULK_MAP_CHUNK)
+			{
+				mapCount = BULK_MAP_CHUNK;
+			}
+
+			sdr_read(sdr, (char *) blocks, itemBuf->blockMap
+					+ (mapIdx * sizeof(unsigned long)),
+					mapCount * sizeof(unsigned long));
+		}
+
+		/*	Extend the run while the next block of the
+		 *	item is the next block of the store file.	*/
+
+		firstIdx = idx;
+		runStart = blocks[idx - mapIdx];
+		runLength = BULK_BLOCK_SIZE - blockOffset;
+		while (runLength < length && idx + 1 < mapIdx + mapCount
+		&& blocks[idx + 1 - mapIdx] == runStart + (idx + 1 - firstIdx))
+		{
+			idx++;
+			runLength += BULK_BLOCK_SIZE;
+		}
+
+		if (runLength > length)
+		{
+			runLength = length;
+		}
+
+		if (storeIo(fd, buffer, runStart, blockOffset, runLength,
+				writing) < 0)
+		{
+			putSysErrmsg(writing ? "bulk_write failed on write."
+					: "bulk_read failed on read.",
+					utoa(itemBuf->item));
+			return -1;
+		}
+
+		buffer += runLength;
+		offset += runLength;
+		length -= runLength;
+	}
+
+	return 0;
+}
+
+int	bulk_create(unsigned long item)
+{
+	Sdr		sdr = getIonsdr();
+	BulkDB		db;
+	BulkItem	itemBuf;
+	Object		itemObj;
+
+	CHKERR(sdr_begin_xn(sdr));
+	if (getBulkDb(sdr, &db) == 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("bulk_create failed.", utoa(item));
+		return -1;
+	}
+
+	if (findItem(sdr, &db, item, &itemBuf))
+	{
+		sdr_exit_xn(sdr);	/*	Item already exists.	*/
+		return 0;
+	}
+
+	memset((char *) &itemBuf, 0, sizeof(BulkItem));
+	itemBuf.item = item;
+	itemObj = sdr_malloc(sdr, sizeof(BulkItem));
+	if (itemObj == 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("No space for bulk item.", utoa(item));
+		return -1;
+	}
+
+	sdr_write(sdr, itemObj, (char *) &itemBuf, sizeof(BulkItem));
+	if (sdr_hash_insert(sdr, db.items, (char *) &item, itemObj, NULL) < 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("Can't index bulk item.", utoa(item));
+		return -1;
+	}
+
+	if (sdr_end_xn(sdr) < 0)
+	{
+		putErrmsg("bulk_create failed.", utoa(item));
+		return -1;
+	}
+
+	return 0;
+}
+
+int	bulk_write(unsigned long item, vast offset, char *buffer, vast length)
+{
+	static char	zeroes[BULK_BLOCK_SIZE];
+	Sdr		sdr = getIonsdr();
+	BulkDB		db;
+	Object		dbObj;
+	BulkItem	itemBuf;
+	Object		itemObj;
+	unsigned long	blocksNeeded;
+	unsigned long	block;
+	vast		blockStart;
+	int		fd;
+
+	CHKERR(buffer);
+	CHKERR(offset >= 0 && length >= 0);
+	CHKERR(sdr_begin_xn(sdr));
+	dbObj = getBulkDb(sdr, &db);
+	if (dbObj == 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("bulk_write failed.", utoa(item));
+		return -1;
+	}
+
+	itemObj = findItem(sdr, &db, item, &itemBuf);
+	if (itemObj == 0)
+	{
+		sdr_exit_xn(sdr);
+		putErrmsg("bulk_write failed: no such item.", utoa(item));
+		return -1;
+	}
+
+	/*	Allocate any additional blocks needed.  A new block
+	 *	that this write doesn't completely fill is zeroed
+	 *	first, as it may hold data of a destroyed item.		*/
+
+	blocksNeeded = (offset + length + BULK_BLOCK_SIZE - 1)
+			/ BULK_BLOCK_SIZE;
+	if (blocksNeeded > itemBuf.mapSize)
+	{
+		if (growBlockMap(sdr, &itemBuf, blocksNeeded) < 0)
+		{
+			sdr_cancel_xn(sdr);
+			putErrmsg("bulk_write failed.", utoa(item));
+			return -1;
+		}
+	}
+
+	if (itemBuf.blockCount < blocksNeeded)
+	{
+		sdr_stage(sdr, NULL, itemBuf.blockMap, 0);
+	}
+
+	while (itemBuf.blockCount < blocksNeeded)
+	{
+		if (allocateBlock(sdr, &db, &block) < 0)
+		{
+			sdr_cancel_xn(sdr);
+			putErrmsg("bulk_write failed.", utoa(item));
+			return -1;
+		}
+
+		blockStart = ((vast) itemBuf.blockCount) * BULK_BLOCK_SIZE;
+		if (offset > blockStart
+		|| offset + length < blockStart + BULK_BLOCK_SIZE)
+		{
+			fd = getStoreFd();
+			if (fd < 0 || storeIo(fd, zeroes, block, 0,
+					BULK_BLOCK_SIZE, 1) < 0)
+			{
+				sdr_cancel_xn(sdr);
+				putSysErrmsg("bulk_write failed on write.",
+						utoa(item));
+				return -1;
+			}
+		}
+
+		sdr_write(sdr, itemBuf.blockMap + (itemBuf.blockCount
+				* sizeof(unsigned long)), (char *) &block,
+				sizeof(unsigned long));
+		itemBuf.blockCount++;
+	}
+
+	if (transferData(sdr, &itemBuf, buffer, offset, length, 1) < 0)
+	{
+		sdr_cancel_xn(sdr);
+		return -1;
+	}
+
+	if (offset + length > itemBuf.length)
+	{
+		itemBuf.length = offset + length;
+	}
+
+	sdr_write(sdr, itemObj, (char *) &itemBuf, sizeof(BulkItem));
+	sdr_write(sdr, dbObj, (char *) &db, sizeof(BulkDB));
+	if (sdr_end_xn(sdr) < 0)
+	{
+		putErrmsg("bulk_write failed.", utoa(item));
+		return -1;
+	}
+
+	return length;
+}
+
+int	bulk_read(unsigned long item, char *buffer, vast offset, vast length)
+{
+	Sdr		sdr = getIonsdr();
+	Object		dbObj;
+	BulkDB		db;
+	Object		itemObj;
+	BulkItem	itemBuf;
+
+	CHKERR(buffer);
+	CHKERR(offset >= 0 && length >= 0);
+
+	/*	Reading an item changes nothing in the SDR, so any
+	 *	number of tasks may read bulk items concurrently.	*/
+
+	CHKERR(sdr_begin_read_xn(sdr));
+	dbObj = findBulkDb(sdr);
+	if (dbObj)
+	{
+		sdr_read(sdr, (char *) &db, dbObj, sizeof(BulkDB));
+		itemObj = locateItem(sdr, &db, item);
+	}
+	else
+	{
+		itemObj = 0;
+	}
+
+	if (itemObj == 0)
+	{
+		sdr_exit_xn(sdr);
+		putErrmsg("bulk_read failed: no such item.", utoa(item));
+		return -1;
+	}
+
+	sdr_read(sdr, (char *) &itemBuf, itemObj, sizeof(BulkItem));
+
+	if (offset + length > itemBuf.length)
+	{
+		sdr_exit_xn(sdr);
+		putErrmsg("bulk_read failed: read past end of item.",
+				utoa(item));
+		return -1;
+	}
+
+	if (transferData(sdr, &itemBuf, buffer, offset, length, 0) < 0)
+	{
+		sdr_exit_xn(sdr);
+		return -1;
+	}
+
+	sdr_exit_xn(sdr);
+	return length;
+}
+
+void	bulk_destroy(unsigned long item)
+{
+	Sdr		sdr = getIonsdr();
+	BulkDB		db;
+	BulkItem	itemBuf;
+	Address		itemObj;
+	unsigned long	blocks[BULK_MAP_CHUNK];
+	unsigned long	i;
+	unsigned long	j;
+	unsigned long	count;
+
+	CHKVOID(sdr_begin_xn(sdr));
+	if (getBulkDb(sdr, &db) == 0
+	|| sdr_hash_remove(sdr, db.items, (char *) &item, &itemObj) != 1)
+	{
+		sdr_exit_xn(sdr);
+		return;
+	}
+
+	/*	Recycle the item's blocks, most recently used first.	*/
+
+	sdr_read(sdr, (char *) &itemBuf, itemObj, sizeof(BulkItem));
+	for (i = 0; i < itemBuf.blockCount; i += count)
+	{
+		count = itemBuf.blockCount - i;
+		if (count > BULK_MAP_CHUNK)
+		{
+			count = BULK_MAP_CHUNK;
+		}
+
+		sdr_read(sdr, (char *) blocks, itemBuf.blockMap
+				+ (i * sizeof(unsigned long)),
+				count * sizeof(unsigned long));
+		for (j = 0; j < count; j++)
+		{
+			if (sdr_list_insert_first(sdr, db.freeBlocks,
+					blocks[j]) == 0)
+			{
+				sdr_cancel_xn(sdr);
+				putErrmsg("Can't recycle bulk block.",
+						utoa(item));
+				return;
+			}
+		}
+	}
+
+	if (itemBuf.blockMap)
+	{
+		sdr_free(sdr, itemBuf.blockMap);
+	}
+
+	sdr_free(sdr, itemObj);
+	if (sdr_end_xn(sdr) < 0)
+	{
+		putErrmsg("bulk_destroy failed.", utoa(item));
+	}
+}
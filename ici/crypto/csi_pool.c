@@ -0,0 +1,428 @@
+/*****************************************************************************
+ **
+ ** File Name: csi_pool.c
+ **
+ ** Description: This file implements a pool of worker threads to which the
+ **              streaming ("update") functions of the ION crypto interface
+ **              can be offloaded, independent of the ciphersuite library.
+ **
+ **              A job binds one CSI context to the pool.  The caller
+ **              submits the chunks of its input to the job and later
+ **              collects the corresponding outputs, in order.  Up to
+ **              CSI_JOB_DEPTH chunks may be outstanding at once, so the
+ **              caller can read (and write) the next chunks of a block
+ **              while a worker is applying the ciphersuite to earlier
+ **              ones.  The chunks of any one job are processed in
+ **              submission order by one worker at a time, as the
+ **              context requires; different jobs are processed by
+ **              different workers concurrently.
+ **
+ ** Notes:
+ **    1. Workers only ever call CSI functions: they never access the SDR
+ **       or begin transactions, so a job may be used by a caller that is
+ **       within a transaction.
+ **    2. The pool's workers are started in each process upon creation of
+ **       that process's first job.  If no worker can be started, jobs are
+ **       processed synchronously on submission.
+ **
+ ** Assumptions:
+ **    1. The ciphersuite library's functions are reentrant for distinct
+ **       contexts.
+ **
+ *****************************************************************************/
+
+#include "platform.h"
+#include "csi.h"
+#include "csi_debug.h"
+
+#ifndef CSI_POOL_MAX_WORKERS
+#define CSI_POOL_MAX_WORKERS	4
+#endif
+
+struct csi_job_s
+{
+    csi_csid_t     suite;
+    void          *context;
+    csi_svcid_t    svc;
+    csi_val_t      input[CSI_JOB_DEPTH];
+    csi_val_t      output[CSI_JOB_DEPTH];
+    uint32_t       submitted;   /* Chunks submitted.                   */
+    uint32_t       processed;   /* Chunks processed by a worker.       */
+    uint32_t       collected;   /* Outputs collected by the caller.    */
+    int            failed;      /* Once set, later chunks are skipped. */
+    int            queued;      /* On the ready queue or in a worker.  */
+    pthread_cond_t progress;
+    csi_job_t     *next;
+};
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  workToDo;
+    csi_job_t      *first;      /* Ready queue.                        */
+    csi_job_t      *last;
+    int             workers;
+    int             started;
+} CsiPool;
+
+static CsiPool	gCsiPool = { PTHREAD_MUTEX_INITIALIZER,
+		PTHREAD_COND_INITIALIZER, NULL, NULL, 0, 0 };
+
+
+
+/******************************************************************************
+ *
+ * \par Function Name: processChunk
+ *
+ * \par Applies the job's ciphersuite to one input chunk and releases the
+ *      chunk's input buffer.
+ *
+ * \retval 1 on success, ERROR on failure
+ *****************************************************************************/
+
+static int processChunk(csi_job_t *job, int slot, int skip)
+{
+    csi_val_t *input = job->input + slot;
+    csi_val_t *output = job->output + slot;
+    int result = 1;
+
+    memset(output, 0, sizeof(csi_val_t));
+    if (skip)
+    {
+        result = ERROR;
+    }
+    else if (job->svc == CSI_SVC_ENCRYPT || job->svc == CSI_SVC_DECRYPT)
+    {
+        *output = csi_crypt_update(job->suite, job->context, job->svc, *input);
+        if (output->contents == NULL)
+        {
+            result = ERROR;
+        }
+    }
+    else if (csi_sign_update(job->suite, job->context, *input, job->svc) == ERROR)
+    {
+        result = ERROR;
+    }
+
+    MRELEASE(input->contents);
+    input->contents = NULL;
+    return result;
+}
+
+
+
+/******************************************************************************
+ *
+ * \par Function Name: poolWorker
+ *
+ * \par Main loop of a pool worker thread: takes jobs from the ready queue
+ *      and processes all of each job's submitted chunks.
+ *****************************************************************************/
+
+static void *poolWorker(void *parm)
+{
+    CsiPool   *pool = (CsiPool *) parm;
+    csi_job_t *job;
+    int        slot;
+    int        skip;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1)
+    {
+        job = pool->first;
+        if (job == NULL)
+        {
+            oK(pthread_cond_wait(&pool->workToDo, &pool->lock));
+            continue;
+        }
+
+        pool->first = job->next;
+        if (pool->first == NULL)
+        {
+            pool->last = NULL;
+        }
+
+        job->next = NULL;
+        while (job->processed < job->submitted)
+        {
+            slot = job->processed % CSI_JOB_DEPTH;
+            skip = job->failed;
+            pthread_mutex_unlock(&pool->lock);
+            if (processChunk(job, slot, skip) == ERROR)
+            {
+                skip = 1;
+            }
+
+            pthread_mutex_lock(&pool->lock);
+            job->failed = skip;
+            job->processed++;
+            pthread_cond_signal(&job->progress);
+        }
+
+        job->queued = 0;
+        pthread_cond_signal(&job->progress);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+
+
+/******************************************************************************
+ *
+ * \par Function Name: startWorkers
+ *
+ * \par Starts the pool's worker threads, one per online processor up to
+ *      CSI_POOL_MAX_WORKERS.  Must be called with the pool lock held.
+ *****************************************************************************/
+
+static void startWorkers(CsiPool *pool)
+{
+    pthread_t thread;
+    long      count = 1;
+
+    pool->started = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+    count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (count < 1)
+    {
+        count = 1;
+    }
+
+    if (count > CSI_POOL_MAX_WORKERS)
+    {
+        count = CSI_POOL_MAX_WORKERS;
+    }
+
+    while (pool->workers < count)
+    {
+        if (pthread_begin(&thread, NULL, poolWorker, pool, "csiWorker") < 0)
+        {
+            putSysErrmsg("Can't start CSI worker thread", NULL);
+            break;
+        }
+
+        oK(pthread_detach(thread));
+        pool->workers++;
+    }
+}
+
+
+
+/******************************************************************************
+ *
+ * \par Function Name: csi_job_start
+ *
+ * \par Creates a job that offloads the update processing of a context,
+ *      whose sign or crypt operation the caller has already started, to
+ *      the worker pool.
+ *
+ * \param[in]  suite    The ciphersuite of the context.
+ * \param[in]  context  The started CSI context.
+ * \param[in]  svc      The service: encrypt/decrypt jobs use
+ *                      csi_crypt_update, sign/verify jobs csi_sign_update.
+ *
+ * \return The job, or NULL on failure.
+ *****************************************************************************/
+
+csi_job_t *csi_job_start(csi_csid_t suite, void *context, csi_svcid_t svc)
+{
+    csi_job_t *job;
+
+    CHKNULL(context);
+    if ((job = MTAKE(sizeof(csi_job_t))) == NULL)
+    {
+        CSI_DEBUG_ERR("x csi_job_start: Can't allocate job.", NULL);
+        return NULL;
+    }
+
+    memset(job, 0, sizeof(csi_job_t));
+    job->suite = suite;
+    job->context = context;
+    job->svc = svc;
+    oK(pthread_cond_init(&job->progress, NULL));
+    pthread_mutex_lock(&gCsiPool.lock);
+    if (!gCsiPool.started)
+    {
+        startWorkers(&gCsiPool);
+    }
+
+    pthread_mutex_unlock(&gCsiPool.lock);
+    return job;
+}
+
+
+
+/******************************************************************************
+ *
+ * \par Function Name: csi_job_submit
+ *
+ * \par Submits the next chunk of input to a job.  The job takes ownership
+ *      of the chunk's contents, which must have been allocated by MTAKE,
+ *      and releases them once the chunk is processed.
+ *
+ * \par Notes:
+ *      - At most CSI_JOB_DEPTH chunks may be submitted and not yet
+ *        collected.
+ *
+ * \retval 1 on success, ERROR on failure
+ *****************************************************************************/
+
+int8_t csi_job_submit(csi_job_t *job, csi_val_t data)
+{
+    CsiPool *pool = &gCsiPool;
+    int      slot;
+
+    CHKERR(job);
+    CHKERR(data.contents);
+    if (job->submitted - job->collected >= CSI_JOB_DEPTH)
+    {
+        CSI_DEBUG_ERR("x csi_job_submit: Too many chunks outstanding.", NULL);
+        MRELEASE(data.contents);
+        return ERROR;
+    }
+
+    slot = job->submitted % CSI_JOB_DEPTH;
+    job->input[slot] = data;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->workers == 0)     /* Process synchronously.              */
+    {
+        pthread_mutex_unlock(&pool->lock);
+        if (processChunk(job, slot, job->failed) == ERROR)
+        {
+            job->failed = 1;
+        }
+
+        job->submitted++;
+        job->processed++;
+        return 1;
+    }
+
+    job->submitted++;
+    if (!job->queued)
+    {
+        job->queued = 1;
+        if (pool->last)
+        {
+            pool->last->next = job;
+        }
+        else
+        {
+            pool->first = job;
+        }
+
+        pool->last = job;
+        pthread_cond_signal(&pool->workToDo);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    return 1;
+}
+
+
+
+/******************************************************************************
+ *
+ * \par Function Name: csi_job_collect
+ *
+ * \par Waits for the earliest uncollected chunk submitted to a job to be
+ *      processed and returns its output.
+ *
+ * \param[in]  job     The job.
+ * \param[out] output  For encrypt/decrypt jobs, the output of the chunk,
+ *                     which the caller must release by MRELEASE.  For
+ *                     sign/verify jobs, an empty value.
+ *
+ * \retval 1 on success, 0 if no chunk is outstanding, ERROR if this or any
+ *         earlier chunk of the job failed.
+ *****************************************************************************/
+
+int8_t csi_job_collect(csi_job_t *job, csi_val_t *output)
+{
+    CsiPool *pool = &gCsiPool;
+    int      slot;
+    int      failed;
+
+    CHKERR(job);
+    CHKERR(output);
+    memset(output, 0, sizeof(csi_val_t));
+    if (job->collected == job->submitted)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (job->processed == job->collected)
+    {
+        oK(pthread_cond_wait(&job->progress, &pool->lock));
+    }
+
+    failed = job->failed;
+    pthread_mutex_unlock(&pool->lock);
+    slot = job->collected % CSI_JOB_DEPTH;
+    job->collected++;
+    if (failed)
+    {
+        if (job->output[slot].contents)
+        {
+            MRELEASE(job->output[slot].contents);
+        }
+
+        return ERROR;
+    }
+
+    *output = job->output[slot];
+    return 1;
+}
+
+
+
+/******************************************************************************
+ *
+ * \par Function Name: csi_job_end
+ *
+ * \par Waits for all chunks submitted to a job to be processed, discards
+ *      any outputs not collected, and destroys the job.  The job's context
+ *      is not freed: the caller finishes and frees it as usual.
+ *
+ * \retval 1 if every chunk submitted to the job was processed successfully,
+ *         ERROR otherwise.
+ *****************************************************************************/
+
+int8_t csi_job_end(csi_job_t *job)
+{
+    CsiPool  *pool = &gCsiPool;
+    csi_val_t output;
+    int8_t    result = 1;
+
+    CHKERR(job);
+    while (job->collected < job->submitted)
+    {
+        if (csi_job_collect(job, &output) == ERROR)
+        {
+            result = ERROR;
+        }
+        else if (output.contents)
+        {
+            MRELEASE(output.contents);
+        }
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (job->queued)
+    {
+        oK(pthread_cond_wait(&job->progress, &pool->lock));
+    }
+
+    if (job->failed)
+    {
+        result = ERROR;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    oK(pthread_cond_destroy(&job->progress));
+    MRELEASE(job);
+    return result;
+}
@@ -14,6 +14,13 @@
 extern "C" {
 #endif
 
+/*	Processor CRC instructions, used where supported.	*/
+
+#define	ION_CRC_SSE42		(1)
+#define	ION_CRC_PCLMUL		(2)
+
+extern int	ion_CRC_hw_accel(int features);
+
 extern uint16_t	ion_CRC16_1021_X25(const char *data, uint32_t dLen,
 			uint16_t crc);
 #ifdef ENABLE_HIGH_SPEED
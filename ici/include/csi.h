@@ -179,4 +179,27 @@ extern uint32_t	csi_sign_res_len(csi_csid_t suite, void *context);
 extern uint32_t	csi_crypt_parm_get_len(csi_csid_t suite, csi_parmid_t parmid);
 extern uint32_t	csi_crypt_res_len(csi_csid_t suite, void *context, csi_blocksize_t blocksize, csi_svcid_t svc);
 
+/*****************************************************************************
+ *          ION Crypto Interface Worker Pool (Asynchronous) Functions        *
+ *****************************************************************************/
+
+/*
+ * A job hands the sign or crypt "update" processing of one started context
+ * to a pool of worker threads.  The caller submits input chunks and later
+ * collects their outputs in order, so it can read the next chunks of a
+ * block while earlier ones are being processed.  At most CSI_JOB_DEPTH
+ * chunks may be submitted and not yet collected.
+ */
+
+#ifndef CSI_JOB_DEPTH
+#define CSI_JOB_DEPTH	4
+#endif
+
+typedef struct csi_job_s csi_job_t;
+
+extern csi_job_t	*csi_job_start(csi_csid_t suite, void *context, csi_svcid_t svc);
+extern int8_t		 csi_job_submit(csi_job_t *job, csi_val_t data);
+extern int8_t		 csi_job_collect(csi_job_t *job, csi_val_t *output);
+extern int8_t		 csi_job_end(csi_job_t *job);
+
 #endif
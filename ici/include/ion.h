@@ -287,6 +287,14 @@ typedef struct
  *	structure and function specific to the routing system
  *	established for the bundle protocol agent.
  *
+ *	Each route computed for an IonNode is a routing-dependent
+ *	SmList of "hops", the list user data of which is the address
+ *	of that IonNode; each hop is cited in the "citations" list
+ *	of the IonCXref for the contact that is that hop.  When a
+ *	contact is deleted, the IonNodes whose routes cite it are
+ *	flagged as having stale routes, so the routing system need
+ *	recompute only the routes to those nodes.
+ *
  *	The IonVdb also contains red-black trees that (a) index all
  *	contacts in the non-volatile database, by "from" node, "to"
  *	node, and time, and (b) support immediate lookup of the
@@ -325,6 +333,7 @@ typedef struct
 	uvast		nodeNbr;	/*	As from IonContact.	*/
 	PsmAddress	embargoes;	/*	SM list: Embargo	*/
 	PsmAddress	routingObject;	/*	Routing-dependent.	*/
+	int		routesAreStale;	/*	Boolean.		*/
 } IonNode;		/*	A potential bundle destination node.	*/
 
 typedef struct
@@ -445,6 +454,7 @@ typedef struct
 	int		deltaFromUTC;	/*	In seconds.		*/
 	time_t		refTime;	/*	As set by ionadmin.	*/
 	struct timeval	lastEditTime;	/*	Add/del contacts/ranges	*/
+	struct timeval	lastResetTime;	/*	Edits voiding all routes*/
 	PsmAddress	nodes;		/*	SM RB tree: IonNode	*/
 	PsmAddress	neighbors;	/*	SM RB tree: IonNeighbor	*/
 	PsmAddress	contactIndex;	/*	SM RB tree: IonCXref	*/
@@ -519,6 +529,8 @@ extern vast		ionAppendZcoExtent(Object zco,
 					ReqAttendant *attendant);
 extern int		ionSendZcoByTCP(int *sock, Object zco, char *buffer,
 					int buflen);
+extern int		ionSendZcoSpansByTCP(int *sock, ZcoReader *reader,
+					int length, char *buffer);
 
 extern const char	*getIonVersionNbr();
 extern Sdr		getIonsdr();
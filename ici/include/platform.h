@@ -22,6 +22,10 @@ extern "C" {
 #error Both FORCE_SVR4_SEMAPHORES and FORCE_POSIX_NAMED_SEMAPHORES defined - pick one
 #endif
 
+#if defined(FORCE_FUTEX_SEMAPHORES) && (defined(FORCE_SVR4_SEMAPHORES) || defined(FORCE_POSIX_NAMED_SEMAPHORES))
+#error FORCE_FUTEX_SEMAPHORES defined along with another FORCE_*_SEMAPHORES option - pick one
+#endif
+
 #if defined (VXWORKS) || defined (RTEMS) || defined (bionic) || defined (AESCFS) || defined (STRSOE)
 #define ION_LWT
 #else
@@ -670,6 +674,12 @@ int pthread_setname_np(pthread_t thread, const char *name);
 #undef	SVR4_SEMAPHORES
 #undef  POSIX_SEMAPHORES
 #define POSIX_NAMED_SEMAPHORES
+#elif defined(FORCE_FUTEX_SEMAPHORES)
+/* not the default: semaphore table in SVR4 shared memory, futex-based */
+#undef	SVR4_SEMAPHORES
+#undef  POSIX_SEMAPHORES
+#undef  POSIX_NAMED_SEMAPHORES
+#define FUTEX_SEMAPHORES
 #endif /* FORCE_SVR4_SEMAPHORES */
 #ifdef  POSIX_NAMED_SEMAPHORES
 #ifdef  DEBUG_POSIX_NAMED_SEMAPHORES
@@ -993,6 +1003,8 @@ extern void			printDottedString(unsigned int hostNbr,
 extern int			itcp_connect(char *socketSpec,
 					unsigned short defaultPort, int *sock);
 extern int			itcp_send(int *sock, char *from, int length);
+extern int			itcp_sendfile(int *sock, int fd, vast offset,
+					int length);
 extern int			itcp_recv(int *sock, char *into, int length);
 extern void			itcp_handleConnectionLoss(int signum);
 
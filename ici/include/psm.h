@@ -27,6 +27,8 @@ typedef struct
 	size_t	partitionSize;
 	size_t	smallPoolSize;
 	size_t	smallPoolFreeBlockCount[SMALL_SIZES];
+	size_t	smallPoolCachedBlockCount[SMALL_SIZES];
+	size_t	smallPoolCached;
 	size_t	smallPoolFree;
 	size_t	smallPoolAllocated;
 	size_t	largePoolSize;
@@ -214,7 +216,16 @@ extern int		psm_locate(PsmPartition, char *objName,
 
 extern void		psm_audit(PsmPartition);
 			/*	Steps through all free lists of the
-			 *	small pool, aborting on any error.	*/
+			 *	small pool, and through this process's
+			 *	cache of free small blocks, aborting
+			 *	on any error.				*/
+
+extern void		psm_flush_cache(PsmPartition);
+			/*	Returns to the partition's free lists
+			 *	all free small blocks that are cached
+			 *	by this process.  Should be called
+			 *	before the process detaches from the
+			 *	partition.				*/
 
 extern void		psm_usage(PsmPartition, PsmUsageSummary *);
 			/*	Loads PsmUsageSummary structure with
@@ -36,6 +36,8 @@ typedef struct sdrv_str	*Sdr;	/*	Local view of an SDR.		*/
 #define	SDR_IN_FILE	2	/*	Write file; read file if nec.	*/
 #define	SDR_REVERSIBLE	4	/*	Transactions may be reversed.	*/
 #define	SDR_BOUNDED	8	/*	Object boundaries defended.	*/
+#define	SDR_GROUP_COMMIT 16	/*	Defer & coalesce file writes.	*/
+#define	SDR_MAPPED	32	/*	Access file via mmap, not I/O.	*/
 
 /*		SDR system administration functions.			*/
 
@@ -159,6 +161,41 @@ extern int		sdr_load_profile(char *name, int configFlags,
 				by total data space size will be
 				created and filled with zeros.
 
+				If SDR_GROUP_COMMIT is selected along
+				with SDR_IN_FILE, updates to the
+				dataspace file are not written as
+				they are made but are instead noted
+				as "dirty extents" (coalescing any
+				that overlap or abut) and flushed in
+				address order, in a few large writes,
+				when a transaction ends after the
+				group commit limits (dirty bytes,
+				dirty extents, log length, elapsed
+				time) are exceeded.  So the file
+				updates of many transactions share
+				one flush.  If the log is also in a
+				file, it is truncated only after each
+				flush; after a system crash, the
+				dataspace file reverts to its state
+				as of the last completed flush.
+
+				If SDR_MAPPED is selected along with
+				SDR_IN_FILE but not SDR_IN_DRAM, the
+				dataspace file is mapped into the
+				address space of each process that
+				uses the SDR: heap reads and writes
+				are simple memory copies to and from
+				the file's pages.  If SDR_GROUP_COMMIT
+				is also selected, the modified pages
+				are written back to the file
+				synchronously (msync) at each group
+				flush.  The
+				heap need not fit in shared memory
+				and the file need not be read into
+				memory at startup.  SDR_MAPPED is
+				ignored on platforms that don't
+				support memory-mapped files.
+
 				If a cleanup task must be run whenever
 				a transaction is reversed, the command
 				to execute this task must be provided
@@ -212,6 +249,20 @@ extern void		sdr_destroy(Sdr sdr);
 /*		Basic, low-level SDR transaction functions.		*/
 
 extern int		sdr_begin_xn(Sdr sdr);
+extern int		sdr_begin_read_xn(Sdr sdr);
+			/*	Begins a shared, read-only transaction:
+				any number of tasks may be in shared
+				transactions on the same SDR at once,
+				but none while any task is in a normal
+				(exclusive) transaction.  Data may be
+				read but not written, and sdr_in_xn()
+				returns 0; end the transaction with
+				sdr_exit_xn().  A shared transaction
+				nested in an exclusive one is simply
+				part of the exclusive transaction, but
+				an exclusive transaction can't begin
+				within a shared one.  Returns 1 on
+				success, 0 on failure.			*/
 extern int		sdr_in_xn(Sdr sdr);		/*	Boolean	*/
 extern int		sdr_heap_is_halted(Sdr sdr);	/*	Boolean	*/
 extern void		sdr_exit_xn(Sdr sdr);
@@ -93,6 +93,13 @@ typedef struct
 	vast	lengthCopied;			/*	incl. capsules	*/
 } ZcoReader;
 
+typedef struct
+{
+	char		pathName[256];	/*	"" if not file-sourced.	*/
+	unsigned long	inode;
+	vast		offset;		/*	Within the file.	*/
+} ZcoFileSpan;
+
 /*	Commonly used functions for building, accessing, managing,
  	and destroying a ZCO.						*/
 
@@ -536,6 +543,50 @@ extern vast	zco_transmit(	Sdr sdr,
 			 *	this ZCO.  Returns the number of bytes
 			 *	copied, or -1 on any error.		*/
 
+extern vast	zco_transmit_span(Sdr sdr,
+				ZcoReader *reader,
+				vast length,
+				char *buffer,
+				ZcoFileSpan *span);
+			/*	Like zco_transmit, but stops at the
+			 *	boundaries of file-sourced extents so
+			 *	that file data needn't be copied.  If
+			 *	the next as-yet-uncopied byte of the
+			 *	ZCO is sourced from a file, copies
+			 *	nothing: populates "span" with the
+			 *	file's path name and inode number and
+			 *	the offset of that byte within the
+			 *	file, and returns the number of bytes
+			 *	(up to "length") that may be read
+			 *	contiguously from the file starting
+			 *	at that offset.  Otherwise sets the
+			 *	span's path name to "" and copies into
+			 *	"buffer" up to "length" bytes that
+			 *	precede the next file-sourced extent.
+			 *	Either way, the reader is advanced
+			 *	past the bytes returned.  The file
+			 *	itself is not accessed: the caller
+			 *	obtains a descriptor for it from
+			 *	zco_file_span_fd and, if that fails,
+			 *	must substitute ZCO_FILE_FILL_CHAR
+			 *	for the span's bytes as zco_transmit
+			 *	would.  Returns 0 if copied data could
+			 *	not be read from their source (as does
+			 *	zco_transmit), -1 on any other
+			 *	error.					*/
+
+extern int	zco_file_span_fd(ZcoFileSpan *span,
+				vast length);
+			/*	Returns a file descriptor, open for
+			 *	reading, for the file from which the
+			 *	"length" bytes of "span" are sourced.
+			 *	The descriptor is a duplicate of the
+			 *	one held in the ZCO file descriptor
+			 *	cache, and the caller must close it.
+			 *	Returns -1 if the file can't be
+			 *	opened, is no longer the span's file,
+			 *	or is too short to contain the span.	*/
+
 extern void	zco_start_receiving(Object zco,
 				ZcoReader *reader);
 			/*	Used by overlying protocol layer to
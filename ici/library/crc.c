@@ -19,6 +19,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include "crc.h"
 
 #ifndef ERROR
 #define ERROR (-1)
@@ -404,6 +406,263 @@ static uint32_t  crctable_1EDC6F41_r[256] =
 /*                   End of CRC Lookup Tables                    */
 /*****************************************************************/
 
+/*****************************************************************/
+/*                                                               */
+/* PROCESSOR CRC INSTRUCTIONS                                    */
+/* ==========================                                    */
+/*                                                               */
+/* On x86-64 processors that support them, the SSE4.2 crc32      */
+/* instruction computes CRC32C directly and the PCLMULQDQ        */
+/* carry-less multiply instruction "folds" 16-byte blocks of     */
+/* data for any reflected CRC of width 32 bits or less; the      */
+/* lookup tables above finish the folded remainder and serve     */
+/* as the fallback on all other processors.  Support is          */
+/* detected at run time, so one build runs everywhere.  Define   */
+/* NO_CRC_HW_ACCEL to compile the tables alone.                  */
+/*                                                               */
+/*****************************************************************/
+
+#if !defined(NO_CRC_HW_ACCEL) && defined(__x86_64__) \
+	&& (defined(__clang__) || __GNUC__ > 4 \
+	|| (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define	CRC_HW_ACCEL
+#endif
+
+#ifdef CRC_HW_ACCEL
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+
+/*	Folding costs a few dozen cycles of setup and finishing, so
+ *	the tables (or crc32) remain faster for short buffers.  For
+ *	long buffers folding four streams at once is faster than the
+ *	crc32 instruction, whose latency serializes the computation;
+ *	crc32 then finishes the folded residue.				*/
+
+#define	CRC_FOLD_MIN_LENGTH	(64)
+
+typedef struct
+{
+	uint32_t	poly;		/*	Not reflected.		*/
+	int		width;		/*	In bits.		*/
+	uint64_t	k1;		/*	Fold 128 bits, low half.*/
+	uint64_t	k2;		/*	Fold 128 bits, high half*/
+	uint64_t	k3;		/*	Fold 512 bits, low half.*/
+	uint64_t	k4;		/*	Fold 512 bits, high half*/
+} CrcFoldConstants;
+
+static CrcFoldConstants	fold_1021_r = { 0x1021, 16 };
+static CrcFoldConstants	fold_04C11DB7_r = { 0x04C11DB7, 32 };
+static CrcFoldConstants	fold_1EDC6F41_r = { 0x1EDC6F41, 32 };
+
+static int		crcHwSupported = -1;
+static int		crcHwEnabled = 0;
+
+/*	Returns x^exponent mod P, with x^k represented by bit k.	*/
+
+static uint64_t	xPowerModPoly(int exponent, uint32_t poly, int width)
+{
+	uint64_t	top = ((uint64_t) 1) << width;
+	uint64_t	r = 1;
+
+	while (exponent-- > 0)
+	{
+		r <<= 1;
+		if (r & top)
+		{
+			r ^= top | poly;
+		}
+	}
+
+	return r;
+}
+
+/*	For reflected CRCs the data's first bit is bit 0 of the first
+ *	byte, so a 64-bit lane holds its polynomial bit-reversed, and
+ *	the product of two reversed 64-bit values lands one bit to the
+ *	left of the reversed product.  So the constant for shifting a
+ *	lane by d bits is x^(d-1) mod P, bit-reversed in 64 bits.	*/
+
+static uint64_t	foldConstant(int distance, CrcFoldConstants *k)
+{
+	uint64_t	r = xPowerModPoly(distance - 1, k->poly, k->width);
+	uint64_t	reversed = 0;
+	int		i;
+
+	for (i = 0; i < 64; i++)
+	{
+		if (r & (((uint64_t) 1) << i))
+		{
+			reversed |= ((uint64_t) 1) << (63 - i);
+		}
+	}
+
+	return reversed;
+}
+
+static void	computeFoldConstants(CrcFoldConstants *k)
+{
+	k->k1 = foldConstant(128 + 64, k);
+	k->k2 = foldConstant(128, k);
+	k->k3 = foldConstant(512 + 64, k);
+	k->k4 = foldConstant(512, k);
+}
+
+/*	Detection is idempotent, so concurrent first calls are
+ *	harmless.							*/
+
+static int	crcHwFeatures()
+{
+	int	supported = 0;
+
+	if (crcHwSupported < 0)
+	{
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("sse4.2"))
+		{
+			supported |= ION_CRC_SSE42;
+		}
+
+		if (__builtin_cpu_supports("pclmul"))
+		{
+			computeFoldConstants(&fold_1021_r);
+			computeFoldConstants(&fold_04C11DB7_r);
+			computeFoldConstants(&fold_1EDC6F41_r);
+			supported |= ION_CRC_PCLMUL;
+		}
+
+		crcHwEnabled = supported;
+		crcHwSupported = supported;
+	}
+
+	return crcHwEnabled;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t	crc32cSse42(const char *data, uint32_t dLen, uint32_t crc)
+{
+	uint64_t	lcrc = (uint32_t) ~crc;
+	uint64_t	word;
+
+	while (dLen >= 8)
+	{
+		memcpy((char *) &word, data, 8);
+		lcrc = _mm_crc32_u64(lcrc, word);
+		data += 8;
+		dLen -= 8;
+	}
+
+	while (dLen--)
+	{
+		lcrc = _mm_crc32_u8((uint32_t) lcrc, (uint8_t) *data);
+		data++;
+	}
+
+	return ~((uint32_t) lcrc);
+}
+
+__attribute__((target("pclmul,sse2")))
+static __m128i	fold128(__m128i x, __m128i k)
+{
+	return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+			_mm_clmulepi64_si128(x, k, 0x11));
+}
+
+/*	Folds all whole 16-byte blocks of data into a single 16-byte
+ *	residue, such that the CRC register value lcrc (i.e., before
+ *	the final complement) after processing those blocks equals the
+ *	register value after processing the residue from zero.  Returns
+ *	the number of bytes folded; dLen must be at least 16.		*/
+
+__attribute__((target("pclmul,sse2")))
+static uint32_t	crcFold(CrcFoldConstants *k, const char *data,
+			uint32_t dLen, uint32_t lcrc, char *residue)
+{
+	const char	*cursor = data;
+	uint32_t	blocks = dLen >> 4;
+	__m128i		k128 = _mm_set_epi64x(k->k2, k->k1);
+	__m128i		k512;
+	__m128i		x0;
+	__m128i		x1;
+	__m128i		x2;
+	__m128i		x3;
+
+	x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) cursor),
+			_mm_cvtsi32_si128(lcrc));
+	cursor += 16;
+	blocks--;
+	if (blocks >= 7)
+	{
+		/*	Four independent streams hide the latency of
+		 *	the carry-less multiply.			*/
+
+		k512 = _mm_set_epi64x(k->k4, k->k3);
+		x1 = _mm_loadu_si128((const __m128i *) cursor);
+		x2 = _mm_loadu_si128((const __m128i *) (cursor + 16));
+		x3 = _mm_loadu_si128((const __m128i *) (cursor + 32));
+		cursor += 48;
+		blocks -= 3;
+		while (blocks >= 4)
+		{
+			x0 = _mm_xor_si128(fold128(x0, k512),
+				_mm_loadu_si128((const __m128i *) cursor));
+			x1 = _mm_xor_si128(fold128(x1, k512),
+				_mm_loadu_si128((const __m128i *)
+				(cursor + 16)));
+			x2 = _mm_xor_si128(fold128(x2, k512),
+				_mm_loadu_si128((const __m128i *)
+				(cursor + 32)));
+			x3 = _mm_xor_si128(fold128(x3, k512),
+				_mm_loadu_si128((const __m128i *)
+				(cursor + 48)));
+			cursor += 64;
+			blocks -= 4;
+		}
+
+		x1 = _mm_xor_si128(fold128(x0, k128), x1);
+		x2 = _mm_xor_si128(fold128(x1, k128), x2);
+		x0 = _mm_xor_si128(fold128(x2, k128), x3);
+	}
+
+	while (blocks > 0)
+	{
+		x0 = _mm_xor_si128(fold128(x0, k128),
+				_mm_loadu_si128((const __m128i *) cursor));
+		cursor += 16;
+		blocks--;
+	}
+
+	_mm_storeu_si128((__m128i *) residue, x0);
+	return cursor - data;
+}
+#endif	/*	CRC_HW_ACCEL						*/
+
+/******************************************************************************
+ *
+ * \par Function Name: ion_CRC_hw_accel
+ *
+ * \par Purpose: Select the processor CRC instructions that the CRC
+ *               functions may use.
+ *
+ * \retval      Mask of the processor CRC features now in use.
+ *
+ * \param[in]   features  Mask of ION_CRC_SSE42 and ION_CRC_PCLMUL, or -1
+ *                        for all; features the processor lacks are ignored.
+ *
+ * \par Notes:
+ *      1. By default all supported features are used.  Restricting them
+ *         is intended for testing and benchmarking.
+ *****************************************************************************/
+int ion_CRC_hw_accel(int features)
+{
+#ifdef CRC_HW_ACCEL
+    (void) crcHwFeatures();
+    crcHwEnabled = crcHwSupported & features;
+    return crcHwEnabled;
+#else
+    return 0;
+#endif
+}
+
 /******************************************************************************
  *
  * \par Function Name: ion_CRC16_1021_X25
@@ -423,6 +682,7 @@ static uint32_t  crctable_1EDC6F41_r[256] =
  *      4. crc type must be unsigned.
  *      5. init = 0xffff xorout = 0xffff
  *      6. check = 0x9063 (for input "123456789")
+ *      7. Uses PCLMULQDQ folding where supported; see ion_CRC_hw_accel.
  *****************************************************************************/
 uint16_t ion_CRC16_1021_X25(const char *data, uint32_t dLen, uint16_t crc)
 {
@@ -431,6 +691,18 @@ uint16_t ion_CRC16_1021_X25(const char *data, uint32_t dLen, uint16_t crc)
         
     uint16_t lcrc = ~crc;
     uint8_t  i;
+#ifdef CRC_HW_ACCEL
+    char     residue[16];
+    uint32_t folded;
+
+    if (dLen >= CRC_FOLD_MIN_LENGTH && (crcHwFeatures() & ION_CRC_PCLMUL))
+    {
+        folded = crcFold(&fold_1021_r, data, dLen, lcrc, residue);
+        lcrc = ~ion_CRC16_1021_X25(residue, sizeof residue, 0xFFFF);
+        data += folded;
+        dLen -= folded;
+    }
+#endif
 
     while(dLen--)
     {
@@ -503,6 +775,7 @@ uint32_t ion_CRC32_04C11DB7_bzip2(const char *data, uint32_t dLen, uint32_t crc)
  *      4. crc type must be unsigned.
  *      5. init = 0xffffffff xorout = 0xffffffff
  *      6. check = 0xcbf43926 (for input "123456789")
+ *      7. Uses PCLMULQDQ folding where supported; see ion_CRC_hw_accel.
  *****************************************************************************/ 
 uint32_t ion_CRC32_04C11DB7(const char *data, uint32_t dLen, uint32_t crc)
 {
@@ -511,6 +784,18 @@ uint32_t ion_CRC32_04C11DB7(const char *data, uint32_t dLen, uint32_t crc)
 
     uint32_t lcrc = ~crc;
     uint8_t  i;
+#ifdef CRC_HW_ACCEL
+    char     residue[16];
+    uint32_t folded;
+
+    if (dLen >= CRC_FOLD_MIN_LENGTH && (crcHwFeatures() & ION_CRC_PCLMUL))
+    {
+        folded = crcFold(&fold_04C11DB7_r, data, dLen, lcrc, residue);
+        lcrc = ~ion_CRC32_04C11DB7(residue, sizeof residue, 0xFFFFFFFF);
+        data += folded;
+        dLen -= folded;
+    }
+#endif
 
     while(dLen--)
     {
@@ -542,6 +827,8 @@ uint32_t ion_CRC32_04C11DB7(const char *data, uint32_t dLen, uint32_t crc)
  *      4. crc type must be unsigned.
  *      5. init = 0xffffffff xorout = 0xffffffff
  *      6. check = 0xe3069283 (for input "123456789")
+ *      7. Uses PCLMULQDQ folding and the SSE4.2 crc32 instruction where
+ *         supported; see ion_CRC_hw_accel.
  *****************************************************************************/ 
 uint32_t ion_CRC32_1EDC6F41_C(const char *data, uint32_t dLen, uint32_t crc)
 {
@@ -550,6 +837,21 @@ uint32_t ion_CRC32_1EDC6F41_C(const char *data, uint32_t dLen, uint32_t crc)
         
     uint32_t lcrc = ~crc;
     uint8_t  i;
+#ifdef CRC_HW_ACCEL
+    char     residue[16];
+    uint32_t folded;
+
+    if (dLen >= CRC_FOLD_MIN_LENGTH && (crcHwFeatures() & ION_CRC_PCLMUL))
+    {
+        folded = crcFold(&fold_1EDC6F41_r, data, dLen, lcrc, residue);
+        lcrc = ~ion_CRC32_1EDC6F41_C(residue, sizeof residue, 0xFFFFFFFF);
+        data += folded;
+        dLen -= folded;
+    }
+
+    if (crcHwFeatures() & ION_CRC_SSE42)
+        return crc32cSse42(data, dLen, ~lcrc);
+#endif
 
     while(dLen--)
     {
@@ -2768,7 +3070,7 @@ uint32_t crc32_16bytes(const char* data, uint32_t dLen, uint32_t crc, const uint
 	uint32_t	two;
 	uint32_t	three;
 	uint32_t	four;
-	const uint8_t*	currentChar = (const uint8_t*) current;
+	const uint8_t*	currentChar;
 
 	crc = ~crc; // same as previousCrc32 ^ 0xFFFFFFFF
 
@@ -2825,6 +3127,7 @@ uint32_t crc32_16bytes(const char* data, uint32_t dLen, uint32_t crc, const uint
 	}
 
 	// remaining 1 to 63 bytes (standard algorithm)
+	currentChar = (const uint8_t*) current;
 	while (dLen-- != 0)
 		crc = (crc >> 8) ^ crc32Lookup[0][(crc & 0xFF) ^ *currentChar++];
 
@@ -2833,12 +3136,43 @@ uint32_t crc32_16bytes(const char* data, uint32_t dLen, uint32_t crc, const uint
 
 uint32_t ion_CRC32_1EDC6F41_C_slice(const char *data, uint32_t dLen, uint32_t crc)
 {
+#ifdef CRC_HW_ACCEL
+	char		residue[16];
+	uint32_t	folded;
+
+	if (dLen >= CRC_FOLD_MIN_LENGTH && (crcHwFeatures() & ION_CRC_PCLMUL))
+	{
+		folded = crcFold(&fold_1EDC6F41_r, data, dLen, ~crc, residue);
+		crc = ion_CRC32_1EDC6F41_C_slice(residue, sizeof residue,
+				0xFFFFFFFF);
+		data += folded;
+		dLen -= folded;
+	}
+
+	if (crcHwFeatures() & ION_CRC_SSE42)
+	{
+		return crc32cSse42(data, dLen, crc);
+	}
+#endif
 	return crc32_16bytes(data, dLen, crc, crctable_1EDC6F41_r_slice);
 }
 
 
 uint32_t ion_CRC32_04C11DB7_slice(const char *data, uint32_t dLen, uint32_t crc)
 {
+#ifdef CRC_HW_ACCEL
+	char		residue[16];
+	uint32_t	folded;
+
+	if (dLen >= CRC_FOLD_MIN_LENGTH && (crcHwFeatures() & ION_CRC_PCLMUL))
+	{
+		folded = crcFold(&fold_04C11DB7_r, data, dLen, ~crc, residue);
+		crc = crc32_16bytes(residue, sizeof residue, 0xFFFFFFFF,
+				crctable_04C11DB7_r_slice);
+		data += folded;
+		dLen -= folded;
+	}
+#endif
 	return crc32_16bytes(data, dLen, crc, crctable_04C11DB7_r_slice);
 }
 
@@ -1089,6 +1089,7 @@ void	ionDetach()
 
 		/* 	Now detach from ION working memory */
 		PsmPartition	ionwm = _ionwm(NULL);
+		psm_flush_cache(ionwm);
 		sm_ShmDetach(ionwm->space);
 
 		/* 	Now reset the ION working memory database */
@@ -1107,7 +1108,7 @@ void	ionDetach()
 		/*	unregister call back 	*/
 		zco_unregister_callback();
 
-#if defined( SVR4_SEMAPHORES ) || defined( POSIX_NAMED_SEMAPHORES )
+#if defined( SVR4_SEMAPHORES ) || defined( POSIX_NAMED_SEMAPHORES ) || defined( FUTEX_SEMAPHORES )
 		/* Completes detaching from Ion 				*
 		 * Reset and detach from ipc semaphore set		*
 		 * only implemented for SVR4 platform and Posix Named Semaphores			*/
@@ -2533,40 +2534,57 @@ vast	ionAppendZcoExtent(Object zco, ZcoMedium source, Object location,
 	return result;
 }
 
-int	ionSendZcoByTCP(int *sock, Object zco, char *buffer, int buflen)
+int	ionSendZcoSpansByTCP(int *sock, ZcoReader *reader, int length,
+		char *buffer)
 {
 	Sdr		sdr = getIonsdr();
 	int		totalBytesSent = 0;
-	ZcoReader	reader;
-	uvast		bytesRemaining;
-	uvast		bytesToLoad;
-	int		bytesToSend;
+	ZcoFileSpan	span;
+	vast		bytesToSend;
+	int		fd;
 	int		bytesSent;
 
-	CHKERR(!(*sock < 0));
-	CHKERR(zco);
+	CHKERR(sock);
+	CHKERR(reader);
 	CHKERR(buffer);
-	CHKERR(buflen > 0);
-	zco_start_transmitting(zco, &reader);
-	zco_track_file_offset(&reader);
-	bytesRemaining = zco_length(sdr, zco);
-	while (bytesRemaining > 0)
+	CHKERR(length > 0);
+	while (length > 0)
 	{
+		/*	Bytes that are sourced from files are sent
+		 *	directly from those files; only all other
+		 *	bytes are copied into the buffer.		*/
+
 		CHKERR(sdr_begin_xn(sdr));
-		bytesToLoad = bytesRemaining;
-		if (bytesToLoad > buflen)
+		bytesToSend = zco_transmit_span(sdr, reader, length, buffer,
+				&span);
+		if (sdr_end_xn(sdr) < 0 || bytesToSend <= 0)
 		{
-			bytesToLoad = buflen;
+			putErrmsg("Incomplete zco_transmit.", NULL);
+			return -1;
 		}
 
-		bytesToSend = zco_transmit(sdr, &reader, bytesToLoad, buffer);
-		if (sdr_end_xn(sdr) < 0 || bytesToSend != bytesToLoad)
+		if (span.pathName[0] == '\0')
 		{
-			putErrmsg("Incomplete zco_transmit.", NULL);
-			return -1;
+			bytesSent = itcp_send(sock, buffer, bytesToSend);
+		}
+		else if ((fd = zco_file_span_fd(&span, bytesToSend)) < 0)
+		{
+			/*	The source file is missing or has
+			 *	changed.  As zco_transmit does, send
+			 *	fill in place of the file's data.	*/
+
+			writeMemoNote("[?] ZCO source file unreadable; \
+sending fill", span.pathName);
+			memset(buffer, ZCO_FILE_FILL_CHAR, bytesToSend);
+			bytesSent = itcp_send(sock, buffer, bytesToSend);
+		}
+		else
+		{
+			bytesSent = itcp_sendfile(sock, fd, span.offset,
+					bytesToSend);
+			close(fd);
 		}
 
-		bytesSent = itcp_send(sock, buffer, bytesToSend);
 		switch (bytesSent)
 		{
 		case -1:
@@ -2585,8 +2603,46 @@ int	ionSendZcoByTCP(int *sock, Object zco, char *buffer, int buflen)
 
 		default:
 			totalBytesSent += bytesSent;
-			bytesRemaining -= bytesSent;
+			length -= bytesSent;
+		}
+	}
+
+	return totalBytesSent;
+}
+
+int	ionSendZcoByTCP(int *sock, Object zco, char *buffer, int buflen)
+{
+	Sdr		sdr = getIonsdr();
+	int		totalBytesSent = 0;
+	ZcoReader	reader;
+	uvast		bytesRemaining;
+	int		bytesToSend;
+	int		bytesSent;
+
+	CHKERR(!(*sock < 0));
+	CHKERR(zco);
+	CHKERR(buffer);
+	CHKERR(buflen > 0);
+	zco_start_transmitting(zco, &reader);
+	zco_track_file_offset(&reader);
+	bytesRemaining = zco_length(sdr, zco);
+	while (bytesRemaining > 0)
+	{
+		bytesToSend = bytesRemaining;
+		if (bytesToSend > buflen)
+		{
+			bytesToSend = buflen;
+		}
+
+		bytesSent = ionSendZcoSpansByTCP(sock, &reader, bytesToSend,
+				buffer);
+		if (bytesSent < 1)
+		{
+			return bytesSent;
 		}
+
+		totalBytesSent += bytesSent;
+		bytesRemaining -= bytesSent;
 	}
 
 	return totalBytesSent;
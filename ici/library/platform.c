@@ -18,6 +18,10 @@
 #include <netinet/tcp.h>
 #endif
 
+#ifdef linux
+#include <sys/sendfile.h>
+#endif
+
 #define	ABORT_AS_REQD		if (_coreFileNeeded(NULL)) sm_Abort()
 
 void	icopy(char *fromPath, char *toPath)
@@ -3643,6 +3647,92 @@ int	itcp_send(int *sock, char *from, int length)
 	return totalBytesSent;
 }
 
+int	itcp_sendfile(int *sock, int fd, vast offset, int length)
+{
+	int	totalBytesSent = 0;
+	int	bytesToSend = length;
+	int	bytesSent;
+#ifdef linux
+	off_t	fileOffset = offset;
+#else
+	char	buffer[8192];
+	int	bytesRead;
+#endif
+
+	CHKERR(sock);
+	CHKERR(fd >= 0);
+	CHKERR(offset >= 0);
+	CHKERR(length > 0);
+#ifndef linux
+	if (lseek(fd, offset, SEEK_SET) < 0)
+	{
+		putSysErrmsg("Can't seek in file to send", itoa(fd));
+		return -1;
+	}
+#endif
+
+	/*	Send the data straight from the file, without first
+	 *	copying it into a user buffer, wherever the operating
+	 *	system supports this.					*/
+
+	while (bytesToSend > 0)
+	{
+		if (*sock == -1)	/*	Socket has been closed.	*/
+		{
+			return 0;
+		}
+
+#ifdef linux
+		bytesSent = sendfile(*sock, fd, &fileOffset, bytesToSend);
+		if (bytesSent == 0)
+		{
+			putErrmsg("File to send is truncated.", itoa(fd));
+			return -1;
+		}
+
+		if (bytesSent < 0)
+		{
+			switch (errno)
+			{
+			case EINTR:	/*	Interrupted; retry.	*/
+				continue;
+
+			case EPIPE:	/*	Lost connection.	*/
+			case EBADF:
+			case ETIMEDOUT:
+			case ECONNRESET:
+			case EHOSTUNREACH:
+				putSysErrmsg("sendfile error on TCP socket",
+						itoa(*sock));
+				return 0;
+			}
+
+			putSysErrmsg("sendfile error on TCP socket",
+					itoa(*sock));
+			return -1;
+		}
+#else
+		bytesRead = read(fd, buffer, bytesToSend < sizeof buffer ?
+				bytesToSend : sizeof buffer);
+		if (bytesRead <= 0)
+		{
+			putSysErrmsg("Can't read file to send", itoa(fd));
+			return -1;
+		}
+
+		bytesSent = itcp_send(sock, buffer, bytesRead);
+		if (bytesSent < 1)
+		{
+			return bytesSent;
+		}
+#endif
+		totalBytesSent += bytesSent;
+		bytesToSend -= bytesSent;
+	}
+
+	return totalBytesSent;
+}
+
 int	itcp_recv(int *sock, char *into, int length)
 {
 	int	totalBytesReceived = 0;
@@ -4206,6 +4206,492 @@ int	sm_SemUnwedge(sm_SemId i, int timeoutSeconds)
 
 
 
+#ifdef FUTEX_SEMAPHORES
+/* ---- Semaphore services (Linux futex) ---------------------	*/
+
+/*	The ICI semaphore table lives in a single SVR4 shared memory
+ *	segment, just as for SVR4 and Posix Named Semaphores, but
+ *	each semaphore is simply a 32-bit word in that table that
+ *	is operated on atomically.  Taking an available semaphore
+ *	and giving a semaphore that nobody is waiting for are each
+ *	a single atomic operation with no system call; the futex
+ *	system call is used only to block and to wake blocked
+ *	takers.  Semantics are those of the SVR4 implementation:
+ *	a semaphore is binary (giving a semaphore that is already
+ *	available has no effect), and the key, end, and unwedge
+ *	behavior are unchanged.						*/
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#ifndef SM_SEMTBLKEY
+#define SM_SEMTBLKEY	(0xee09)
+#endif
+
+/*	Each semaphore is padded to a cache line so that heavily
+ *	used semaphores (the SDR lock, for example) don't share a
+ *	line with other processes' wakeup semaphores.			*/
+
+typedef struct
+{
+	int		value;		/*	Futex word: 1 = available.	*/
+	int		waiters;	/*	Number of blocked takers.	*/
+	int		key;
+	char		inUse;
+	char		ended;
+} __attribute__((aligned(64))) SmFutexSem;
+
+typedef struct
+{
+	SmFutexSem	ipcLock;
+	unsigned int	ipcUniqueKey;
+	int		initialized;
+	SmFutexSem	semaphores[SEM_NSEMS_MAX];
+} SmFutexSemtable;
+
+/* for use internally for semaphore/shm routines called with a request to pick an unused key */
+static int _sm_GetUniqueKey_internal(SmFutexSemtable *semtable);
+
+static int	_futexWait(int *word, const struct timespec *timeout)
+{
+	return syscall(SYS_futex, word, FUTEX_WAIT, 0, timeout, NULL, 0);
+}
+
+static void	_futexWake(int *word)
+{
+	oK(syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0));
+}
+
+static void	_futexWakeAll(int *word)
+{
+	oK(syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0));
+}
+
+/*	Returns 0 on success, 1 on timeout, -1 on system error.  A
+ *	NULL deadline means wait indefinitely.  Note that the waiter
+ *	count is incremented before the futex word is re-checked by
+ *	the kernel and the giver sets the word before checking the
+ *	waiter count, so a give can never be lost between the two.
+ *	An ended semaphore is never waited on: the take succeeds, and
+ *	the caller learns from sm_SemEnded() that it has ended.  The
+ *	ended flag is read before the waiter count is decremented, so
+ *	once sm_SemDelete() sees no waiters no taker will touch the
+ *	semaphore's slot again.						*/
+
+static int	_futexTake(SmFutexSem *sem, struct timespec *deadline)
+{
+	int		expected;
+	struct timespec	now;
+	struct timespec	interval;
+	struct timespec	*timeout = NULL;
+	int		result;
+	int		ended;
+
+	while (1)
+	{
+		expected = 1;
+		if (__atomic_compare_exchange_n(&sem->value, &expected, 0, 0,
+				__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		{
+			return 0;	/*	Uncontended: no syscall.	*/
+		}
+
+		if (deadline)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			interval.tv_sec = deadline->tv_sec - now.tv_sec;
+			interval.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+			if (interval.tv_nsec < 0)
+			{
+				interval.tv_sec--;
+				interval.tv_nsec += 1000000000;
+			}
+
+			if (interval.tv_sec < 0)
+			{
+				return 1;
+			}
+
+			timeout = &interval;
+		}
+
+		oK(__atomic_add_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST));
+		if (__atomic_load_n(&sem->ended, __ATOMIC_SEQ_CST))
+		{
+			oK(__atomic_sub_fetch(&sem->waiters, 1,
+					__ATOMIC_SEQ_CST));
+			return 0;
+		}
+
+		result = _futexWait(&sem->value, timeout);
+		ended = __atomic_load_n(&sem->ended, __ATOMIC_SEQ_CST);
+		oK(__atomic_sub_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST));
+		if (ended)
+		{
+			return 0;
+		}
+
+		if (result < 0)
+		{
+			switch (errno)
+			{
+			case EAGAIN:	/*	Given before we blocked.	*/
+			case EINTR:
+				break;
+
+			case ETIMEDOUT:
+				return 1;
+
+			default:
+				return -1;
+			}
+		}
+	}
+}
+
+static void	_futexGive(SmFutexSem *sem)
+{
+	__atomic_store_n(&sem->value, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) > 0)
+	{
+		_futexWake(&sem->value);
+	}
+}
+
+static SmFutexSemtable	*_sembase(int action)
+{
+	static SmFutexSemtable	*semtable = NULL;
+	static uaddr		sembaseId = 0;
+	int			snoozeUsecs;
+
+	/* 	detach & reset, but not stopping	*/
+	if (action == IPC_ACTION_DETACH)
+	{
+		if (semtable != NULL)
+		{
+			oK(shmdt(semtable));
+		}
+
+		semtable = NULL;
+		sembaseId = 0;
+		return NULL;
+	}
+
+	if (action == IPC_ACTION_STOP)
+	{
+		if (semtable != NULL)
+		{
+			sm_ShmDestroy(sembaseId);
+			semtable = NULL;
+			sembaseId = 0;
+		}
+
+		return NULL;
+	}
+
+	if (semtable == NULL)
+	{
+		switch (sm_ShmAttach(SM_SEMTBLKEY, sizeof(SmFutexSemtable),
+				(char **) &semtable, &sembaseId))
+		{
+		case -1:
+			putErrmsg("Can't create semaphore table.", NULL);
+			semtable = NULL;
+			break;
+
+		case 0:		/*	Semaphore table exists.		*/
+
+			/*	As for Posix Named Semaphores, there is
+			 *	no lock yet with which to serialize table
+			 *	initialization, so wait for the creator.	*/
+
+			snoozeUsecs = 10000;
+			while (!__atomic_load_n(&semtable->initialized,
+					__ATOMIC_ACQUIRE))
+			{
+				microsnooze(snoozeUsecs);
+				snoozeUsecs *= 2;
+				if (snoozeUsecs > 10000000)
+				{
+					putErrmsg("Semaphore table never \
+initialized.", NULL);
+					oK(shmdt(semtable));
+					semtable = NULL;
+					break;
+				}
+			}
+
+			break;
+
+		default:	/*	New semaphore table.		*/
+			writeMemoNote("Initializing semaphores to use: futex - max",
+					itoa(SEM_NSEMS_MAX));
+			memset((char *) semtable, 0, sizeof(SmFutexSemtable));
+			semtable->ipcLock.value = 1;
+			semtable->ipcUniqueKey = UNIQUE_KEY_PROCESSES_INITIAL;
+			__atomic_store_n(&semtable->initialized, 1,
+					__ATOMIC_RELEASE);
+		}
+	}
+
+	return semtable;
+}
+
+int	sm_ipc_init()
+{
+	if (_sembase(IPC_ACTION_LOOKUP) == NULL)
+	{
+		putErrmsg("Can't initialize IPC.", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
+void	sm_ipc_stop()
+{
+	oK(_sembase(IPC_ACTION_STOP));
+}
+
+void 	sm_ipc_detach()
+{
+	oK(_sembase(IPC_ACTION_DETACH));
+}
+
+static void	takeIpcLock()
+{
+	SmFutexSemtable	*semtable = _sembase(IPC_ACTION_LOOKUP);
+
+	CHKVOID(semtable);
+	if (_futexTake(&semtable->ipcLock, NULL) < 0)
+	{
+		putSysErrmsg("takeIpcLock failed", NULL);
+	}
+}
+
+static void	giveIpcLock()
+{
+	SmFutexSemtable	*semtable = _sembase(IPC_ACTION_LOOKUP);
+
+	CHKVOID(semtable);
+	_futexGive(&semtable->ipcLock);
+}
+
+/* check if it's already been created by some ION process */
+/* assumes that IpcLock is held */
+static int	_semKeyExists(int key)
+{
+	SmFutexSemtable	*semtable = _sembase(IPC_ACTION_LOOKUP);
+	SmFutexSem	*sem;
+	int		i;
+
+	for (i = 0, sem = semtable->semaphores; i < SEM_NSEMS_MAX; i++, sem++)
+	{
+		if (sem->inUse && sem->key == key)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+sm_SemId	sm_SemCreate(int key, int semType)
+{
+	SmFutexSemtable	*semtable;
+	SmFutexSem	*sem;
+	int		i;
+
+	takeIpcLock();
+	semtable = _sembase(IPC_ACTION_LOOKUP);
+	if (semtable == NULL)
+	{
+		giveIpcLock();
+		putErrmsg("No semaphore table.", NULL);
+		return SM_SEM_NONE;
+	}
+
+	/*	If key is not specified, invent one.			*/
+
+	if (key == SM_NO_KEY)
+	{
+		key = _sm_GetUniqueKey_internal(semtable);
+	}
+	else   /* If key is specified, check if semaphore already exists */
+	{
+		for (i = 0, sem = semtable->semaphores; i < SEM_NSEMS_MAX;
+				i++, sem++)
+		{
+			if (sem->inUse && sem->key == key)
+			{
+				giveIpcLock();
+				return i;	/*	already created		*/
+			}
+		}
+	}
+
+	for (i = 0, sem = semtable->semaphores; i < SEM_NSEMS_MAX; i++, sem++)
+	{
+		if (sem->inUse)
+		{
+			continue;
+		}
+
+		sem->key = key;
+		sem->ended = 0;
+		sem->waiters = 0;
+		sem->inUse = 1;
+		_futexGive(sem);	/*	(First taker succeeds.)	*/
+		giveIpcLock();
+		return i;
+	}
+
+	giveIpcLock();
+	putErrmsg("Too many semaphores. Recompile to increase SEM_NSEMS_MAX",
+			itoa(SEM_NSEMS_MAX));
+	return SM_SEM_NONE;
+}
+
+static SmFutexSem	*_semGetSem(sm_SemId i)
+{
+	SmFutexSemtable	*semtable = _sembase(IPC_ACTION_LOOKUP);
+
+	CHKNULL(semtable);
+	CHKNULL(i >= 0);
+	CHKNULL(i < SEM_NSEMS_MAX);
+	return semtable->semaphores + i;
+}
+
+void	sm_SemDelete(sm_SemId i)
+{
+	SmFutexSem	*sem = _semGetSem(i);
+	int		tries;
+
+	CHKVOID(sem);
+	takeIpcLock();
+
+	/*	Release every task that is blocked on the semaphore
+	 *	before freeing its slot, so that none is left waiting
+	 *	on (or later takes) a semaphore created in that slot.
+	 *	A task that was killed while waiting is still counted
+	 *	as a waiter, so don't wait for the count forever.	*/
+
+	__atomic_store_n(&sem->ended, 1, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&sem->value, 1, __ATOMIC_SEQ_CST);
+	for (tries = 0; tries < 1000; tries++)
+	{
+		if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) == 0)
+		{
+			break;
+		}
+
+		_futexWakeAll(&sem->value);
+		microsnooze(1000);
+	}
+
+	sem->inUse = 0;
+	sem->key = SM_NO_KEY;
+	giveIpcLock();
+}
+
+int	sm_SemTake(sm_SemId i)
+{
+	SmFutexSem	*sem = _semGetSem(i);
+
+	CHKERR(sem);
+	if (!sem->inUse)	/*	semaphore deleted		*/
+	{
+		putErrmsg("Can't take deleted semaphore.", itoa(i));
+		return -1;
+	}
+
+	if (_futexTake(sem, NULL) < 0)
+	{
+		putSysErrmsg("Can't take semaphore", itoa(i));
+		return -1;
+	}
+
+	return 0;
+}
+
+void	sm_SemGive(sm_SemId i)
+{
+	SmFutexSem	*sem = _semGetSem(i);
+
+	CHKVOID(sem);
+	if (!sem->inUse)	/*	semaphore deleted		*/
+	{
+		return;
+	}
+
+	_futexGive(sem);
+}
+
+void	sm_SemEnd(sm_SemId i)
+{
+	SmFutexSem	*sem = _semGetSem(i);
+
+	CHKVOID(sem);
+	sem->ended = 1;
+	sm_SemGive(i);
+}
+
+int	sm_SemEnded(sm_SemId i)
+{
+	SmFutexSem	*sem = _semGetSem(i);
+	int		ended;
+
+	CHKZERO(sem);
+	ended = sem->ended;
+	if (ended)
+	{
+		sm_SemGive(i);	/*	Enable multiple tests.		*/
+	}
+
+	return ended;
+}
+
+void	sm_SemUnend(sm_SemId i)
+{
+	SmFutexSem	*sem = _semGetSem(i);
+
+	CHKVOID(sem);
+	sem->ended = 0;
+}
+
+int	sm_SemUnwedge(sm_SemId i, int timeoutSeconds)
+{
+	SmFutexSem	*sem = _semGetSem(i);
+	struct timespec	deadline;
+
+	CHKERR(sem);
+	if (!sem->inUse)	/*	semaphore deleted		*/
+	{
+		putErrmsg("Can't unwedge deleted semaphore.", itoa(i));
+		return -1;
+	}
+
+	/*	The futex wait takes a timeout directly, so unlike the
+	 *	SVR4 and Posix Named implementations no alarm signal
+	 *	is needed.						*/
+
+	if (timeoutSeconds < 1) timeoutSeconds = 1;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeoutSeconds;
+	if (_futexTake(sem, &deadline) < 0)
+	{
+		putSysErrmsg("Can't unwedge semaphore", itoa(i));
+		return -1;
+	}
+
+	_futexGive(sem);
+	return 0;
+}
+
+#endif /* FUTEX_SEMAPHORES */
+
+
+
 /************************ Unique IPC key services *****************************/
 
 #ifdef RTOS_SHM
@@ -4239,8 +4725,8 @@ sm_SemId	sm_GetTaskSemaphore(int taskId)
 #endif
 
 
-#if defined(POSIX_NAMED_SEMAPHORES) || defined(SVR4_SEMAPHORES)
-/* This is only for SVR4 / Posix Named Semaphores */
+#if defined(POSIX_NAMED_SEMAPHORES) || defined(SVR4_SEMAPHORES) || defined(FUTEX_SEMAPHORES)
+/* This is only for SVR4 / Posix Named / futex Semaphores */
 /*  Because we already have an ION-wide semaphore table shared by all ION instances and processes,
 	We will use that table to store a GLOBAL "unique" key, much like the RTEMS version does.  However
 	Because the ION code uses that key, this code ensures that it will not return a "unique" key
@@ -4255,6 +4741,8 @@ sm_SemId	sm_GetTaskSemaphore(int taskId)
 static int	_sm_GetUniqueKey_internal(
 #if defined(SVR4_SEMAPHORES)
 	SemaphoreBase	*sembase
+#elif defined(FUTEX_SEMAPHORES)
+	SmFutexSemtable	*sembase
 #else
 	SmProcessSemtable *sembase
 #endif
@@ -4267,6 +4755,8 @@ static int	_sm_GetUniqueKey_internal(
 	p_ipcUniqueKey = &sembase->ipcUniqueKey;				/* In semaphore structure for SVR4 */
 #elif defined(POSIX_NAMED_SEMAPHORES)
 	p_ipcUniqueKey = &sembase->semtablegl->ipcUniqueKey;	/* In semaphore structure for Posix Named Semaphores */
+#elif defined(FUTEX_SEMAPHORES)
+	p_ipcUniqueKey = &sembase->ipcUniqueKey;				/* In semaphore table for futex semaphores */
 #else
 #error _sm_GetUniqueKey_internal NOT updated to support this environment
 #endif
@@ -4304,6 +4794,8 @@ int	sm_GetUniqueKey()
 	int ret;
 #if defined(SVR4_SEMAPHORES)
 	SemaphoreBase	*sembase = _sembase(IPC_ACTION_LOOKUP);
+#elif defined(FUTEX_SEMAPHORES)
+	SmFutexSemtable	*sembase = _sembase(IPC_ACTION_LOOKUP);
 #else
 	SmProcessSemtable *sembase = _semTbl(IPC_ACTION_LOOKUP);
 #endif
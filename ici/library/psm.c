@@ -23,6 +23,13 @@
 #include "sptrace.h"
 #endif
 
+/*	The small-block cache is per process, so it is of no use where
+ *	all tasks share a single address space.				*/
+
+#if !defined (ION_LWT) && !defined (NO_PSM_CACHE) && defined (__GNUC__)
+#define	PSM_CACHE
+#endif
+
 #define	SMALL_BLOCK_OHD	(WORD_SIZE)
 #define	SMALL_BLK_LIMIT	(SMALL_SIZES * WORD_SIZE)
 
@@ -107,6 +114,47 @@ typedef struct
 	size_t		freeBytes;
 } LargeFreeBucket;
 
+#ifdef PSM_CACHE
+/*	Each process keeps, for each partition it uses, a cache of
+ *	free small-pool blocks of each size, so that most small
+ *	allocations and frees need not take the partition's lock
+ *	(which is shared by every process using the partition).  A
+ *	cached block is free -- its overhead word is the address of
+ *	the next block in the cache -- but it is on none of the
+ *	partition's free lists.  The cache is refilled from, and
+ *	drained back to, the partition's free lists in batches, and
+ *	it is limited both in the number of blocks of each size and
+ *	in the total size of the cached blocks.
+ *
+ *	The heads of each process's cache are retained in one of the
+ *	cache slots of the partition map, identified by the process
+ *	ID of the owning process, so that the blocks cached by a
+ *	process that terminates without flushing its cache (e.g.,
+ *	because it crashed) are not lost: whenever a process begins
+ *	managing the partition, the caches of all processes that no
+ *	longer exist are returned to the free lists.  Only the owning
+ *	process ever modifies a slot that is in use, except to
+ *	reclaim it.  The partition map also counts the cached blocks
+ *	of each size, so that psm_usage can report them.		*/
+
+#ifndef PSM_CACHE_SLOTS
+#define	PSM_CACHE_SLOTS		(16)	/*	Processes per partition.*/
+#endif
+
+typedef struct
+{
+	PsmAddress	firstBlock;
+	size_t		blocks;
+} CachedBucket;
+
+typedef struct
+{
+	int		ownerTask;	/*	0 if slot is unused.	*/
+	size_t		bytes;		/*	Total of cached blocks.	*/
+	CachedBucket	buckets[SMALL_SIZES];
+} PsmCacheSlot;
+#endif
+
 typedef struct			/*	Global view in shared memory.	*/
 {
 	PsmAddress	directory;
@@ -127,6 +175,10 @@ typedef struct			/*	Global view in shared memory.	*/
 	PsmAddress	endOfLargePool;
 	LargeFreeBucket	largePoolFree[LARGE_ORDERS];
 	size_t		unassignedSpace;
+#ifdef PSM_CACHE
+	size_t		smallPoolCached[SMALL_SIZES];
+	PsmCacheSlot	cacheSlots[PSM_CACHE_SLOTS];
+#endif
 } PartitionMap;
 
 typedef struct
@@ -135,6 +187,38 @@ typedef struct
 	PsmAddress	address;
 } PsmCatlgEntry;
 
+#ifdef PSM_CACHE
+#ifndef PSM_CACHE_LIMIT
+#define	PSM_CACHE_LIMIT		(16)	/*	Blocks per size.	*/
+#endif
+
+#ifndef PSM_CACHE_BATCH
+#define	PSM_CACHE_BATCH		(PSM_CACHE_LIMIT / 2)
+#endif
+
+#ifndef PSM_CACHE_MAX_BYTES
+#define	PSM_CACHE_MAX_BYTES	(32768)	/*	All sizes.		*/
+#endif
+
+#ifndef PSM_CACHE_PARTITIONS
+#define	PSM_CACHE_PARTITIONS	(4)
+#endif
+
+/*	Each process remembers which cache slot it occupies in each
+ *	partition it uses.						*/
+
+typedef struct
+{
+	char		*space;		/*	NULL if ref is unused.	*/
+	int		slotNbr;
+} PsmCacheRef;
+
+static pthread_mutex_t	cacheLock = PTHREAD_MUTEX_INITIALIZER;
+static PsmCacheRef	cacheRefs[PSM_CACHE_PARTITIONS];
+
+static void		reclaimCacheSlots(PartitionMap *map);
+#endif
+
 static char	*_outOfSpaceMsg()
 {
 	return "Not enough available memory.";
@@ -244,6 +328,11 @@ int	psm_manage(char *start, size_t length, char *name, PsmPartition *psmp,
 	{
 		*psmp = partition;
 		sm_SemUnwedge(map->semaphore, 3);
+#ifdef PSM_CACHE
+		lockPartition(map);
+		reclaimCacheSlots(map);
+		unlockPartition(map);
+#endif
 		*outcome = Redundant;
 		return 0;
 	}
@@ -325,6 +414,11 @@ actual name.", map->name);
 	map->ownerTask = -1;
 	map->depth = 0;
 	map->status = MANAGED;
+#ifdef PSM_CACHE
+	lockPartition(map);
+	reclaimCacheSlots(map);
+	unlockPartition(map);
+#endif
 	*psmp = partition;
 	*outcome = Okay;
 	return 0;
@@ -353,6 +447,8 @@ void	psm_unmanage(PsmPartition partition)
 	map = (PartitionMap *) (partition->space);
 	if (map->status == MANAGED)
 	{
+		psm_flush_cache(partition);
+
 	/*	Wait for partition to be no longer in use; unmanage.	*/
 
 		sm_SemTake(map->semaphore);
@@ -874,6 +970,328 @@ static void	traceMemo(const char *file, int line, PsmPartition partition,
 }
 #endif
 
+#ifdef PSM_CACHE
+#define	CACHED_BLOCK_SIZE(i)	(((size_t) (i) + 1) << SPACE_ORDER)
+
+/*	drainCacheSlot and reclaimCacheSlots must be called with the
+ *	partition locked.						*/
+
+static void	drainCacheSlot(PartitionMap *map, PsmCacheSlot *slot)
+{
+	CachedBucket		*bucket;
+	struct small_ohd	*blk;
+	int			i;
+
+	for (i = 0, bucket = slot->buckets; i < SMALL_SIZES; i++, bucket++)
+	{
+		if (bucket->blocks == 0)
+		{
+			continue;
+		}
+
+		blk = SMALL(bucket->firstBlock);
+		while (blk->next)
+		{
+			blk = SMALL(blk->next);
+		}
+
+		blk->next = map->smallPoolFree[i].firstFreeBlock;
+		map->smallPoolFree[i].firstFreeBlock = bucket->firstBlock;
+		map->smallPoolFree[i].freeBlocks += bucket->blocks;
+		oK(__atomic_sub_fetch(&map->smallPoolCached[i], bucket->blocks,
+				__ATOMIC_RELAXED));
+	}
+
+	memset((char *) slot, 0, sizeof(PsmCacheSlot));
+}
+
+static void	reclaimCacheSlots(PartitionMap *map)
+{
+	PsmCacheSlot	*slot;
+	int		i;
+
+	/*	Return to the free lists the blocks cached by all
+	 *	processes that have terminated.				*/
+
+	for (i = 0, slot = map->cacheSlots; i < PSM_CACHE_SLOTS; i++, slot++)
+	{
+		if (slot->ownerTask != 0 && !sm_TaskExists(slot->ownerTask))
+		{
+			drainCacheSlot(map, slot);
+		}
+	}
+}
+
+static int	ownsPartition(PartitionMap *map)
+{
+	return (map->ownerTask == sm_TaskIdSelf()
+		&& pthread_equal(map->ownerThread, pthread_self()));
+}
+
+static int	acquireCacheSlot(PartitionMap *map, int selfTask)
+{
+	int	vacancy = -1;
+	int	i;
+
+	/*	Must be called with the partition locked.  A slot
+	 *	that is still assigned to this process ID was left
+	 *	behind by an earlier process with the same ID; its
+	 *	blocks are just as usable by this process.		*/
+
+	for (i = 0; i < PSM_CACHE_SLOTS; i++)
+	{
+		if (map->cacheSlots[i].ownerTask == selfTask)
+		{
+			return i;
+		}
+
+		if (map->cacheSlots[i].ownerTask == 0 && vacancy < 0)
+		{
+			vacancy = i;
+		}
+	}
+
+	if (vacancy < 0)
+	{
+		reclaimCacheSlots(map);
+		for (i = 0; i < PSM_CACHE_SLOTS; i++)
+		{
+			if (map->cacheSlots[i].ownerTask == 0)
+			{
+				vacancy = i;
+				break;
+			}
+		}
+	}
+
+	if (vacancy >= 0)
+	{
+		map->cacheSlots[vacancy].ownerTask = selfTask;
+	}
+
+	return vacancy;
+}
+
+/*	findCache must be called with cacheLock held.			*/
+
+static PsmCacheSlot	*findCache(PsmPartition partition, PartitionMap *map,
+				int create)
+{
+	int		selfTask = sm_TaskIdSelf();
+	PsmCacheRef	*ref;
+	PsmCacheRef	*vacancy = NULL;
+	PsmCacheSlot	*slot;
+	int		slotNbr;
+	int		i;
+
+	for (i = 0, ref = cacheRefs; i < PSM_CACHE_PARTITIONS; i++, ref++)
+	{
+		if (ref->space == partition->space)
+		{
+			slot = map->cacheSlots + ref->slotNbr;
+			if (slot->ownerTask == selfTask)
+			{
+				return slot;
+			}
+
+			/*	The partition has been reinitialized
+			 *	since this slot was acquired, or this
+			 *	is a child process.			*/
+
+			ref->space = NULL;
+		}
+
+		if (ref->space == NULL && vacancy == NULL)
+		{
+			vacancy = ref;
+		}
+	}
+
+	if (vacancy == NULL || !create)
+	{
+		return NULL;
+	}
+
+	lockPartition(map);
+	slotNbr = acquireCacheSlot(map, selfTask);
+	unlockPartition(map);
+	if (slotNbr < 0)
+	{
+		return NULL;	/*	No cache for this process.	*/
+	}
+
+	vacancy->space = partition->space;
+	vacancy->slotNbr = slotNbr;
+	return map->cacheSlots + slotNbr;
+}
+
+static PsmAddress	takeCachedBlock(PsmPartition partition,
+				PartitionMap *map, int i)
+{
+	PsmCacheSlot		*cache;
+	CachedBucket		*bucket;
+	PsmAddress		block;
+	struct small_ohd	*blk;
+	size_t			count;
+
+	/*	Catalog functions allocate while holding the partition
+	 *	lock; cacheLock is never taken while holding it.	*/
+
+	if (ownsPartition(map))
+	{
+		return 0;
+	}
+
+	oK(pthread_mutex_lock(&cacheLock));
+	cache = findCache(partition, map, 1);
+	if (cache == NULL)
+	{
+		oK(pthread_mutex_unlock(&cacheLock));
+		return 0;
+	}
+
+	bucket = cache->buckets + i;
+	if (bucket->blocks == 0)
+	{
+		/*	Refill the cache with a batch of blocks from
+		 *	the head of the partition's free list, as
+		 *	many as the cache's size limit permits.		*/
+
+		count = 0;
+		lockPartition(map);
+		block = map->smallPoolFree[i].firstFreeBlock;
+		if (block && cache->bytes + CACHED_BLOCK_SIZE(i)
+				<= PSM_CACHE_MAX_BYTES)
+		{
+			bucket->firstBlock = block;
+			blk = SMALL(block);
+			count = 1;
+			while (count < PSM_CACHE_BATCH && blk->next
+			&& cache->bytes + ((count + 1) * CACHED_BLOCK_SIZE(i))
+					<= PSM_CACHE_MAX_BYTES)
+			{
+				blk = SMALL(blk->next);
+				count++;
+			}
+
+			map->smallPoolFree[i].firstFreeBlock = blk->next;
+			map->smallPoolFree[i].freeBlocks -= count;
+			blk->next = 0;
+			bucket->blocks = count;
+			cache->bytes += count * CACHED_BLOCK_SIZE(i);
+			oK(__atomic_add_fetch(&map->smallPoolCached[i], count,
+					__ATOMIC_RELAXED));
+		}
+
+		unlockPartition(map);
+		if (count == 0)
+		{
+			oK(pthread_mutex_unlock(&cacheLock));
+			return 0;
+		}
+	}
+
+	block = bucket->firstBlock;
+	blk = SMALL(block);
+	bucket->firstBlock = blk->next;
+	bucket->blocks--;
+	cache->bytes -= CACHED_BLOCK_SIZE(i);
+	blk->next = SMALL_IN_USE + i + 1;
+	oK(__atomic_sub_fetch(&map->smallPoolCached[i], 1, __ATOMIC_RELAXED));
+	oK(pthread_mutex_unlock(&cacheLock));
+	return block + SMALL_BLOCK_OHD;
+}
+
+static int	cacheBlock(PsmPartition partition, PartitionMap *map, int i,
+			PsmAddress block)
+{
+	PsmCacheSlot		*cache;
+	CachedBucket		*bucket;
+	PsmAddress		first;
+	struct small_ohd	*blk;
+	size_t			count;
+
+	if (ownsPartition(map))
+	{
+		return 0;
+	}
+
+	oK(pthread_mutex_lock(&cacheLock));
+	cache = findCache(partition, map, 1);
+	if (cache == NULL)
+	{
+		oK(pthread_mutex_unlock(&cacheLock));
+		return 0;
+	}
+
+	bucket = cache->buckets + i;
+	if (bucket->blocks >= PSM_CACHE_LIMIT)
+	{
+		/*	Drain a batch of blocks from the head of the
+		 *	cache back to the partition's free list.	*/
+
+		first = bucket->firstBlock;
+		blk = SMALL(first);
+		for (count = 1; count < PSM_CACHE_BATCH; count++)
+		{
+			blk = SMALL(blk->next);
+		}
+
+		bucket->firstBlock = blk->next;
+		bucket->blocks -= count;
+		cache->bytes -= count * CACHED_BLOCK_SIZE(i);
+		lockPartition(map);
+		blk->next = map->smallPoolFree[i].firstFreeBlock;
+		map->smallPoolFree[i].firstFreeBlock = first;
+		map->smallPoolFree[i].freeBlocks += count;
+		oK(__atomic_sub_fetch(&map->smallPoolCached[i], count,
+				__ATOMIC_RELAXED));
+		unlockPartition(map);
+	}
+
+	if (cache->bytes + CACHED_BLOCK_SIZE(i) > PSM_CACHE_MAX_BYTES)
+	{
+		oK(pthread_mutex_unlock(&cacheLock));
+		return 0;	/*	Cache is full.			*/
+	}
+
+	blk = SMALL(block);
+	blk->next = bucket->firstBlock;
+	bucket->firstBlock = block;
+	bucket->blocks++;
+	cache->bytes += CACHED_BLOCK_SIZE(i);
+	oK(__atomic_add_fetch(&map->smallPoolCached[i], 1, __ATOMIC_RELAXED));
+	oK(pthread_mutex_unlock(&cacheLock));
+	return 1;
+}
+#endif
+
+void	psm_flush_cache(PsmPartition partition)
+{
+#ifdef PSM_CACHE
+	PartitionMap	*map;
+	PsmCacheSlot	*cache;
+
+	CHKVOID(partition);
+	map = (PartitionMap *) (partition->space);
+	if (map->status != MANAGED)
+	{
+		return;
+	}
+
+	oK(pthread_mutex_lock(&cacheLock));
+	cache = findCache(partition, map, 0);
+	if (cache)
+	{
+		lockPartition(map);
+		drainCacheSlot(map, cache);
+		unlockPartition(map);
+	}
+
+	oK(pthread_mutex_unlock(&cacheLock));
+#endif
+}
+
 void	Psm_free(const char *file, int line, PsmPartition partition,
 		PsmAddress address)
 {
@@ -902,6 +1320,23 @@ void	Psm_free(const char *file, int line, PsmPartition partition,
 		return;
 	}
 
+#ifdef PSM_CACHE
+	if (address >= map->startOfSmallPool
+	&& address < map->endOfSmallPool)
+	{
+		block = address - SMALL_BLOCK_OHD;
+		smallBlk = SMALL(block);
+		if ((smallBlk->next) > SMALL_IN_USE
+		&& cacheBlock(partition, map,
+				(smallBlk->next - SMALL_IN_USE) - 1, block))
+		{
+#ifdef PSM_TRACE
+			traceFree(file, line, partition, address);
+#endif
+			return;
+		}
+	}
+#endif
 	lockPartition(map);
 	if (address >= map->startOfSmallPool
 	&& address < map->endOfSmallPool)
@@ -1191,6 +1626,21 @@ block size %lu", nbytes);
 	}
 
 	map = (PartitionMap *) (partition->space);
+#ifdef PSM_CACHE
+	if (nbytes <= SMALL_BLK_LIMIT)
+	{
+		i = ((nbytes + (SMALL_BLOCK_OHD - 1)) >> SPACE_ORDER) - 1;
+		block = takeCachedBlock(partition, map, i);
+		if (block)
+		{
+#ifdef PSM_TRACE
+			traceAlloc(file, line, partition, block,
+					(i + 1) << SPACE_ORDER);
+#endif
+			return block;
+		}
+	}
+#endif
 	lockPartition(map);
 	if (nbytes > SMALL_BLK_LIMIT)
 	{
@@ -1247,9 +1697,16 @@ void	psm_audit(PsmPartition partition)
 	int			blockCount;
 	PsmAddress		block;
 	struct small_ohd	*blk;
+#ifdef PSM_CACHE
+	PsmCacheSlot		*cache;
+	CachedBucket		*bucket;
+#endif
 
 	CHKVOID(partition);
 	map = (PartitionMap *) (partition->space);
+#ifdef PSM_CACHE
+	oK(pthread_mutex_lock(&cacheLock));
+#endif
 	lockPartition(map);
 	for (i = 0; i < SMALL_SIZES; i++)
 	{
@@ -1280,7 +1737,42 @@ void	psm_audit(PsmPartition partition)
 		}
 	}
 
+#ifdef PSM_CACHE
+	/*	Only this process's own cached blocks can be audited.	*/
+
+	cache = findCache(partition, map, 0);
+	for (i = 0; cache && i < SMALL_SIZES; i++)
+	{
+		bucket = cache->buckets + i;
+		blockCount = 0;
+		block = bucket->firstBlock;
+		while (block)
+		{
+			if (block < map->startOfSmallPool
+			|| block >= map->endOfSmallPool)
+			{
+				writeMemo("Small pool cache audit failed: next.");
+				abort();
+			}
+
+			blockCount++;
+			blk = SMALL(block);
+			block = blk->next;
+		}
+
+		if (blockCount != bucket->blocks
+		|| blockCount > __atomic_load_n(&map->smallPoolCached[i],
+				__ATOMIC_RELAXED))
+		{
+			writeMemo("Small pool cache audit failed: count.");
+			abort();
+		}
+	}
+#endif
 	unlockPartition(map);
+#ifdef PSM_CACHE
+	oK(pthread_mutex_unlock(&cacheLock));
+#endif
 }
 
 void	psm_usage(PsmPartition partition, PsmUsageSummary *usage)
@@ -1289,6 +1781,7 @@ void	psm_usage(PsmPartition partition, PsmUsageSummary *usage)
 	int		i;
 	size_t		size;
 	size_t		freeTotal;
+	size_t		cachedTotal;
 
 	CHKVOID(partition);
 	CHKVOID(usage);
@@ -1298,6 +1791,7 @@ void	psm_usage(PsmPartition partition, PsmUsageSummary *usage)
 	usage->partitionSize = map->partitionSize;
 	usage->smallPoolSize = map->endOfSmallPool - map->startOfSmallPool;
 	freeTotal = 0;
+	cachedTotal = 0;
 	size = 0;
 	for (i = 0; i < SMALL_SIZES; i++)
 	{
@@ -1305,8 +1799,21 @@ void	psm_usage(PsmPartition partition, PsmUsageSummary *usage)
 		usage->smallPoolFreeBlockCount[i] =
 				map->smallPoolFree[i].freeBlocks;
 		freeTotal += (map->smallPoolFree[i].freeBlocks * size);
+#ifdef PSM_CACHE
+		usage->smallPoolCachedBlockCount[i] =
+				__atomic_load_n(&map->smallPoolCached[i],
+				__ATOMIC_RELAXED);
+#else
+		usage->smallPoolCachedBlockCount[i] = 0;
+#endif
+		cachedTotal += (usage->smallPoolCachedBlockCount[i] * size);
 	}
 
+	/*	Blocks held in processes' caches are free, though each
+	 *	is available only to the process that caches it.	*/
+
+	usage->smallPoolCached = cachedTotal;
+	freeTotal += cachedTotal;
 	usage->smallPoolFree = freeTotal;
 	usage->smallPoolAllocated = usage->smallPoolSize - freeTotal;
 	usage->largePoolSize = map->endOfLargePool - map->startOfLargePool;
@@ -1349,6 +1856,27 @@ void	psm_report(PsmUsageSummary *usage)
 		}
 	}
 
+	if (usage->smallPoolCached > 0)
+	{
+		size = 0;
+		writeMemo("small pool cached blocks:");
+		for (i = 0; i < SMALL_SIZES; i++)
+		{
+			size += WORD_SIZE;
+			count = usage->smallPoolCachedBlockCount[i];
+			if (count > 0)
+			{
+				isprintf(textbuf, sizeof textbuf,
+					"    %10d of size %10ld", count, size);
+				writeMemo(textbuf);
+			}
+		}
+
+		isprintf(textbuf, sizeof textbuf,
+			"     total cached: %10ld", usage->smallPoolCached);
+		writeMemo(textbuf);
+	}
+
 	isprintf(textbuf, sizeof textbuf,
 			"       total avbl: %10ld", usage->smallPoolFree);
 	writeMemo(textbuf);
@@ -803,9 +803,12 @@ static PsmAddress	insertCXref(IonCXref *cxref)
 
 	if (cxref->type != CtRegistration && cxref->toTime > currentTime)
 	{
-		/*	Affects routes.					*/
+		/*	Affects routes.  A new contact might improve
+		 *	the route to any node, so all routes must be
+		 *	recomputed.					*/
 
 		getCurrentTime(&(vdb->lastEditTime));
+		vdb->lastResetTime = vdb->lastEditTime;
 	}
 
 	return cxaddr;
@@ -876,6 +879,8 @@ static void	deleteContact(PsmAddress cxaddr)
 	PsmAddress	nextElt;
 	PsmAddress	elt;
 	PsmAddress	citation;
+	PsmAddress	nodeAddr;
+	IonNode		*node;
 
 	cxref = (IonCXref *) psp(ionwm, cxaddr);
 
@@ -997,6 +1002,18 @@ static void	deleteContact(PsmAddress cxaddr)
 
 			citation = sm_list_data(ionwm, elt);
 			oK(sm_list_data_set(ionwm, citation, 0));
+
+			/*	The routes to the node for which
+			 *	the citing route was computed are
+			 *	no longer valid.			*/
+
+			nodeAddr = sm_list_user_data(ionwm,
+					sm_list_list(ionwm, citation));
+			if (nodeAddr)
+			{
+				node = (IonNode *) psp(ionwm, nodeAddr);
+				node->routesAreStale = 1;
+			}
 		}
 
 		sm_list_destroy(ionwm, cxref->citations, NULL, NULL);
@@ -1006,9 +1023,18 @@ static void	deleteContact(PsmAddress cxaddr)
 
 	if (cxref->type != CtRegistration && cxref->toTime > currentTime)
 	{
-		/*	Affects routes.					*/
+		/*	Affects routes.  Routes that cite the contact
+		 *	have been flagged above; no other route can
+		 *	be improved by the contact's removal.  But
+		 *	the local node's set of neighbors may have
+		 *	changed, so removal of a contact from the
+		 *	local node still voids all routes.		*/
 
 		getCurrentTime(&(vdb->lastEditTime));
+		if (cxref->fromNode == getOwnNodeNbr())
+		{
+			vdb->lastResetTime = vdb->lastEditTime;
+		}
 	}
 
 	sm_rbt_delete(ionwm, vdb->contactIndex, rfx_order_contacts, cxref,
@@ -2444,6 +2470,7 @@ static PsmAddress	insertRXref(IonRXref *rxref)
 	if (rxref->toTime > currentTime)	/*	Affects routes.	*/
 	{
 		getCurrentTime(&(vdb->lastEditTime));
+		vdb->lastResetTime = vdb->lastEditTime;
 	}
 
 	if (rxref->fromNode > rxref->toNode)
@@ -2832,6 +2859,7 @@ static void	deleteRange(PsmAddress rxaddr, int retainIfAsserted)
 	if (rxref->toTime > currentTime)	/*	Affects routes.	*/
 	{
 		getCurrentTime(&(vdb->lastEditTime));
+		vdb->lastResetTime = vdb->lastEditTime;
 	}
 
 	sm_rbt_delete(ionwm, vdb->rangeIndex, rfx_order_ranges, rxref,
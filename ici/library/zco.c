@@ -637,6 +637,255 @@ int	zco_enough_heap_space(Sdr sdr, vast length, ZcoAcct acct)
 	return (book->maxHeapOccupancy - increment) > 0;
 }
 
+/*	Each process keeps a small cache of open file descriptors
+ *	for the files that are the sources of ZCO file extents, so
+ *	that reading a file extent one segment at a time doesn't
+ *	require opening, checking, positioning, and closing the file
+ *	again for every segment.  Entries are keyed on path name and
+ *	inode number, so a file reference that has been revised to
+ *	cite a different file never matches a stale entry; since an
+ *	open descriptor keeps its inode allocated, no other file can
+ *	acquire that inode number while the entry exists.  An entry
+ *	is dropped when the file reference is revised or destroyed
+ *	in this process, when its file is found to have been removed
+ *	(possibly by another process), and when it is the least
+ *	recently used entry and room is needed for another file.	*/
+
+#ifndef ZCO_FD_CACHE_SIZE
+#define ZCO_FD_CACHE_SIZE	(8)
+#endif
+
+typedef struct
+{
+	int		fd;		/*	-1 if entry is unused.	*/
+	unsigned long	inode;
+	unsigned long	lastUse;	/*	For LRU eviction.	*/
+	char		pathName[256];
+} ZcoFdCacheEntry;
+
+typedef struct
+{
+	ResourceLock	lock;
+	unsigned long	useCount;
+	ZcoFdCacheEntry	entries[ZCO_FD_CACHE_SIZE];
+} ZcoFdCache;
+
+static ZcoFdCache	*_fdCache()
+{
+	static ZcoFdCache	cache;
+	static int		cacheInitialized = 0;
+	int			i;
+
+	if (!cacheInitialized)
+	{
+		if (initResourceLock(&cache.lock) < 0)
+		{
+			return NULL;
+		}
+
+		for (i = 0; i < ZCO_FD_CACHE_SIZE; i++)
+		{
+			cache.entries[i].fd = -1;
+		}
+
+		cacheInitialized = 1;
+	}
+
+	return &cache;
+}
+
+static void	forgetFileDescriptor(char *pathName, unsigned long inode)
+{
+	ZcoFdCache	*cache = _fdCache();
+	ZcoFdCacheEntry	*entry;
+	int		i;
+
+	if (cache == NULL)
+	{
+		return;
+	}
+
+	lockResource(&cache->lock);
+	for (i = 0, entry = cache->entries; i < ZCO_FD_CACHE_SIZE;
+			i++, entry++)
+	{
+		if (entry->fd != -1 && entry->inode == inode
+		&& strcmp(entry->pathName, pathName) == 0)
+		{
+			close(entry->fd);
+			entry->fd = -1;
+		}
+	}
+
+	unlockResource(&cache->lock);
+}
+
+static ZcoFdCacheEntry	*cachedFileDescriptor(ZcoFdCache *cache,
+				char *pathName, unsigned long inode)
+{
+	ZcoFdCacheEntry	*entry = NULL;
+	ZcoFdCacheEntry	*victim;
+	struct stat	statbuf;
+	int		fd;
+	int		i;
+
+	/*	Caller must hold the cache's lock.			*/
+
+	/*	Look for a cached descriptor for this file.		*/
+
+	victim = cache->entries;
+	for (i = 0; i < ZCO_FD_CACHE_SIZE; i++)
+	{
+		if (cache->entries[i].fd == -1)
+		{
+			if (victim->fd != -1)
+			{
+				victim = cache->entries + i;
+			}
+
+			continue;
+		}
+
+		if (cache->entries[i].inode == inode
+		&& strcmp(cache->entries[i].pathName, pathName) == 0)
+		{
+			entry = cache->entries + i;
+			break;
+		}
+
+		if (victim->fd != -1
+		&& cache->entries[i].lastUse < victim->lastUse)
+		{
+			victim = cache->entries + i;
+		}
+	}
+
+	if (entry)
+	{
+		/*	A file that has been removed can't be read
+		 *	through its path name any longer, so stop
+		 *	holding it open.				*/
+
+		if (fstat(entry->fd, &statbuf) < 0 || statbuf.st_nlink == 0)
+		{
+			close(entry->fd);
+			entry->fd = -1;
+			victim = entry;
+			entry = NULL;
+		}
+	}
+
+	if (entry == NULL)	/*	Must open the file.		*/
+	{
+		/*	Meanwhile, stop holding open any other cached
+		 *	files that have been removed.			*/
+
+		for (i = 0; i < ZCO_FD_CACHE_SIZE; i++)
+		{
+			if (cache->entries[i].fd != -1
+			&& (fstat(cache->entries[i].fd, &statbuf) < 0
+				|| statbuf.st_nlink == 0))
+			{
+				close(cache->entries[i].fd);
+				cache->entries[i].fd = -1;
+				victim = cache->entries + i;
+			}
+		}
+
+		fd = iopen(pathName, O_RDONLY, 0);
+		if (fd < 0)
+		{
+			return NULL;
+		}
+
+		if (fstat(fd, &statbuf) < 0 || statbuf.st_ino != inode)
+		{
+			close(fd);	/*	Can't check, or changed.*/
+			return NULL;
+		}
+
+		closeOnExec(fd);
+		entry = victim;
+		if (entry->fd != -1)
+		{
+			close(entry->fd);
+		}
+
+		entry->fd = fd;
+		entry->inode = inode;
+		istrcpy(entry->pathName, pathName, sizeof entry->pathName);
+	}
+
+	entry->lastUse = ++(cache->useCount);
+	return entry;
+}
+
+static int	readFromFile(FileRef *fileRef, vast offset, char *buffer,
+			vast length)
+{
+	ZcoFdCache	*cache = _fdCache();
+	ZcoFdCacheEntry	*entry;
+	int		bytesRead;
+
+	if (cache == NULL)
+	{
+		return -1;
+	}
+
+	lockResource(&cache->lock);
+	entry = cachedFileDescriptor(cache, fileRef->pathName, fileRef->inode);
+	if (entry == NULL)
+	{
+		unlockResource(&cache->lock);
+		return -1;
+	}
+
+#ifdef unix
+	bytesRead = pread(entry->fd, buffer, length, offset);
+#else
+	if (lseek(entry->fd, offset, SEEK_SET) < 0)
+	{
+		bytesRead = -1;
+	}
+	else
+	{
+		bytesRead = read(entry->fd, buffer, length);
+	}
+#endif
+	unlockResource(&cache->lock);
+	return bytesRead;
+}
+
+int	zco_file_span_fd(ZcoFileSpan *span, vast length)
+{
+	ZcoFdCache	*cache = _fdCache();
+	ZcoFdCacheEntry	*entry;
+	struct stat	statbuf;
+	int		fd = -1;
+
+	CHKERR(span);
+	CHKERR(span->pathName[0] != '\0');
+	if (cache == NULL)
+	{
+		return -1;
+	}
+
+	/*	The cached descriptor is duplicated rather than lent,
+	 *	so that another thread may evict or close the cache
+	 *	entry while the caller is still using the file.	*/
+
+	lockResource(&cache->lock);
+	entry = cachedFileDescriptor(cache, span->pathName, span->inode);
+	if (entry && fstat(entry->fd, &statbuf) == 0
+	&& statbuf.st_size >= span->offset + length)
+	{
+		fd = dup(entry->fd);
+	}
+
+	unlockResource(&cache->lock);
+	return fd;
+}
+
 Object	zco_create_file_ref(Sdr sdr, char *pathName, char *cleanupScript,
 		 ZcoAcct acct)
 {
@@ -772,6 +1021,7 @@ int	zco_revise_file_ref(Sdr sdr, Object fileRefObj, char *pathName,
 
 	close(sourceFd);
 	sdr_stage(sdr, (char *) &fileRef, fileRefObj, sizeof(FileRef));
+	forgetFileDescriptor(fileRef.pathName, fileRef.inode);
 	fileRef.inode = statbuf.st_ino;
 	memcpy(fileRef.pathName, pathName, pathLen);
 	fileRef.pathName[pathLen] = '\0';
@@ -825,6 +1075,7 @@ static void	destroyFileReference(Sdr sdr, FileRef *fileRef,
 	/*	Destroy the file reference.  Invoke file cleanup
 	 *	script if provided.					*/
 
+	forgetFileDescriptor(fileRef->pathName, fileRef->inode);
 	sdr_free(sdr, fileRefObj);
 	if (fileRef->unlinkOnDestroy)
 	{
@@ -2847,9 +3098,7 @@ static int	copyFromSource(Sdr sdr, char *buffer, SourceExtent *extent,
 	BulkRef		bulkRef;
 	ZcoFileLien	fileLien;
 	FileRef		fileRef;
-	int		fd;
 	int		bytesRead;
-	struct stat	statbuf;
 	unsigned long	xmitProgress = 0;
 
 	switch (extent->sourceMedium)
@@ -2881,43 +3130,20 @@ static int	copyFromSource(Sdr sdr, char *buffer, SourceExtent *extent,
 				sizeof(ZcoFileLien));
 		sdr_stage(sdr, (char *) &fileRef, fileLien.location,
 				sizeof(FileRef));
-		fd = iopen(fileRef.pathName, O_RDONLY, 0);
-		if (fd >= 0)
+		bytesRead = readFromFile(&fileRef, extent->offset
+				+ bytesToSkip, buffer, bytesAvbl);
+		if (bytesRead == bytesAvbl)
 		{
-			if (fstat(fd, &statbuf) < 0)
-			{
-				close(fd);	/*	Can't check.	*/
-			}
-			else if (statbuf.st_ino != fileRef.inode)
-			{
-				close(fd);	/*	File changed.	*/
-			}
-			else if (lseek(fd, extent->offset + bytesToSkip,
-					SEEK_SET) < 0)
-			{
-				close(fd);	/*	Can't position.	*/
-			}
-			else
+			/*	Update xmit progress.			*/
+
+			if (xmitProgress > fileRef.xmitProgress)
 			{
-				bytesRead = read(fd, buffer, bytesAvbl);
-				close(fd);
-				if (bytesRead == bytesAvbl)
-				{
-					/*	Update xmit progress.	*/
-
-					if (xmitProgress > fileRef.xmitProgress)
-					{
-						fileRef.xmitProgress
-							= xmitProgress;
-						sdr_write(sdr,
-							fileLien.location,
-							(char *) &fileRef,
-							sizeof(FileRef));
-					}
-
-					return bytesAvbl;
-				}
+				fileRef.xmitProgress = xmitProgress;
+				sdr_write(sdr, fileLien.location,
+					(char *) &fileRef, sizeof(FileRef));
 			}
+
+			return bytesAvbl;
 		}
 
 		/*	On any problem reading from file, write fill
@@ -3091,6 +3317,120 @@ vast	zco_transmit(Sdr sdr, ZcoReader *reader, vast length, char *buffer)
 	return bytesTransmitted;
 }
 
+vast	zco_transmit_span(Sdr sdr, ZcoReader *reader, vast length,
+		char *buffer, ZcoFileSpan *span)
+{
+	Zco		zco;
+	vast		bytesToSkip;
+	vast		bytesToCopy = 0;
+	Object		obj;
+	Capsule		capsule;
+	SourceExtent	extent;
+	vast		bytesAvbl;
+	ZcoFileLien	fileLien;
+	FileRef		fileRef;
+	unsigned long	xmitProgress;
+
+	CHKERR(sdr);
+	CHKERR(reader);
+	CHKERR(length >= 0);
+	CHKERR(buffer);
+	CHKERR(span);
+	span->pathName[0] = '\0';
+	if (length == 0)
+	{
+		return 0;
+	}
+
+	sdr_read(sdr, (char *) &zco, reader->zco, sizeof(Zco));
+	bytesToSkip = reader->lengthCopied;
+
+	/*	Header data is never file-sourced.			*/
+
+	for (obj = zco.firstHeader; obj; obj = capsule.nextCapsule)
+	{
+		sdr_read(sdr, (char *) &capsule, obj, sizeof(Capsule));
+		if (bytesToSkip >= capsule.length)
+		{
+			bytesToSkip -= capsule.length;
+			continue;
+		}
+
+		bytesToCopy += capsule.length - bytesToSkip;
+		bytesToSkip = 0;
+	}
+
+	/*	Find the first file-sourced extent at or after the
+	 *	reader's current position.				*/
+
+	for (obj = zco.firstExtent; obj; obj = extent.nextExtent)
+	{
+		if (bytesToCopy >= length)
+		{
+			break;
+		}
+
+		sdr_read(sdr, (char *) &extent, obj, sizeof(SourceExtent));
+		if (bytesToSkip >= extent.length)
+		{
+			bytesToSkip -= extent.length;
+			continue;
+		}
+
+		if (extent.sourceMedium != ZcoFileSource)
+		{
+			bytesToCopy += extent.length - bytesToSkip;
+			bytesToSkip = 0;
+			continue;
+		}
+
+		if (bytesToCopy > 0)
+		{
+			break;	/*	Copy the preceding bytes first.	*/
+		}
+
+		/*	Next byte is file-sourced: report the span.	*/
+
+		bytesAvbl = extent.length - bytesToSkip;
+		if (bytesAvbl > length)
+		{
+			bytesAvbl = length;
+		}
+
+		sdr_read(sdr, (char *) &fileLien, extent.location,
+				sizeof(ZcoFileLien));
+		sdr_stage(sdr, (char *) &fileRef, fileLien.location,
+				sizeof(FileRef));
+		istrcpy(span->pathName, fileRef.pathName,
+				sizeof span->pathName);
+		span->inode = fileRef.inode;
+		span->offset = extent.offset + bytesToSkip;
+		if (reader->trackFileOffset)
+		{
+			xmitProgress = span->offset + bytesAvbl;
+			if (xmitProgress > fileRef.xmitProgress)
+			{
+				fileRef.xmitProgress = xmitProgress;
+				sdr_write(sdr, fileLien.location,
+					(char *) &fileRef, sizeof(FileRef));
+			}
+		}
+
+		reader->lengthCopied += bytesAvbl;
+		return bytesAvbl;
+	}
+
+	/*	No file-sourced data before the end of this span;
+	 *	trailer data is never file-sourced.			*/
+
+	if (obj == 0 || bytesToCopy > length)
+	{
+		bytesToCopy = length;
+	}
+
+	return zco_transmit(sdr, reader, bytesToCopy, buffer);
+}
+
 /*	Functions for delivery to overlying protocol or application
  *	layer.								*/
 
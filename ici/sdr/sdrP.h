@@ -23,6 +23,7 @@
 #include "psm.h"
 #include "lyst.h"
 #include "smlist.h"
+#include "smrbt.h"
 #include "sdrxn.h"
 
 #ifdef SDR_TRACE
@@ -44,6 +45,78 @@
 
 #define	INITIALIZED	(0x99999999)
 
+/*	Group commit limits.  When SDR_GROUP_COMMIT is configured,
+ *	deferred dataspace file updates are flushed at the end of
+ *	the first transaction after which any one of these limits
+ *	has been reached.  Elapsed time is in milliseconds.  GAP
+ *	is the largest clean stretch of the heap that may be
+ *	bridged in order to merge two dirty extents into a single
+ *	write, when the heap is also resident in DRAM.
+ *
+ *	Deferred updates to a heap that is not resident in memory
+ *	are held in SDR working memory, so the byte limit is also
+ *	capped at 1/SDR_GC_WM_SHARE of the size of the working
+ *	memory partition; merging an update into the extents it
+ *	touches briefly takes as much again.				*/
+
+#ifndef SDR_GC_MAX_BYTES
+#define	SDR_GC_MAX_BYTES	(1024 * 1024)
+#endif
+#ifndef SDR_GC_WM_SHARE
+#define	SDR_GC_WM_SHARE		(8)
+#endif
+#ifndef SDR_GC_MAX_EXTENTS
+#define	SDR_GC_MAX_EXTENTS	(1024)
+#endif
+#ifndef SDR_GC_MAX_LOG
+#define	SDR_GC_MAX_LOG		(4 * 1024 * 1024)
+#endif
+#ifndef SDR_GC_MAX_LATENCY
+#define	SDR_GC_MAX_LATENCY	(100)
+#endif
+#ifndef SDR_GC_GAP
+#define	SDR_GC_GAP		(512)
+#endif
+#ifndef SDR_GC_MAX_IOV
+#define	SDR_GC_MAX_IOV		(64)
+#endif
+
+#define	GROUP_COMMIT(sdr)	(((sdr)->configFlags & \
+(SDR_IN_FILE | SDR_GROUP_COMMIT)) == (SDR_IN_FILE | SDR_GROUP_COMMIT))
+
+/*	When SDR_MAPPED is configured for an SDR whose heap resides
+ *	in a file but not in DRAM, each process maps the dataspace
+ *	file into its own address space and accesses the heap as if
+ *	it were resident in DRAM.  Memory-mapped files are supported
+ *	only on UNIX platforms; elsewhere SDR_MAPPED is ignored.	*/
+
+#ifdef unix
+#include <sys/mman.h>
+#define	HEAP_MAPPED(sdr)	(((sdr)->configFlags & \
+(SDR_IN_DRAM | SDR_IN_FILE | SDR_MAPPED)) == (SDR_IN_FILE | SDR_MAPPED))
+#else
+#define	HEAP_MAPPED(sdr)	(0)
+#endif
+
+/*	Maximum number of tasks that may be in shared (read-only)
+ *	transactions on a single SDR at any one time.  A task that
+ *	begins a shared transaction when this limit has been reached
+ *	gets an exclusive transaction instead.				*/
+
+#ifndef SDR_MAX_READERS
+#define	SDR_MAX_READERS		(32)
+#endif
+
+typedef struct
+{
+	int		readerTask;		/*	Task ID.	*/
+	pthread_t	readerThread;		/*	Thread ID.	*/
+	int		depth;			/*	0 = unused.	*/
+} SdrReader;
+
+#define	HEAP_IN_MEMORY(sdr)	(((sdr)->configFlags & SDR_IN_DRAM) \
+|| HEAP_MAPPED(sdr))
+
 /*	Memory management abstraction.					*/
 #define MTAKE(size)	allocFromSdrMemory(__FILE__, __LINE__, size)
 #define MRELEASE(addr)	releaseToSdrMemory(__FILE__, __LINE__, addr)
@@ -91,6 +164,21 @@ typedef struct sdr_str
 	int		logLength;		/*	All entries.	*/
 	int		maxLogLength;		/*	Max Log Length  */
 	PsmAddress	logEntries;		/*	Offsets in log.	*/
+	size_t		xnLogStart;	/*	Log length at begin.	*/
+
+		/*	Shared (read-only) transactions.	*/
+
+	sm_SemId	sdrTurnstile;	/*	Pending writer blocks.	*/
+	sm_SemId	readersSemaphore;	/*	For readers.	*/
+	int		readersCount;
+	SdrReader	readers[SDR_MAX_READERS];
+
+		/*	Group commit state.			*/
+
+	PsmAddress	dirtyExtents;	/*	SmRbt of DirtyExtents	*/
+	size_t		dirtyBytes;
+	size_t		maxDirtyBytes;
+	struct timeval	groupStartTime;	/*	Oldest dirty extent.	*/
 
 		/*	SDR trace data access.			*/
 
@@ -108,6 +196,22 @@ typedef struct sdr_str
 	time_t		restartTime;
 } SdrState;
 
+/*	A DirtyExtent is a range of the dataspace that has been
+ *	updated since the last group commit flush.  Dirty extents
+ *	never overlap.  When the SDR heap is resident in DRAM the
+ *	extent's data are flushed from the heap image in DRAM, so
+ *	no copy of the data is retained; when the dataspace file
+ *	is mapped into memory the extent's pages are simply written
+ *	back to the file (msync).  Otherwise the data are a block of SDR
+ *	working memory.							*/
+
+typedef struct
+{
+	Address		start;
+	size_t		length;
+	PsmAddress	data;		/*	0 if heap in memory.	*/
+} DirtyExtent;
+
 typedef struct
 {
 	Address		firstFreeBlock;
@@ -22,11 +22,23 @@
 #include "lyst.h"
 #include "sdrxn.h"
 
+#ifdef linux
+#include <sys/uio.h>
+typedef struct iovec	DsSegment;
+#else
+typedef struct
+{
+	void		*iov_base;
+	size_t		iov_len;
+} DsSegment;
+#endif
+
 #ifndef SDR_SEMKEY
 #define SDR_SEMKEY	(0xeee0)
 #endif
 
 static PsmPartition	_sdrwm(sm_WmParms *parms);
+static void		endReaderSemaphores(SdrState *sdr);
 
 #ifndef SDR_TRACE
 char	*_noTraceMsg()
@@ -191,6 +203,8 @@ static SdrControlHeader	*_sch(SdrControlHeader **schp)
 					sm_SemDelete(sdr->sdrSemaphore);
 					sdr->sdrSemaphore = SM_SEM_NONE;
 				}
+
+				endReaderSemaphores(sdr);
 			}
 
 			sm_SemGive(lock);
@@ -401,7 +415,7 @@ SdrMap	*_mapImage(Sdr sdrv)
 {
 	static SdrMap	map;
 
-	if (sdrv->sdr->configFlags & SDR_IN_DRAM)
+	if (HEAP_IN_MEMORY(sdrv->sdr))
 	{
 		return (SdrMap *) (sdrv->dssm);
 	}
@@ -412,17 +426,164 @@ SdrMap	*_mapImage(Sdr sdrv)
 
 /*	*	Mutual exclusion functions	*	*	*	*/
 
-static int	lockSdr(SdrState *sdr)
+/*	The SDR's transaction semaphore is held either by the one task
+	that is in an exclusive transaction or, collectively, by all
+	tasks that are in shared (read-only) transactions: the first
+	reader to begin a shared transaction takes the semaphore and
+	the last reader to end one gives it.  A task seeking to begin
+	an exclusive transaction first takes the SDR's "turnstile"
+	semaphore and holds it until it has the transaction semaphore;
+	every reader passes through the turnstile before joining the
+	readers, so no new reader can join while a writer is waiting
+	and writers can't be starved by a steady stream of readers.	*/
+
+static SdrReader	*findReader(SdrState *sdr)
+{
+	int		task;
+	pthread_t	thread;
+	int		i;
+	SdrReader	*reader;
+
+	if (sdr->readersCount == 0)
+	{
+		return NULL;
+	}
+
+	task = sm_TaskIdSelf();
+	thread = pthread_self();
+	for (i = 0, reader = sdr->readers; i < SDR_MAX_READERS; i++, reader++)
+	{
+		if (reader->depth > 0 && reader->readerTask == task
+		&& pthread_equal(reader->readerThread, thread))
+		{
+			return reader;
+		}
+	}
+
+	return NULL;
+}
+
+static int	joinReaders(SdrState *sdr)
 {
-	if (sm_SemTake(sdr->sdrSemaphore) < 0)
+	int		i;
+	SdrReader	*reader;
+
+	/*	Wait for any writer that's ahead of us to finish.	*/
+
+	if (sm_SemTake(sdr->sdrTurnstile) < 0)
+	{
+		return -1;
+	}
+
+	sm_SemGive(sdr->sdrTurnstile);
+	if (sm_SemTake(sdr->readersSemaphore) < 0)
 	{
 		return -1;
 	}
 
+	for (i = 0, reader = sdr->readers; i < SDR_MAX_READERS; i++, reader++)
+	{
+		if (reader->depth == 0)
+		{
+			break;
+		}
+	}
+
+	if (i == SDR_MAX_READERS)
+	{
+		sm_SemGive(sdr->readersSemaphore);
+		return 0;		/*	No room for reader.	*/
+	}
+
+	if (sdr->readersCount == 0)
+	{
+		if (sm_SemTake(sdr->sdrSemaphore) < 0)
+		{
+			sm_SemGive(sdr->readersSemaphore);
+			return -1;
+		}
+	}
+
+	sdr->readersCount++;
+	reader->readerTask = sm_TaskIdSelf();
+	reader->readerThread = pthread_self();
+	reader->depth = 1;
+	sm_SemGive(sdr->readersSemaphore);
+	return 1;
+}
+
+static void	leaveReaders(SdrState *sdr, SdrReader *reader)
+{
+	if (reader->depth > 1)
+	{
+		reader->depth--;
+		return;
+	}
+
+	oK(sm_SemTake(sdr->readersSemaphore));
+	reader->depth = 0;
+	sdr->readersCount--;
+	if (sdr->readersCount == 0 && sdr->sdrSemaphore != -1)
+	{
+		sm_SemGive(sdr->sdrSemaphore);
+	}
+
+	sm_SemGive(sdr->readersSemaphore);
+}
+
+static void	endReaderSemaphores(SdrState *sdr)
+{
+	if (sdr->sdrTurnstile != SM_SEM_NONE)
+	{
+		sm_SemEnd(sdr->sdrTurnstile);
+		sm_SemDelete(sdr->sdrTurnstile);
+		sdr->sdrTurnstile = SM_SEM_NONE;
+	}
+
+	if (sdr->readersSemaphore != SM_SEM_NONE)
+	{
+		sm_SemEnd(sdr->readersSemaphore);
+		sm_SemDelete(sdr->readersSemaphore);
+		sdr->readersSemaphore = SM_SEM_NONE;
+	}
+}
+
+static int	lockSdr(SdrState *sdr)
+{
+	/*	The turnstile only keeps new readers from getting
+	 *	ahead of a writer that is waiting for the SDR.  Readers
+	 *	wait only while the SDR is held, so when it is held
+	 *	neither by a writer nor by readers the writer is
+	 *	unlikely to wait at all and takes the SDR directly.	*/
+
+	if (sdr->sdrOwnerTask == -1 && sdr->readersCount == 0)
+	{
+		if (sm_SemTake(sdr->sdrSemaphore) < 0)
+		{
+			return -1;
+		}
+	}
+	else
+	{
+		if (sm_SemTake(sdr->sdrTurnstile) < 0)
+		{
+			return -1;
+		}
+
+		if (sm_SemTake(sdr->sdrSemaphore) < 0)
+		{
+			sm_SemGive(sdr->sdrTurnstile);
+			return -1;
+		}
+
+		sm_SemGive(sdr->sdrTurnstile);
+	}
+
 	sdr->sdrOwnerThread = pthread_self();
 	sdr->sdrOwnerTask = sm_TaskIdSelf();
 	sdr->xnDepth = 1;
 	sdr->modified = 0;
+	sdr->xnLogStart = sdr->logLength;
 	return 0;
 }
 
@@ -441,6 +602,13 @@ int	takeSdr(SdrState *sdr)
 		return 0;		/*	Already taken.		*/
 	}
 
+	if (findReader(sdr))
+	{
+		putErrmsg("Can't begin transaction in a shared transaction.",
+				NULL);
+		return -1;		/*	Would deadlock.		*/
+	}
+
 	return lockSdr(sdr);
 }
 
@@ -462,96 +630,718 @@ void	releaseSdr(SdrState *sdr)
 		sdr->xnDepth--;
 		if (sdr->xnDepth == 0)
 		{
-			unlockSdr(sdr);
+			unlockSdr(sdr);
+		}
+	}
+}
+
+/*	*	SDR system administration functions	*	*	*/
+
+int	Sdr_initialize(size_t wmSize, char *wmPtr, int wmKey, char *wmName)
+{
+	sm_SemId	lock;
+	sm_WmParms	wmparms;
+	PsmPartition	sdrwm;
+
+	/*	Initialize the shared-memory libraries as necessary.	*/
+
+	if (sm_ipc_init())
+	{
+		putErrmsg("Can't initialize IPC system.", NULL);
+		return -1;	/*	Crash if can't initialize sm.	*/
+	}
+
+	lock = _sdrlock(0);
+	if (lock == SM_SEM_NONE || sm_SemTake(lock) < 0)
+	{
+		putErrmsg("Can't initialize SDR system.", NULL);
+		return -1;	/*	Crash if can't lock sdr.	*/
+	}
+
+	/*	Attach to SDR's own shared working memory partition.	*/
+
+	if (_sdrwm(NULL) != NULL)	/*	Already initialized.	*/
+        {
+		sm_SemGive(lock);
+		return 0;
+	}
+
+	if (wmName == NULL)
+	{
+		wmName = _SdrWmName();
+	}
+
+	wmparms.wmKey = wmKey;
+	wmparms.wmSize = wmSize;
+	wmparms.wmAddress = wmPtr;
+	wmparms.wmName = wmName;
+	sdrwm = _sdrwm(&wmparms);
+	sm_SemGive(lock);
+	if (sdrwm == NULL)
+	{
+		putErrmsg("Can't open SDR working memory.", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
+void	sdr_wm_usage(PsmUsageSummary *usage)
+{
+	CHKVOID(usage);
+	psm_usage(_sdrwm(NULL), usage);
+}
+
+void	sdr_shutdown()		/*	Ends SDR service on machine.	*/
+{
+	sm_WmParms	wmparms;
+
+	if (_sdrwm(NULL) != NULL)
+	{
+		wmparms.wmKey = 0;
+		wmparms.wmSize = 0;
+		wmparms.wmAddress = NULL;
+ 		wmparms.wmName = NULL;
+		oK(_sdrwm(&wmparms));
+	}
+
+	_sdrlock(1);		/*	Delete SDR system semaphore.	*/
+}
+
+int	_xniEnd(const char *fileName, int lineNbr, const char *arg, Sdr sdrv)
+{
+	_postErrmsg(fileName, lineNbr,
+			"Assertion failed, SDR transaction canceled.", arg);
+	writeErrmsgMemos();
+	crashXn(sdrv);
+	if (_coreFileNeeded(NULL))
+	{
+		sm_Abort();
+	}
+
+	return 1;
+}
+
+/*	*	Group commit functions	*	*	*	*	*/
+
+/*	When an SDR is configured for group commit and its heap
+	resides in a file, updates to the dataspace file are not
+	written at the moment they are made.  Instead, each update
+	is noted in a red-black tree of "dirty extents" in SDR
+	working memory; extents that overlap are merged as they are
+	noted.  If the heap is not also resident in DRAM, the new
+	data are retained in each dirty extent (and are overlaid on
+	all data subsequently read from the file); otherwise the
+	data are simply copied from the DRAM image of the heap when
+	the extents are flushed, so abutting extents are merged as
+	well.
+
+	Dirty extents are flushed to the dataspace file in address
+	order, each run of abutting (or, if the heap is in DRAM,
+	nearly abutting) extents in a single vectored write, at the
+	end of the first transaction after which any one of the
+	group commit limits has been reached: number of dirty bytes,
+	number of dirty extents, length of the log, or time elapsed
+	since the oldest unflushed update.  So the dataspace file
+	updates of many consecutive transactions, by any number of
+	tasks, are normally committed in a single flush.
+
+	When the transaction log is written to a file, it is not
+	truncated at the end of each transaction but only after each
+	flush: it accumulates the log entries of all transactions in
+	the group, so that after an unplanned power cycle the
+	dataspace file can be restored to its state as of the last
+	completed flush.  Transactions ended since that flush are
+	lost in that event; group commit trades that window of
+	exposure for a large reduction in file system traffic.
+
+	When the dataspace file is mapped into memory (SDR_MAPPED),
+	updates are written to the file simply by copying them into
+	the mapped image: like write(), that puts them in the file's
+	pages in the system page cache, so they survive the crash of
+	any task.  Dirty extents are then noted only for group
+	commit, and flushing a dirty extent is a matter of writing
+	the mapped pages back to the file synchronously (msync with
+	MS_SYNC), so that each group flush is durable.			*/
+
+static int	logIsRetained(SdrState *sdr)
+{
+	return (GROUP_COMMIT(sdr) && (sdr->configFlags & SDR_REVERSIBLE)
+			&& sdr->logSize == 0);
+}
+
+static int	orderDirtyExtents(PsmPartition partition, PsmAddress nodeData,
+			void *dataBuffer)
+{
+	DirtyExtent	*extent;
+	Address		*start;
+
+	extent = (DirtyExtent *) psp(partition, nodeData);
+	start = (Address *) dataBuffer;
+	if (extent->start < *start)
+	{
+		return -1;
+	}
+
+	if (extent->start > *start)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+static void	deleteDirtyExtent(PsmPartition partition, PsmAddress nodeData,
+			void *arg)
+{
+	DirtyExtent	*extent;
+
+	extent = (DirtyExtent *) psp(partition, nodeData);
+	if (extent->data)
+	{
+		psm_free(partition, extent->data);
+	}
+
+	psm_free(partition, nodeData);
+}
+
+static int	extentTouches(DirtyExtent *extent, Address start, Address end,
+			int abutting)
+{
+	if (abutting)
+	{
+		return (extent->start <= end
+			&& extent->start + extent->length >= start);
+	}
+
+	return (extent->start < end && extent->start + extent->length > start);
+}
+
+static PsmAddress	firstDirtyExtent(PsmPartition sdrwm, PsmAddress rbt,
+				Address start, int abutting)
+{
+	PsmAddress	node;
+	PsmAddress	successor;
+	PsmAddress	prevNode;
+	DirtyExtent	*extent;
+
+	/*	Returns the node of the earliest dirty extent that
+	 *	might touch an extent beginning at "start": either
+	 *	the one that spans (or, if "abutting", ends at) that
+	 *	address or else the first one that begins at or
+	 *	after it.						*/
+
+	node = sm_rbt_search(sdrwm, rbt, orderDirtyExtents, &start,
+			&successor);
+	if (node == 0)
+	{
+		node = successor;
+	}
+
+	if (node)
+	{
+		prevNode = sm_rbt_prev(sdrwm, node);
+	}
+	else
+	{
+		prevNode = sm_rbt_last(sdrwm, rbt);
+	}
+
+	if (prevNode)
+	{
+		extent = (DirtyExtent *) psp(sdrwm, sm_rbt_data(sdrwm,
+				prevNode));
+		if (extentTouches(extent, start, start, abutting))
+		{
+			return prevNode;
+		}
+	}
+
+	return node;
+}
+
+static int	noteDirtyExtent(SdrState *sdr, Address start, char *from,
+			size_t length)
+{
+	PsmPartition	sdrwm = _sdrwm(NULL);
+	int		retainData = !HEAP_IN_MEMORY(sdr);
+	Address		end = start + length;
+	Address		mergedStart = start;
+	Address		mergedEnd = end;
+	PsmAddress	firstNode;
+	PsmAddress	node;
+	DirtyExtent	*extent;
+	DirtyExtent	*firstExtent = NULL;
+	PsmAddress	extentAddr;
+	PsmAddress	dataAddr = 0;
+	char		*data = NULL;
+	Address		key;
+
+	if (sm_rbt_length(sdrwm, sdr->dirtyExtents) == 0)
+	{
+		getCurrentTime(&sdr->groupStartTime);
+	}
+
+	/*	Determine the extent of the merger, if any.  Abutting
+	 *	extents are merged only when the data need not be
+	 *	retained, i.e., when flushing a merged extent doesn't
+	 *	entail copying the data.				*/
+
+	firstNode = firstDirtyExtent(sdrwm, sdr->dirtyExtents, start,
+			!retainData);
+	for (node = firstNode; node; node = sm_rbt_next(sdrwm, node))
+	{
+		extent = (DirtyExtent *) psp(sdrwm, sm_rbt_data(sdrwm, node));
+		if (!extentTouches(extent, start, end, !retainData))
+		{
+			break;
+		}
+
+		if (firstExtent == NULL)
+		{
+			firstExtent = extent;
+			if (extent->start <= start
+			&& extent->start + extent->length >= end)
+			{
+				/*	Update is within an extent
+				 *	that is already dirty.		*/
+
+				if (retainData)
+				{
+					memcpy(((char *) psp(sdrwm,
+						extent->data))
+						+ (start - extent->start),
+						from, length);
+				}
+
+				return 0;
+			}
+		}
+
+		if (extent->start < mergedStart)
+		{
+			mergedStart = extent->start;
+		}
+
+		if (extent->start + extent->length > mergedEnd)
+		{
+			mergedEnd = extent->start + extent->length;
+		}
+	}
+
+	if (retainData)
+	{
+		dataAddr = psm_malloc(sdrwm, mergedEnd - mergedStart);
+		if (dataAddr == 0)
+		{
+			return -1;
+		}
+
+		data = (char *) psp(sdrwm, dataAddr);
+	}
+
+	if (firstExtent == NULL)
+	{
+		/*	No merger, so add a new dirty extent.		*/
+
+		extentAddr = psm_malloc(sdrwm, sizeof(DirtyExtent));
+		if (extentAddr == 0)
+		{
+			if (dataAddr)
+			{
+				psm_free(sdrwm, dataAddr);
+			}
+
+			return -1;
+		}
+
+		extent = (DirtyExtent *) psp(sdrwm, extentAddr);
+		extent->start = start;
+		extent->length = length;
+		extent->data = dataAddr;
+		if (sm_rbt_insert(sdrwm, sdr->dirtyExtents, extentAddr,
+				orderDirtyExtents, &start) == 0)
+		{
+			deleteDirtyExtent(sdrwm, extentAddr, NULL);
+			return -1;
+		}
+
+		if (data)
+		{
+			memcpy(data, from, length);
+		}
+
+		sdr->dirtyBytes += length;
+		return 0;
+	}
+
+	/*	Merge all touching extents into the first one, which
+	 *	retains its position in the tree: it can't precede
+	 *	any earlier extent, as they don't touch the update.	*/
+
+	if (data)
+	{
+		memcpy(data + (firstExtent->start - mergedStart),
+				(char *) psp(sdrwm, firstExtent->data),
+				firstExtent->length);
+	}
+
+	sdr->dirtyBytes -= firstExtent->length;
+	while (1)
+	{
+		node = sm_rbt_search(sdrwm, sdr->dirtyExtents,
+				orderDirtyExtents, &firstExtent->start, NULL);
+		node = sm_rbt_next(sdrwm, node);
+		if (node == 0)
+		{
+			break;
+		}
+
+		extent = (DirtyExtent *) psp(sdrwm, sm_rbt_data(sdrwm, node));
+		if (!extentTouches(extent, start, end, !retainData))
+		{
+			break;
+		}
+
+		if (data)
+		{
+			memcpy(data + (extent->start - mergedStart),
+				(char *) psp(sdrwm, extent->data),
+				extent->length);
+		}
+
+		sdr->dirtyBytes -= extent->length;
+		key = extent->start;
+		sm_rbt_delete(sdrwm, sdr->dirtyExtents, orderDirtyExtents,
+				&key, deleteDirtyExtent, NULL);
+	}
+
+	if (data)
+	{
+		memcpy(data + (start - mergedStart), from, length);
+		psm_free(sdrwm, firstExtent->data);
+		firstExtent->data = dataAddr;
+	}
+
+	firstExtent->start = mergedStart;
+	firstExtent->length = mergedEnd - mergedStart;
+	sdr->dirtyBytes += firstExtent->length;
+	return 0;
+}
+
+static void	overlayDirtyExtents(SdrState *sdr, char *into, Address from,
+			size_t length)
+{
+	PsmPartition	sdrwm = _sdrwm(NULL);
+	Address		end = from + length;
+	PsmAddress	node;
+	DirtyExtent	*extent;
+	Address		overlayStart;
+	Address		overlayEnd;
+
+	for (node = firstDirtyExtent(sdrwm, sdr->dirtyExtents, from, 0);
+			node; node = sm_rbt_next(sdrwm, node))
+	{
+		extent = (DirtyExtent *) psp(sdrwm, sm_rbt_data(sdrwm, node));
+		if (extent->start >= end)
+		{
+			break;
+		}
+
+		overlayStart = MAX(extent->start, from);
+		overlayEnd = MIN(extent->start + extent->length, end);
+		memcpy(into + (overlayStart - from), ((char *) psp(sdrwm,
+				extent->data)) + (overlayStart - extent->start),
+				overlayEnd - overlayStart);
+	}
+}
+
+static int	writeDsSegments(int dsfile, Address offset, DsSegment *segments,
+			int segmentsCount)
+{
+#ifdef linux
+	size_t	length = 0;
+	ssize_t	bytesWritten;
+	int	i;
+
+	for (i = 0; i < segmentsCount; i++)
+	{
+		length += segments[i].iov_len;
+	}
+
+	while (1)
+	{
+		bytesWritten = pwritev(dsfile, segments, segmentsCount, offset);
+		if (bytesWritten < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		break;
+	}
+
+	if (bytesWritten < 0 || bytesWritten < length)
+	{
+		return -1;
+	}
+#else
+	int	i;
+
+	if (lseek(dsfile, offset, SEEK_SET) < 0)
+	{
+		return -1;
+	}
+
+	for (i = 0; i < segmentsCount; i++)
+	{
+		if (write(dsfile, segments[i].iov_base, segments[i].iov_len)
+				< segments[i].iov_len)
+		{
+			return -1;
+		}
+	}
+#endif
+	return 0;
+}
+
+static int	syncDsImage(char *dssm, Address offset, size_t length)
+{
+#ifdef unix
+	static uaddr	pageSize = 0;
+	uaddr		pageOffset;
+
+	/*	msync() must start on a page boundary; the mapped
+	 *	image of the dataspace file is page-aligned.		*/
+
+	if (pageSize == 0)
+	{
+		pageSize = (uaddr) sysconf(_SC_PAGESIZE);
+	}
+
+	pageOffset = offset % pageSize;
+	return msync(dssm + (offset - pageOffset), length + pageOffset,
+			MS_SYNC);
+#else
+	return 0;
+#endif
+}
+
+static int	flushDirtyExtents(SdrState *sdr, int dsfile, char *dssm)
+{
+	PsmPartition	sdrwm = _sdrwm(NULL);
+	DsSegment	segments[SDR_GC_MAX_IOV];
+	int		segmentsCount;
+	PsmAddress	node;
+	DirtyExtent	*extent;
+	Address		runStart;
+	Address		runEnd;
+
+	if (sdr->dirtyExtents == 0)
+	{
+		return 0;
+	}
+
+	node = sm_rbt_first(sdrwm, sdr->dirtyExtents);
+	while (node)
+	{
+		extent = (DirtyExtent *) psp(sdrwm, sm_rbt_data(sdrwm, node));
+		runStart = extent->start;
+		runEnd = runStart;
+		segmentsCount = 0;
+		if (dssm)
+		{
+			/*	Heap image in DRAM is authoritative,
+			 *	and clean bytes between two dirty
+			 *	extents are identical in DRAM and
+			 *	in the file, so nearby extents can
+			 *	be written in a single run.		*/
+
+			while (node)
+			{
+				extent = (DirtyExtent *) psp(sdrwm,
+					sm_rbt_data(sdrwm, node));
+				if (extent->start - runEnd > SDR_GC_GAP
+				&& runEnd > runStart)
+				{
+					break;
+				}
+
+				runEnd = extent->start + extent->length;
+				node = sm_rbt_next(sdrwm, node);
+			}
+
+			if (HEAP_MAPPED(sdr))
+			{
+				if (syncDsImage(dssm, runStart,
+						runEnd - runStart) < 0)
+				{
+					putSysErrmsg("Can't sync dataspace \
+image with file", itoa(runEnd - runStart));
+					return -1;
+				}
+
+				continue;
+			}
+
+			segments[0].iov_base = dssm + runStart;
+			segments[0].iov_len = runEnd - runStart;
+			segmentsCount = 1;
+		}
+		else
+		{
+			while (node && segmentsCount < SDR_GC_MAX_IOV)
+			{
+				extent = (DirtyExtent *) psp(sdrwm,
+					sm_rbt_data(sdrwm, node));
+				if (extent->start != runEnd)
+				{
+					break;
+				}
+
+				segments[segmentsCount].iov_base =
+					psp(sdrwm, extent->data);
+				segments[segmentsCount].iov_len =
+					extent->length;
+				segmentsCount++;
+				runEnd += extent->length;
+				node = sm_rbt_next(sdrwm, node);
+			}
+		}
+
+		if (writeDsSegments(dsfile, runStart, segments, segmentsCount)
+				< 0)
+		{
+			putSysErrmsg("Can't flush dirty extents to dataspace",
+					itoa(runEnd - runStart));
+			return -1;
 		}
 	}
-}
 
-/*	*	SDR system administration functions	*	*	*/
+	sm_rbt_clear(sdrwm, sdr->dirtyExtents, deleteDirtyExtent, NULL);
+	sdr->dirtyBytes = 0;
+	return 0;
+}
 
-int	Sdr_initialize(size_t wmSize, char *wmPtr, int wmKey, char *wmName)
+static int	groupCommitDue(SdrState *sdr)
 {
-	sm_SemId	lock;
-	sm_WmParms	wmparms;
-	PsmPartition	sdrwm;
+	PsmPartition	sdrwm = _sdrwm(NULL);
+	size_t		extentsCount;
+	struct timeval	now;
+	long		elapsed;
 
-	/*	Initialize the shared-memory libraries as necessary.	*/
+	extentsCount = sm_rbt_length(sdrwm, sdr->dirtyExtents);
+	if (extentsCount == 0)
+	{
+		/*	Nothing to flush, but discard the log if
+		 *	possible.					*/
 
-	if (sm_ipc_init())
+		return (logIsRetained(sdr) && sdr->logLength > 0);
+	}
+
+	if (sdr->dirtyBytes >= sdr->maxDirtyBytes
+	|| extentsCount >= SDR_GC_MAX_EXTENTS
+	|| (logIsRetained(sdr) && sdr->logLength >= SDR_GC_MAX_LOG))
 	{
-		putErrmsg("Can't initialize IPC system.", NULL);
-		return -1;	/*	Crash if can't initialize sm.	*/
+		return 1;
 	}
 
-	lock = _sdrlock(0);
-	if (lock == SM_SEM_NONE || sm_SemTake(lock) < 0)
+	getCurrentTime(&now);
+	elapsed = ((now.tv_sec - sdr->groupStartTime.tv_sec) * 1000)
+		+ ((now.tv_usec - sdr->groupStartTime.tv_usec) / 1000);
+	return (elapsed >= SDR_GC_MAX_LATENCY);
+}
+
+static int	writeToDs(SdrState *sdr, int dsfile, char *dssm, Address into,
+			char *from, size_t length)
+{
+	int	mapped = (HEAP_MAPPED(sdr) && dssm != NULL);
+
+	if (mapped && from != dssm + into)
 	{
-		putErrmsg("Can't initialize SDR system.", NULL);
-		return -1;	/*	Crash if can't lock sdr.	*/
+		/*	Writing to the mapped image of the file
+		 *	is writing to the file.				*/
+
+		memcpy(dssm + into, from, length);
 	}
 
-	/*	Attach to SDR's own shared working memory partition.	*/
+	if (sdr->dirtyExtents)
+	{
+		/*	Flush the deferred updates before noting this
+		 *	one if it would take them past the byte limit,
+		 *	so that a merger never has to allocate beyond
+		 *	that limit while the merged extents are still
+		 *	held.  An update that exceeds the limit on its
+		 *	own is simply written through.			*/
 
-	if (_sdrwm(NULL) != NULL)	/*	Already initialized.	*/
-        {
-		sm_SemGive(lock);
-		return 0;
+		if (sdr->dirtyBytes + length > sdr->maxDirtyBytes
+		&& sdr->dirtyBytes > 0)
+		{
+			if (flushDirtyExtents(sdr, dsfile, dssm) < 0)
+			{
+				return -1;
+			}
+		}
+
+		if (length <= sdr->maxDirtyBytes
+		&& noteDirtyExtent(sdr, into, from, length) == 0)
+		{
+			return 0;
+		}
+
+		/*	Can't defer this update (it's too large, or
+		 *	SDR working memory is exhausted), so flush
+		 *	all deferred updates and then write through.	*/
+
+		if (flushDirtyExtents(sdr, dsfile, dssm) < 0)
+		{
+			return -1;
+		}
 	}
 
-	if (wmName == NULL)
+	if (mapped)
 	{
-		wmName = _SdrWmName();
+		if (sdr->dirtyExtents)	/*	Writing through.	*/
+		{
+			return syncDsImage(dssm, into, length);
+		}
+
+		return 0;
 	}
 
-	wmparms.wmKey = wmKey;
-	wmparms.wmSize = wmSize;
-	wmparms.wmAddress = wmPtr;
-	wmparms.wmName = wmName;
-	sdrwm = _sdrwm(&wmparms);
-	sm_SemGive(lock);
-	if (sdrwm == NULL)
+	if (lseek(dsfile, into, SEEK_SET) < 0
+	|| write(dsfile, from, length) < length)
 	{
-		putErrmsg("Can't open SDR working memory.", NULL);
 		return -1;
 	}
 
 	return 0;
 }
 
-void	sdr_wm_usage(PsmUsageSummary *usage)
-{
-	CHKVOID(usage);
-	psm_usage(_sdrwm(NULL), usage);
-}
-
-void	sdr_shutdown()		/*	Ends SDR service on machine.	*/
+static int	readFromDs(Sdr sdrv, char *into, Address from, size_t length)
 {
-	sm_WmParms	wmparms;
+#ifdef unix
+	/*	Positioned read, as the tasks of a single process that
+	 *	are in concurrent shared transactions share the file
+	 *	descriptor and therefore its file offset.		*/
 
-	if (_sdrwm(NULL) != NULL)
+	if (pread(sdrv->dsfile, into, length, from) != length)
 	{
-		wmparms.wmKey = 0;
-		wmparms.wmSize = 0;
-		wmparms.wmAddress = NULL;
- 		wmparms.wmName = NULL;
-		oK(_sdrwm(&wmparms));
+		return -1;
 	}
+#else
+	if (lseek(sdrv->dsfile, from, SEEK_SET) < 0
+	|| read(sdrv->dsfile, into, length) < length)
+	{
+		return -1;
+	}
+#endif
 
-	_sdrlock(1);		/*	Delete SDR system semaphore.	*/
-}
-
-int	_xniEnd(const char *fileName, int lineNbr, const char *arg, Sdr sdrv)
-{
-	_postErrmsg(fileName, lineNbr,
-			"Assertion failed, SDR transaction canceled.", arg);
-	writeErrmsgMemos();
-	crashXn(sdrv);
-	if (_coreFileNeeded(NULL))
+	if (sdrv->sdr->dirtyExtents && sdrv->dssm == NULL)
 	{
-		sm_Abort();
+		overlayDirtyExtents(sdrv->sdr, into, from, length);
 	}
 
-	return 1;
+	return 0;
 }
 
 /*	*	Transaction utility functions	*	*	*	*/
@@ -640,6 +1430,15 @@ static int	reverseTransaction(SdrState *sdr, int logfile, char *logsm,
 			elt = sm_list_prev(sdrwm, elt))
 	{
 		logEntryOffset = (uaddr) sm_list_data(sdrwm, elt);
+		if (logEntryOffset < sdr->xnLogStart)
+		{
+			/*	Log entry was written by a prior
+			 *	transaction in the current commit
+			 *	group; not to be reversed.		*/
+
+			break;
+		}
+
 		length = sizeof logEntryControl;
 		if (readFromLog(logfile, logsm, logEntryOffset,
 				(char *) logEntryControl, length, sdr) < 0)
@@ -667,10 +1466,9 @@ static int	reverseTransaction(SdrState *sdr, int logfile, char *logsm,
 			{
 				/*	Use dataspace in sm as buffer.	*/
 
-				if (lseek(dsfile, logEntryControl[0], SEEK_SET)
-						< 0
-				|| write(dsfile, dssm + logEntryControl[0],
-						length) < length)
+				if (writeToDs(sdr, dsfile, dssm,
+					logEntryControl[0], dssm
+					+ logEntryControl[0], length) < 0)
 				{
 					putSysErrmsg("Can't reverse log entry",
 							NULL);
@@ -699,9 +1497,8 @@ static int	reverseTransaction(SdrState *sdr, int logfile, char *logsm,
 					return -1;
 				}
 
-				if (lseek(dsfile, logEntryControl[0], SEEK_SET)
-						< 0
-				|| write(dsfile, buf, length) < length)
+				if (writeToDs(sdr, dsfile, dssm,
+					logEntryControl[0], buf, length) < 0)
 				{
 					putSysErrmsg("Can't reverse log entry",
 							NULL);
@@ -713,13 +1510,16 @@ static int	reverseTransaction(SdrState *sdr, int logfile, char *logsm,
 			}
 		}
 
-		sdr->logLength -= (sizeof(logEntryControl) + length);
+		if (!logIsRetained(sdr))
+		{
+			sdr->logLength -= (sizeof(logEntryControl) + length);
+		}
 	}
 
 	return 0;
 }
 
-static void	clearTransaction(Sdr sdrv)
+static void	resetLog(Sdr sdrv)
 {
 	char	logfilename[PATHLENMAX + 1 + 32 + 1 + 6 + 1];
 
@@ -746,13 +1546,36 @@ static void	clearTransaction(Sdr sdrv)
 		}
 	}
 
+	sdrv->sdr->logLength = 0;
+	sm_list_clear(_sdrwm(NULL), sdrv->sdr->logEntries, NULL, NULL);
+}
+
+static void	clearTransaction(Sdr sdrv)
+{
+	SdrState	*sdr = sdrv->sdr;
+
 	if (sdrv->knownObjects)
 	{
 		lyst_clear(sdrv->knownObjects);
 	}
 
-	sdrv->sdr->logLength = 0;
-	sm_list_clear(_sdrwm(NULL), sdrv->sdr->logEntries, NULL, NULL);
+	if (GROUP_COMMIT(sdr))
+	{
+		if (!groupCommitDue(sdr)
+		|| flushDirtyExtents(sdr, sdrv->dsfile, sdrv->dssm) < 0)
+		{
+			/*	Commit group remains open, so log
+			 *	entries must be retained if the
+			 *	log is in a file.			*/
+
+			if (logIsRetained(sdr))
+			{
+				return;
+			}
+		}
+	}
+
+	resetLog(sdrv);
 }
 
 static void	handleUnrecoverableError(Sdr sdrv)
@@ -1076,6 +1899,15 @@ static int	restageDsFromFile(SdrState *sdr, int dsfile, char *dssm)
 	size_t	offset;
 	vast	bytesRead;
 
+	/*	Replaying the transaction log may have left the file
+	 *	offset anywhere in the file.				*/
+
+	if (lseek(dsfile, 0, SEEK_SET) < 0)
+	{
+		putSysErrmsg("Can't rewind ds file", NULL);
+		return -1;
+	}
+
 	offset = 0;
 	while (bytesRemaining > 0)
 	{
@@ -1091,6 +1923,13 @@ static int	restageDsFromFile(SdrState *sdr, int dsfile, char *dssm)
 			return -1;
 		}
 
+		if (bytesRead == 0)
+		{
+			putErrmsg("Dataspace file is shorter than dataspace.",
+					itoa(offset));
+			return -1;
+		}
+
 		bytesRemaining -= bytesRead;
 		offset += bytesRead;
 	}
@@ -1098,6 +1937,51 @@ static int	restageDsFromFile(SdrState *sdr, int dsfile, char *dssm)
 	return 0;
 }
 
+static char	*mapDsFile(SdrState *sdr, int dsfile)
+{
+#ifdef unix
+	struct stat	statbuf;
+	void		*image;
+
+	/*	Referencing a mapped page beyond the end of the file
+	 *	would raise SIGBUS, so the dataspace file must be at
+	 *	least as long as the dataspace.				*/
+
+	if (fstat(dsfile, &statbuf) < 0)
+	{
+		putSysErrmsg("Can't stat dataspace file", NULL);
+		return NULL;
+	}
+
+	if (statbuf.st_size < sdr->dsSize)
+	{
+		putErrmsg("Dataspace file is shorter than dataspace.",
+				itoa(statbuf.st_size));
+		return NULL;
+	}
+
+	image = mmap(NULL, sdr->dsSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+			dsfile, 0);
+	if (image == MAP_FAILED)
+	{
+		putSysErrmsg("Can't map dataspace file", itoa(sdr->dsSize));
+		return NULL;
+	}
+
+	return (char *) image;
+#else
+	putErrmsg("Memory-mapped dataspace file not supported.", NULL);
+	return NULL;
+#endif
+}
+
+static void	unmapDsFile(SdrState *sdr, char *dssm)
+{
+#ifdef unix
+	oK(munmap(dssm, sdr->dsSize));
+#endif
+}
+
 static void	destroySdr(SdrState *sdr)
 {
 	sm_SemId	lock = _sdrlock(0);
@@ -1118,6 +2002,8 @@ static void	destroySdr(SdrState *sdr)
 		sm_SemDelete(sdr->sdrSemaphore);
 	}
 
+	endReaderSemaphores(sdr);
+
 	/*	Destroy file copy of dataspace if any.			*/
 
 	if (sdr->configFlags & SDR_IN_FILE)
@@ -1173,6 +2059,14 @@ static void	destroySdr(SdrState *sdr)
 		oK(sm_list_destroy(sdrwm, sdr->logEntries, NULL, NULL));
 	}
 
+	/*	Destroy unflushed group commit extents if any.		*/
+
+	if (sdr->dirtyExtents)
+	{
+		sm_rbt_destroy(sdrwm, sdr->dirtyExtents, deleteDirtyExtent,
+				NULL);
+	}
+
 	/*	Unload profile and destroy it.				*/
 
 	if (sdr->sdrsElt)
@@ -1207,6 +2101,7 @@ int	sdr_load_profile(char *name, int configFlags, size_t heapWords,
 	int			dsfile = -1;
 	char			*dssm = NULL;
 	uaddr			dssmId;
+	PsmUsageSummary		wmUsage;
 
 	CHKERR(sdrwm);
 	CHKERR(sch);
@@ -1293,6 +2188,8 @@ SDR heap data, the heap MUST be resident in memory.", itoa(configFlags));
 	}
 
 	sdr->logKey = logKey;
+	sdr->sdrTurnstile = SM_SEM_NONE;
+	sdr->readersSemaphore = SM_SEM_NONE;
 	sdr->sdrSemaphore = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
 	if (sdr->sdrSemaphore == SM_SEM_NONE)
 	{
@@ -1301,6 +2198,16 @@ SDR heap data, the heap MUST be resident in memory.", itoa(configFlags));
 		return -1;
 	}
 
+	sdr->sdrTurnstile = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
+	sdr->readersSemaphore = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
+	if (sdr->sdrTurnstile == SM_SEM_NONE
+	|| sdr->readersSemaphore == SM_SEM_NONE)
+	{
+		putErrmsg("Can't create readers semaphores for SDR.", NULL);
+		destroySdr(sdr);		/*	Releases lock.	*/
+		return -1;
+	}
+
 	sdr->sdrOwnerTask = -1;
 	sdr->logEntries = sm_list_create(sdrwm);
 	if (sdr->logEntries == 0)
@@ -1406,6 +2313,12 @@ in file and transaction reversibility", sdr->pathName);
 			}
 		}
 
+		if (sdr->logLength > 0)
+		{
+			writeMemoNote("[i] Replaying SDR transaction log",
+					name);
+		}
+
 		if (reverseTransaction(sdr, logfile, logsm, dsfile, NULL) < 0)
 		{
 			close(dsfile);
@@ -1415,6 +2328,52 @@ in file and transaction reversibility", sdr->pathName);
 			destroySdr(sdr);	/*	Releases lock.	*/
 			return -1;
 		}
+
+		if (logIsRetained(sdr))
+		{
+			/*	The log file accumulates entries
+			 *	across transactions in group commit
+			 *	mode, so discard the entries that
+			 *	have now been reversed.			*/
+
+			close(logfile);
+			logfile = iopen(logfilename,
+					O_RDWR | O_CREAT | O_TRUNC, 0777);
+			if (logfile == -1)
+			{
+				close(dsfile);
+				putSysErrmsg("Can't truncate log file",
+						logfilename);
+				destroySdr(sdr);/*	Releases lock.	*/
+				return -1;
+			}
+
+			sdr->logLength = 0;
+			sm_list_clear(sdrwm, sdr->logEntries, NULL, NULL);
+		}
+
+		if (sdr->configFlags & SDR_GROUP_COMMIT)
+		{
+			psm_usage(sdrwm, &wmUsage);
+			sdr->maxDirtyBytes = wmUsage.partitionSize
+					/ SDR_GC_WM_SHARE;
+			if (sdr->maxDirtyBytes > SDR_GC_MAX_BYTES)
+			{
+				sdr->maxDirtyBytes = SDR_GC_MAX_BYTES;
+			}
+
+			sdr->dirtyExtents = sm_rbt_create(sdrwm);
+			if (sdr->dirtyExtents == 0)
+			{
+				close(dsfile);
+				if (logfile != -1) close(logfile);
+				if (logsm) sm_ShmDetach(logsm);
+				putErrmsg("Can't create dirty extents tree.",
+						NULL);
+				destroySdr(sdr);/*	Releases lock.	*/
+				return -1;
+			}
+		}
 	}
 
 	if (sdr->configFlags & SDR_IN_DRAM)
@@ -1538,6 +2497,18 @@ int	sdr_reload_profile(char *name, int configFlags, size_t heapWords,
 		sm_SemEnd(sdr->sdrSemaphore);
 		microsnooze(50000);
 		sm_SemDelete(sdr->sdrSemaphore);
+		endReaderSemaphores(sdr);
+
+		/*	Any dataspace file updates deferred for
+		 *	group commit are discarded: the file and
+		 *	the log revert to the last group flush.		*/
+
+		if (sdr->dirtyExtents)
+		{
+			sm_rbt_destroy(sdrwm, sdr->dirtyExtents,
+					deleteDirtyExtent, NULL);
+		}
+
 		psm_free(sdrwm, sdrAddress);
 		oK(sm_list_delete(sdrwm, elt, NULL, NULL));
 	}
@@ -1623,6 +2594,18 @@ Sdr	Sdr_start_using(char *name)
 		sdrv->dsfile = -1;
 	}
 
+	if (HEAP_MAPPED(sdr))
+	{
+		sdrv->dssm = mapDsFile(sdr, sdrv->dsfile);
+		if (sdrv->dssm == NULL)
+		{
+			close(sdrv->dsfile);
+			sm_SemGive(lock);
+			putErrmsg("Can't map dataspace file.", name);
+			return NULL;
+		}
+	}
+
 	if (sdr->configFlags & SDR_IN_DRAM)
 	{
 		sdrv->dssm = NULL;
@@ -1719,6 +2702,18 @@ void	sdr_stop_using(Sdr sdrv)
 		crashXn(sdrv);
 	}
 
+	/*	Don't leave deferred dataspace file updates behind.	*/
+
+	if (sdrv->sdr->dirtyExtents && takeSdr(sdrv->sdr) == 0)
+	{
+		if (flushDirtyExtents(sdrv->sdr, sdrv->dsfile, sdrv->dssm) == 0)
+		{
+			resetLog(sdrv);
+		}
+
+		releaseSdr(sdrv->sdr);
+	}
+
 	/*	Terminate all local SDR state and destroy the Sdr.	*/
 
 	if (sdrv->dsfile != -1)
@@ -1728,7 +2723,14 @@ void	sdr_stop_using(Sdr sdrv)
 
 	if (sdrv->dssm)
 	{
-		sm_ShmDetach(sdrv->dssm);
+		if (HEAP_MAPPED(sdrv->sdr))
+		{
+			unmapDsFile(sdrv->sdr, sdrv->dssm);
+		}
+		else
+		{
+			sm_ShmDetach(sdrv->dssm);
+		}
 	}
 
 	if (sdrv->logfile != -1)
@@ -1753,6 +2755,7 @@ void	sdr_stop_using(Sdr sdrv)
 	psm_free(sdrwm, psa(sdrwm, sdrv));
 
 	/*  Detach from SDR Working Memory */
+	psm_flush_cache(sdrwm);
 	sm_ShmDetach(sdrwm->space);
 
 	/*  Reset sdrwm database */
@@ -1769,6 +2772,7 @@ void	sdr_abort(Sdr sdrv)
 	microsnooze(50000);
 	sm_SemDelete(sdrv->sdr->sdrSemaphore);
 	sdrv->sdr->sdrSemaphore = -1;
+	endReaderSemaphores(sdrv->sdr);
 	sdr_shutdown();
 }
 
@@ -1822,6 +2826,46 @@ int	sdr_begin_xn(Sdr sdrv)
 	return 1;		/*	Began transaction.		*/
 }
 
+int	sdr_begin_read_xn(Sdr sdrv)
+{
+	SdrState	*sdr;
+	SdrReader	*reader;
+
+	CHKZERO(sdrv);
+	sdr = sdrv->sdr;
+	if (sdr->sdrSemaphore == -1 || sm_SemEnded(sdr->sdrSemaphore))
+	{
+		return 0;	/*	Failed to begin transaction.	*/
+	}
+
+	if (sdr_in_xn(sdrv))
+	{
+		/*	Nested within an exclusive transaction.	*/
+
+		sdr->xnDepth++;
+		return 1;
+	}
+
+	reader = findReader(sdr);
+	if (reader)		/*	Nested shared transaction.	*/
+	{
+		reader->depth++;
+		return 1;
+	}
+
+	switch (joinReaders(sdr))
+	{
+	case -1:
+		return 0;	/*	Failed to begin transaction.	*/
+
+	case 0:			/*	Too many readers.		*/
+		return sdr_begin_xn(sdrv);
+
+	default:
+		return 1;	/*	Began transaction.		*/
+	}
+}
+
 int	sdr_in_xn(Sdr sdrv)
 {
 	CHKZERO(sdrv);
@@ -1838,12 +2882,14 @@ int	sdr_heap_is_halted(Sdr sdrv)
 
 int	sdrFetchSafe(Sdr sdrv)
 {
-	return (sdr_in_xn(sdrv) || sdr_heap_is_halted(sdrv));
+	return (sdr_in_xn(sdrv) || findReader(sdrv->sdr) != NULL
+			|| sdr_heap_is_halted(sdrv));
 }
 
 void	sdr_exit_xn(Sdr sdrv)
 {
 	SdrState	*sdr;
+	SdrReader	*reader;
 
 	CHKVOID(sdrv);
 	sdr = sdrv->sdr;
@@ -1871,6 +2917,14 @@ void	sdr_exit_xn(Sdr sdrv)
 			clearTransaction(sdrv);
 			unlockSdr(sdr);
 		}
+
+		return;
+	}
+
+	reader = findReader(sdr);
+	if (reader)		/*	Ending a shared transaction.	*/
+	{
+		leaveReaders(sdr, reader);
 	}
 }
 
@@ -1888,12 +2942,17 @@ void	sdr_cancel_xn(Sdr sdrv)
 		{
 			terminateXn(sdrv);
 		}
+
+		return;
 	}
+
+	sdr_exit_xn(sdrv);	/*	Nothing to reverse if shared.	*/
 }
 
 int	sdr_end_xn(Sdr sdrv)
 {
 	SdrState	*sdr;
+	SdrReader	*reader;
 
 	CHKERR(sdrv);
 	sdr = sdrv->sdr;
@@ -1908,6 +2967,13 @@ int	sdr_end_xn(Sdr sdrv)
 		return 0;
 	}
 
+	reader = findReader(sdr);
+	if (reader)		/*	Ending a shared transaction.	*/
+	{
+		leaveReaders(sdr, reader);
+		return 0;
+	}
+
 	return -1;
 }
 
@@ -1933,7 +2999,7 @@ void	sdr_eject_xn(Sdr sdrv)
 void	*sdr_pointer(Sdr sdrv, Address address)
 {
 	CHKNULL(sdrv);
-	if ((sdrv->sdr->configFlags & SDR_IN_DRAM) == 0 || address <= 0)
+	if (!HEAP_IN_MEMORY(sdrv->sdr) || address <= 0)
 	{
 		return NULL;
 	}
@@ -1947,7 +3013,7 @@ Address	sdr_address(Sdr sdrv, void *pointer)
 
 	CHKZERO(sdrv);
 	ptr = (char *) pointer;
-	if ((sdrv->sdr->configFlags & SDR_IN_DRAM) == 0 || ptr <= sdrv->dssm)
+	if (!HEAP_IN_MEMORY(sdrv->sdr) || ptr <= sdrv->dssm)
 	{
 		return 0;
 	}
@@ -1988,7 +3054,18 @@ static int	writeToLog(const char *file, int line, Sdr sdrv, char *from,
 
 	if (sdr->logSize == 0)		/*	Log is in file.		*/
 	{
-		if (write(sdrv->logfile, from, length) != length)
+		/*	Each process has its own descriptor for the
+		 *	log file, and under group commit the log is
+		 *	retained across the transactions of several
+		 *	processes, so write at the end of the log
+		 *	rather than at this descriptor's offset.	*/
+#ifdef unix
+		if (pwrite(sdrv->logfile, from, length, sdr->logLength)
+				!= length)
+#else
+		if (lseek(sdrv->logfile, sdr->logLength, SEEK_SET) < 0
+		|| write(sdrv->logfile, from, length) != length)
+#endif
 		{
 			_putSysErrmsg(file, line, "Can't write log entry",
 					itoa(length));
@@ -2070,7 +3147,7 @@ void	_sdrput(const char *file, int line, Sdr sdrv, Address into, char *from,
 			return;
 		}
 
-		if (sdr->configFlags & SDR_IN_DRAM)
+		if (HEAP_IN_MEMORY(sdr))
 		{
 			if (writeToLog(file, line, sdrv, sdrv->dssm + into,
 					length) < 0)
@@ -2081,7 +3158,7 @@ entry", itoa(length));
 				return;
 			}
 		}
-		else	/*	Dataspace is only in file.		*/
+		else	/*	Dataspace is only in file, unmapped.	*/
 		{
 			buffer = MTAKE(length);
 			if (buffer == NULL)
@@ -2092,8 +3169,7 @@ log entry.", itoa(length));
 				return;
 			}
 
-			if (lseek(sdrv->dsfile, into, SEEK_SET) < 0
-			|| read(sdrv->dsfile, buffer, length) < length)
+			if (readFromDs(sdrv, buffer, into, length) < 0)
 			{
 				MRELEASE(buffer);
 				_putSysErrmsg(file, line, "Can't read old data",
@@ -2128,8 +3204,8 @@ entry.", NULL);
 
 	if (sdr->configFlags & SDR_IN_FILE)
 	{
-		if (lseek(sdrv->dsfile, into, SEEK_SET) < 0
-		|| write(sdrv->dsfile, from, length) < length)
+		if (writeToDs(sdr, sdrv->dsfile, sdrv->dssm, into, from,
+				length) < 0)
 		{
 			_putSysErrmsg(file, line, "Can't write to dataspace",
 					itoa(length));
@@ -2183,7 +3259,7 @@ void	_sdrfetch(Sdr sdrv, char *into, Address from, size_t length)
 		return;
 	}
 
-	if (sdr->configFlags & SDR_IN_DRAM)
+	if (HEAP_IN_MEMORY(sdr))
 	{
 		memcpy(into, sdrv->dssm + from, length);
 	}
@@ -2191,8 +3267,7 @@ void	_sdrfetch(Sdr sdrv, char *into, Address from, size_t length)
 	{
 		if (sdr->configFlags & SDR_IN_FILE)
 		{
-			if (lseek(sdrv->dsfile, from, SEEK_SET) < 0
-			|| read(sdrv->dsfile, into, length) < length)
+			if (readFromDs(sdrv, into, from, length) < 0)
 			{
 				putSysErrmsg("Dataspace read failed",
 						itoa(length));
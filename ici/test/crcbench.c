@@ -0,0 +1,178 @@
+/*
+
+	crcbench.c:	throughput benchmark for the ION CRC functions.
+
+	Computes the CRC-16/X-25, CRC-32C, and CRC-32 of a buffer of
+	random data repeatedly, first using the lookup tables alone
+	and then using each processor CRC feature (SSE4.2 crc32,
+	PCLMULQDQ folding) that the host supports, and reports the
+	throughput of each variant in GB/s.  Also verifies that every
+	variant computes the same CRC as the tables.
+									*/
+#include "platform.h"
+#include "crc.h"
+
+#define	DEFAULT_LENGTH	(65536)
+#define	DEFAULT_TOTAL	(1024)		/*	MB per variant.		*/
+
+typedef struct
+{
+	char		*name;
+	uint32_t	(*compute)(const char *data, uint32_t dLen,
+				uint32_t crc);
+	int		features;	/*	Those that may help.	*/
+} CrcFunction;
+
+typedef struct
+{
+	char		*name;
+	int		features;
+} CrcVariant;
+
+static uint32_t	crc16(const char *data, uint32_t dLen, uint32_t crc)
+{
+	return ion_CRC16_1021_X25(data, dLen, (uint16_t) crc);
+}
+
+static uint32_t	crc32c(const char *data, uint32_t dLen, uint32_t crc)
+{
+#ifdef ENABLE_HIGH_SPEED
+	return ion_CRC32_1EDC6F41_C_slice(data, dLen, crc);
+#else
+	return ion_CRC32_1EDC6F41_C(data, dLen, crc);
+#endif
+}
+
+static uint32_t	crc32(const char *data, uint32_t dLen, uint32_t crc)
+{
+#ifdef ENABLE_HIGH_SPEED
+	return ion_CRC32_04C11DB7_slice(data, dLen, crc);
+#else
+	return ion_CRC32_04C11DB7(data, dLen, crc);
+#endif
+}
+
+static CrcFunction	functions[] =
+{
+	{ "CRC-16/X-25", crc16, ION_CRC_PCLMUL },
+	{ "CRC-32C", crc32c, ION_CRC_SSE42 | ION_CRC_PCLMUL },
+	{ "CRC-32", crc32, ION_CRC_PCLMUL }
+};
+
+static CrcVariant	variants[] =
+{
+	{ "table", 0 },
+	{ "sse4.2", ION_CRC_SSE42 },
+	{ "pclmul", ION_CRC_PCLMUL },
+	{ "sse4.2+pclmul", ION_CRC_SSE42 | ION_CRC_PCLMUL }
+};
+
+static int	run_crcbench(uint32_t length, unsigned long megabytes)
+{
+	int		supported = ion_CRC_hw_accel(-1);
+	char		*buffer;
+	unsigned long	count;
+	unsigned long	i;
+	int		f;
+	int		v;
+	int		features;
+	uint32_t	expected;
+	uint32_t	crc;
+	struct timeval	start;
+	struct timeval	end;
+	double		seconds;
+	char		label[80];
+	char		value[32];
+	int		result = 0;
+
+	buffer = malloc(length);
+	if (buffer == NULL)
+	{
+		PUTS("Can't allocate buffer.");
+		return 1;
+	}
+
+	srand(1);
+	for (i = 0; i < length; i++)
+	{
+		buffer[i] = rand();
+	}
+
+	count = ((megabytes * 1024 * 1024) / length) + 1;
+	isprintf(value, sizeof value, "%lu x %lu bytes", count,
+			(unsigned long) length);
+	PUTMEMO("Data per variant", value);
+	for (f = 0; f < sizeof functions / sizeof(CrcFunction); f++)
+	{
+		oK(ion_CRC_hw_accel(0));
+		expected = functions[f].compute(buffer, length, 0);
+		for (v = 0; v < sizeof variants / sizeof(CrcVariant); v++)
+		{
+			features = variants[v].features;
+			if ((features & functions[f].features) != features
+			|| (features & supported) != features)
+			{
+				continue;	/*	Not applicable.	*/
+			}
+
+			oK(ion_CRC_hw_accel(variants[v].features));
+			crc = functions[f].compute(buffer, length, 0);
+			isprintf(label, sizeof label, "%s %s",
+					functions[f].name, variants[v].name);
+			if (crc != expected)
+			{
+				isprintf(value, sizeof value, "%#x, not %#x",
+						crc, expected);
+				PUTMEMO("Wrong CRC", label);
+				PUTMEMO(label, value);
+				result = 1;
+				continue;
+			}
+
+			getCurrentTime(&start);
+			for (i = 0; i < count; i++)
+			{
+				crc = functions[f].compute(buffer, length, crc);
+			}
+
+			getCurrentTime(&end);
+			seconds = (end.tv_sec - start.tv_sec)
+				+ ((end.tv_usec - start.tv_usec) / 1000000.0);
+			isprintf(label, sizeof label, "%s %s (GB/s)",
+					functions[f].name, variants[v].name);
+			isprintf(value, sizeof value, "%.2f", seconds > 0.0 ?
+				(((double) count * length) / seconds) / 1.0e9
+				: 0.0);
+			PUTMEMO(label, value);
+		}
+	}
+
+	oK(ion_CRC_hw_accel(-1));
+	free(buffer);
+	return result;
+}
+
+#if defined (ION_LWT)
+int	crcbench(saddr a1, saddr a2, saddr a3, saddr a4, saddr a5,
+		saddr a6, saddr a7, saddr a8, saddr a9, saddr a10)
+{
+	long		length = (a1 == 0 ? DEFAULT_LENGTH : strtol((char *) a1,
+				NULL, 0));
+	unsigned long	megabytes = (a2 == 0 ? DEFAULT_TOTAL :
+				strtoul((char *) a2, NULL, 0));
+#else
+int	main(int argc, char **argv)
+{
+	long		length = (argc > 1 ? strtol(argv[1], NULL, 0)
+				: DEFAULT_LENGTH);
+	unsigned long	megabytes = (argc > 2 ? strtoul(argv[2], NULL, 0)
+				: DEFAULT_TOTAL);
+#endif
+	if (length <= 0 || megabytes == 0)
+	{
+		PUTS("Usage:  crcbench [<buffer length> [<megabytes>]]");
+		return 0;
+	}
+
+	return run_crcbench((uint32_t) length, megabytes);
+}
@@ -0,0 +1,250 @@
+/*
+
+	sembench.c:	microbenchmark for ICI semaphore take/give.
+
+	Measures the cost of an uncontended sm_SemTake/sm_SemGive
+	pair and of a two-thread "ping-pong" handoff using ICI
+	semaphores, then repeats both measurements using raw SVR4
+	semop() calls of the same form as the ICI SVR4 semaphore
+	implementation, for comparison.  Build ION with and without
+	--enable-force-futex-semaphores (Linux) to compare the
+	futex-based ICI semaphores with the default ones.
+									*/
+#include "platform.h"
+
+#ifdef unix
+#include <sys/ipc.h>
+#include <sys/sem.h>
+#endif
+
+#define	DEFAULT_COUNT	1000000
+
+#if defined (FUTEX_SEMAPHORES)
+#define	SEM_IMPLEMENTATION	"futex"
+#elif defined (POSIX_NAMED_SEMAPHORES)
+#define	SEM_IMPLEMENTATION	"Posix named"
+#elif defined (SVR4_SEMAPHORES)
+#define	SEM_IMPLEMENTATION	"SVR4"
+#else
+#define	SEM_IMPLEMENTATION	"platform"
+#endif
+
+typedef struct
+{
+	int		(*take)(void *sem);
+	void		(*give)(void *sem);
+	void		*ping;
+	void		*pong;
+	unsigned long	count;
+} PingPong;
+
+static int	iciTake(void *sem)
+{
+	return sm_SemTake(*((sm_SemId *) sem));
+}
+
+static void	iciGive(void *sem)
+{
+	sm_SemGive(*((sm_SemId *) sem));
+}
+
+#ifdef unix
+static int	svr4Take(void *sem)
+{
+	struct sembuf	sem_op[2] = { {0,0,0}, {0,1,0} };
+
+	while (semop(*((int *) sem), sem_op, 2) < 0)
+	{
+		if (errno != EINTR)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void	svr4Give(void *sem)
+{
+	struct sembuf	sem_op = { 0, -1, IPC_NOWAIT };
+
+	oK(semop(*((int *) sem), &sem_op, 1));
+}
+#endif
+
+static unsigned long	elapsedNsec(struct timeval *start, struct timeval *end)
+{
+	return (((end->tv_sec - start->tv_sec) * 1000000)
+			+ (end->tv_usec - start->tv_usec)) * 1000;
+}
+
+static void	report(char *label, unsigned long count, struct timeval *start,
+			struct timeval *end)
+{
+	unsigned long	nsec = elapsedNsec(start, end);
+
+	PUTMEMO(label, count > 0 ? utoa(nsec / count) : "0");
+}
+
+static void	*ponger(void *parm)
+{
+	PingPong	*pp = (PingPong *) parm;
+	unsigned long	i;
+
+	for (i = 0; i < pp->count; i++)
+	{
+		if (pp->take(pp->ping) < 0)
+		{
+			break;
+		}
+
+		pp->give(pp->pong);
+	}
+
+	return NULL;
+}
+
+static int	runBench(char *name, PingPong *pp, unsigned long count)
+{
+	char		label[80];
+	struct timeval	start;
+	struct timeval	end;
+	pthread_t	pongThread;
+	unsigned long	i;
+
+	/*	Uncontended: the semaphore is always available.	*/
+
+	getCurrentTime(&start);
+	for (i = 0; i < count; i++)
+	{
+		if (pp->take(pp->ping) < 0)
+		{
+			PUTS("Can't take semaphore.");
+			return -1;
+		}
+
+		pp->give(pp->ping);
+	}
+
+	getCurrentTime(&end);
+	isprintf(label, sizeof label, "%s uncontended take+give (nsec)",
+			name);
+	report(label, count, &start, &end);
+
+	/*	Handoff: every take blocks until the other thread gives.	*/
+
+	pp->count = count / 10;
+	if (pp->take(pp->ping) < 0 || pp->take(pp->pong) < 0)
+	{
+		PUTS("Can't take semaphore.");
+		return -1;
+	}
+
+	if (pthread_begin(&pongThread, NULL, ponger, pp, "sembench"))
+	{
+		putSysErrmsg("Can't create ponger thread", NULL);
+		return -1;
+	}
+
+	getCurrentTime(&start);
+	for (i = 0; i < pp->count; i++)
+	{
+		pp->give(pp->ping);
+		if (pp->take(pp->pong) < 0)
+		{
+			break;
+		}
+	}
+
+	getCurrentTime(&end);
+	pthread_join(pongThread, NULL);
+	isprintf(label, sizeof label, "%s handoff round trip (nsec)", name);
+	report(label, i, &start, &end);
+	pp->give(pp->ping);
+	pp->give(pp->pong);
+	return 0;
+}
+
+static int	run_sembench(unsigned long count)
+{
+	PingPong	pp;
+	sm_SemId	iciPing;
+	sm_SemId	iciPong;
+#ifdef unix
+	int		svr4Ping;
+	int		svr4Pong;
+#endif
+	char		name[40];
+	int		result;
+
+	if (sm_ipc_init() < 0)
+	{
+		return 1;
+	}
+
+	iciPing = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
+	iciPong = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
+	if (iciPing == SM_SEM_NONE || iciPong == SM_SEM_NONE)
+	{
+		PUTS("Can't create semaphore.");
+		return 1;
+	}
+
+	PUTMEMO("ICI semaphore implementation", SEM_IMPLEMENTATION);
+	pp.take = iciTake;
+	pp.give = iciGive;
+	pp.ping = &iciPing;
+	pp.pong = &iciPong;
+	isprintf(name, sizeof name, "ICI (%s)", SEM_IMPLEMENTATION);
+	result = runBench(name, &pp, count);
+	sm_SemDelete(iciPing);
+	sm_SemDelete(iciPong);
+	if (result < 0)
+	{
+		return 1;
+	}
+
+#ifdef unix
+	svr4Ping = semget(IPC_PRIVATE, 1, IPC_CREAT | 0666);
+	svr4Pong = semget(IPC_PRIVATE, 1, IPC_CREAT | 0666);
+	if (svr4Ping < 0 || svr4Pong < 0)
+	{
+		putSysErrmsg("Can't get SVR4 semaphore", NULL);
+		return 1;
+	}
+
+	pp.take = svr4Take;
+	pp.give = svr4Give;
+	pp.ping = &svr4Ping;
+	pp.pong = &svr4Pong;
+	result = runBench("raw SVR4 semop", &pp, count);
+	oK(semctl(svr4Ping, 0, IPC_RMID, NULL));
+	oK(semctl(svr4Pong, 0, IPC_RMID, NULL));
+	if (result < 0)
+	{
+		return 1;
+	}
+#endif
+	return 0;
+}
+
+#if defined (ION_LWT)
+int	sembench(saddr a1, saddr a2, saddr a3, saddr a4, saddr a5,
+		saddr a6, saddr a7, saddr a8, saddr a9, saddr a10)
+{
+	unsigned long	count = (a1 == 0 ? DEFAULT_COUNT : strtoul((char *) a1,
+				NULL, 0));
+#else
+int	main(int argc, char **argv)
+{
+	unsigned long	count = (argc > 1 ? strtoul(argv[1], NULL, 0)
+				: DEFAULT_COUNT);
+#endif
+	if (count == 0)
+	{
+		PUTS("Usage:  sembench [<number of take/give pairs>]");
+		return 0;
+	}
+
+	return run_sembench(count);
+}
@@ -0,0 +1,223 @@
+/*
+
+	zcobulkbench.c:	throughput benchmark for writing and reading
+			bulk-sourced ZCOs.
+
+	Writes a bulk item of the indicated size in large blocks, wraps
+	it in a ZCO whose single extent is sourced from that item (as
+	for a bundle whose payload is in bulk storage), and then reads
+	the entire ZCO one segment at a time, in one SDR transaction
+	per segment, as a convergence-layer output task would,
+	verifying the content of each segment.  Reports the write and
+	read throughput.  Must be run on an ION node that is running.
+									*/
+#include "ion.h"
+#include "bulk.h"
+
+#define	DEFAULT_MEGABYTES	(256)
+#define	DEFAULT_SEGMENT_SIZE	(1400)
+#define	FILL_BUFFER_SIZE	(65536)
+
+static double	elapsed(struct timeval *start)
+{
+	struct timeval	end;
+
+	getCurrentTime(&end);
+	return (end.tv_sec - start->tv_sec)
+			+ ((end.tv_usec - start->tv_usec) / 1000000.0);
+}
+
+static void	reportRate(char *label, vast bytes, double seconds)
+{
+	char	value[64];
+
+	isprintf(value, sizeof value, "%.1f", seconds > 0.0 ?
+			(bytes / seconds) / (1024 * 1024) : 0.0);
+	PUTMEMO(label, value);
+}
+
+static int	writeBulkItem(unsigned long item, vast length)
+{
+	char		buffer[FILL_BUFFER_SIZE];
+	vast		offset = 0;
+	int		len;
+	int		i;
+	struct timeval	start;
+
+	for (i = 0; i < FILL_BUFFER_SIZE; i++)
+	{
+		buffer[i] = i & 0xff;
+	}
+
+	if (bulk_create(item) < 0)
+	{
+		putErrmsg("Can't create bulk item.", utoa(item));
+		return -1;
+	}
+
+	getCurrentTime(&start);
+	while (offset < length)
+	{
+		len = (length - offset < FILL_BUFFER_SIZE ? length - offset
+				: FILL_BUFFER_SIZE);
+		if (bulk_write(item, offset, buffer, len) != len)
+		{
+			putErrmsg("Can't write bulk item.", utoa(item));
+			bulk_destroy(item);
+			return -1;
+		}
+
+		offset += len;
+	}
+
+	reportRate("Bulk write MB per second", length, elapsed(&start));
+	return 0;
+}
+
+static int	run_zcobulkbench(unsigned long megabytes, int segmentSize)
+{
+	vast		length = ((vast) megabytes) * 1024 * 1024;
+	unsigned long	item = sm_TaskIdSelf();
+	Sdr		sdr;
+	Object		bulkRef;
+	Object		zco;
+	ZcoReader	reader;
+	char		*buffer;
+	vast		bytesRead = 0;
+	vast		len;
+	vast		i;
+	int		failed = 0;
+	struct timeval	start;
+	char		value[64];
+
+	if (ionAttach() < 0)
+	{
+		putErrmsg("Can't attach to ION.", NULL);
+		return 1;
+	}
+
+	sdr = getIonsdr();
+	buffer = malloc(segmentSize);
+	if (buffer == NULL)
+	{
+		putErrmsg("Can't allocate segment buffer.", NULL);
+		ionDetach();
+		return 1;
+	}
+
+	isprintf(value, sizeof value, "%lu MB in %d-byte segments", megabytes,
+			segmentSize);
+	PUTMEMO("Bulk-sourced ZCO", value);
+	if (writeBulkItem(item, length) < 0)
+	{
+		free(buffer);
+		writeErrmsgMemos();
+		ionDetach();
+		return 1;
+	}
+
+	/*	The item is destroyed when the ZCO is destroyed.	*/
+
+	CHKERR(sdr_begin_xn(sdr));
+	bulkRef = zco_create_bulk_ref(sdr, item, length, ZcoOutbound);
+	if (bulkRef == 0)
+	{
+		sdr_cancel_xn(sdr);
+		bulk_destroy(item);
+		putErrmsg("Can't create bulk reference.", utoa(item));
+		failed = 1;
+	}
+	else
+	{
+		zco = zco_create(sdr, ZcoBulkSource, bulkRef, 0, length,
+				ZcoOutbound);
+		zco_destroy_bulk_ref(sdr, bulkRef);
+		if (sdr_end_xn(sdr) < 0 || zco == 0 || zco == (Object) ERROR)
+		{
+			putErrmsg("Can't create ZCO.", NULL);
+			failed = 1;
+		}
+	}
+
+	if (failed)
+	{
+		free(buffer);
+		writeErrmsgMemos();
+		ionDetach();
+		return 1;
+	}
+
+	zco_start_transmitting(zco, &reader);
+	getCurrentTime(&start);
+	while (bytesRead < length)
+	{
+		CHKERR(sdr_begin_xn(sdr));
+		len = zco_transmit(sdr, &reader, segmentSize, buffer);
+		if (sdr_end_xn(sdr) < 0 || len <= 0)
+		{
+			putErrmsg("Can't read from ZCO.", NULL);
+			failed = 1;
+			break;
+		}
+
+		for (i = 0; i < len; i++)
+		{
+			if (buffer[i] != (char) ((bytesRead + i) & 0xff))
+			{
+				putErrmsg("ZCO content is corrupt.",
+						itoa((int) (bytesRead + i)));
+				failed = 1;
+				break;
+			}
+		}
+
+		if (failed)
+		{
+			break;
+		}
+
+		bytesRead += len;
+	}
+
+	if (!failed)
+	{
+		reportRate("ZCO read MB per second", bytesRead,
+				elapsed(&start));
+	}
+
+	if (sdr_begin_xn(sdr))
+	{
+		zco_destroy(sdr, zco);
+		oK(sdr_end_xn(sdr));
+	}
+
+	free(buffer);
+	writeErrmsgMemos();
+	ionDetach();
+	return failed;
+}
+
+#if defined (ION_LWT)
+int	zcobulkbench(saddr a1, saddr a2, saddr a3, saddr a4, saddr a5,
+		saddr a6, saddr a7, saddr a8, saddr a9, saddr a10)
+{
+	unsigned long	megabytes = (a1 == 0 ? DEFAULT_MEGABYTES :
+				strtoul((char *) a1, NULL, 0));
+	long		segmentSize = (a2 == 0 ? DEFAULT_SEGMENT_SIZE :
+				strtol((char *) a2, NULL, 0));
+#else
+int	main(int argc, char **argv)
+{
+	unsigned long	megabytes = (argc > 1 ? strtoul(argv[1], NULL, 0)
+				: DEFAULT_MEGABYTES);
+	long		segmentSize = (argc > 2 ? strtol(argv[2], NULL, 0)
+				: DEFAULT_SEGMENT_SIZE);
+#endif
+	if (megabytes == 0 || segmentSize <= 0 || segmentSize > 65536)
+	{
+		PUTS("Usage:  zcobulkbench [<megabytes> [<segment size>]]");
+		return 0;
+	}
+
+	return run_zcobulkbench(megabytes, (int) segmentSize);
+}
@@ -0,0 +1,216 @@
+/*
+
+	zcofilebench.c:	throughput benchmark for reading file-sourced
+			ZCOs.
+
+	Creates a file of the indicated size, wraps it in a ZCO whose
+	single extent is sourced from that file, and then reads the
+	entire ZCO one segment at a time, in one SDR transaction per
+	segment and with file offset tracking turned on, as a
+	convergence-layer output task would.  Reports the number of
+	segments read per second.
+									*/
+#include "platform.h"
+#include "sdr.h"
+#include "zco.h"
+
+#define	DEFAULT_MEGABYTES	(1024)
+#define	DEFAULT_SEGMENT_SIZE	(1400)
+#define	FILL_BUFFER_SIZE	(65536)
+#define	TEST_WM_SIZE		(1000000)
+#define	TEST_HEAP_WORDS		(250000)
+#define	TEST_SDR_NAME		"zcofilebench"
+#define	TEST_FILE_NAME		"zcofilebench.dat"
+
+static int	createTestFile(char *fileName, vast length)
+{
+	char	buffer[FILL_BUFFER_SIZE];
+	int	fd;
+	vast	bytesRemaining = length;
+	int	len;
+	int	i;
+
+	for (i = 0; i < FILL_BUFFER_SIZE; i++)
+	{
+		buffer[i] = i & 0xff;
+	}
+
+	fd = iopen(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0)
+	{
+		putSysErrmsg("Can't create test file", fileName);
+		return -1;
+	}
+
+	while (bytesRemaining > 0)
+	{
+		len = (bytesRemaining < FILL_BUFFER_SIZE ? bytesRemaining
+				: FILL_BUFFER_SIZE);
+		if (write(fd, buffer, len) != len)
+		{
+			putSysErrmsg("Can't write test file", fileName);
+			close(fd);
+			return -1;
+		}
+
+		bytesRemaining -= len;
+	}
+
+	close(fd);
+	return 0;
+}
+
+static int	run_zcofilebench(unsigned long megabytes, int segmentSize)
+{
+	vast		length = ((vast) megabytes) * 1024 * 1024;
+	char		fileName[MAXPATHLEN + 1];
+	char		cwd[MAXPATHLEN + 1];
+	Sdr		sdr;
+	Object		fileRef;
+	Object		zco;
+	ZcoReader	reader;
+	char		*buffer;
+	vast		bytesRead = 0;
+	vast		len;
+	unsigned long	segments = 0;
+	int		failed = 0;
+	struct timeval	start;
+	struct timeval	end;
+	double		seconds;
+	char		value[64];
+
+	if (igetcwd(cwd, sizeof cwd) == NULL)
+	{
+		putErrmsg("Can't get current working directory.", NULL);
+		return 1;
+	}
+
+	isprintf(fileName, sizeof fileName, "%s%c%s", cwd,
+			ION_PATH_DELIMITER, TEST_FILE_NAME);
+	buffer = malloc(segmentSize);
+	if (buffer == NULL)
+	{
+		PUTS("Can't allocate segment buffer.");
+		return 1;
+	}
+
+	if (createTestFile(fileName, length) < 0)
+	{
+		free(buffer);
+		return 1;
+	}
+
+	if (sdr_initialize(TEST_WM_SIZE, NULL, SM_NO_KEY, NULL) < 0
+	|| sdr_load_profile(TEST_SDR_NAME, SDR_IN_DRAM, TEST_HEAP_WORDS,
+			SM_NO_KEY, 0, SM_NO_KEY, cwd, NULL) < 0
+	|| (sdr = sdr_start_using(TEST_SDR_NAME)) == NULL)
+	{
+		putErrmsg("Can't use sdr.", TEST_SDR_NAME);
+		oK(unlink(fileName));
+		free(buffer);
+		return 1;
+	}
+
+	/*	The file is removed when the ZCO is destroyed.		*/
+
+	CHKERR(sdr_begin_xn(sdr));
+	fileRef = zco_create_file_ref(sdr, fileName, "", ZcoOutbound);
+	if (fileRef == 0)
+	{
+		sdr_cancel_xn(sdr);
+		oK(unlink(fileName));
+		putErrmsg("Can't create file reference.", fileName);
+		failed = 1;
+	}
+	else
+	{
+		zco = zco_create(sdr, ZcoFileSource, fileRef, 0, length,
+				ZcoOutbound);
+		zco_destroy_file_ref(sdr, fileRef);
+		if (sdr_end_xn(sdr) < 0 || zco == 0 || zco == (Object) ERROR)
+		{
+			putErrmsg("Can't create ZCO.", NULL);
+			failed = 1;
+		}
+	}
+
+	if (failed)
+	{
+		sdr_stop_using(sdr);
+		sdr_shutdown();
+		free(buffer);
+		writeErrmsgMemos();
+		return 1;
+	}
+
+	isprintf(value, sizeof value, "%lu MB in %d-byte segments", megabytes,
+			segmentSize);
+	PUTMEMO("Reading file-sourced ZCO", value);
+	zco_start_transmitting(zco, &reader);
+	zco_track_file_offset(&reader);
+	getCurrentTime(&start);
+	while (bytesRead < length)
+	{
+		CHKERR(sdr_begin_xn(sdr));
+		len = zco_transmit(sdr, &reader, segmentSize, buffer);
+		if (sdr_end_xn(sdr) < 0 || len <= 0)
+		{
+			putErrmsg("Can't read from ZCO.", NULL);
+			failed = 1;
+			break;
+		}
+
+		bytesRead += len;
+		segments++;
+	}
+
+	getCurrentTime(&end);
+	seconds = (end.tv_sec - start.tv_sec)
+			+ ((end.tv_usec - start.tv_usec) / 1000000.0);
+	if (!failed)
+	{
+		isprintf(value, sizeof value, "%.0f", seconds > 0.0 ?
+				segments / seconds : 0.0);
+		PUTMEMO("Segments per second", value);
+		isprintf(value, sizeof value, "%.1f", seconds > 0.0 ?
+				(bytesRead / seconds) / (1024 * 1024) : 0.0);
+		PUTMEMO("MB per second", value);
+	}
+
+	if (sdr_begin_xn(sdr))
+	{
+		zco_destroy(sdr, zco);
+		oK(sdr_end_xn(sdr));
+	}
+
+	sdr_stop_using(sdr);
+	sdr_shutdown();
+	free(buffer);
+	writeErrmsgMemos();
+	return failed;
+}
+
+#if defined (ION_LWT)
+int	zcofilebench(saddr a1, saddr a2, saddr a3, saddr a4, saddr a5,
+		saddr a6, saddr a7, saddr a8, saddr a9, saddr a10)
+{
+	unsigned long	megabytes = (a1 == 0 ? DEFAULT_MEGABYTES :
+				strtoul((char *) a1, NULL, 0));
+	long		segmentSize = (a2 == 0 ? DEFAULT_SEGMENT_SIZE :
+				strtol((char *) a2, NULL, 0));
+#else
+int	main(int argc, char **argv)
+{
+	unsigned long	megabytes = (argc > 1 ? strtoul(argv[1], NULL, 0)
+				: DEFAULT_MEGABYTES);
+	long		segmentSize = (argc > 2 ? strtol(argv[2], NULL, 0)
+				: DEFAULT_SEGMENT_SIZE);
+#endif
+	if (megabytes == 0 || segmentSize <= 0 || segmentSize > 65536)
+	{
+		PUTS("Usage:  zcofilebench [<megabytes> [<segment size>]]");
+		return 0;
+	}
+
+	return run_zcofilebench(megabytes, (int) segmentSize);
+}
@@ -72,8 +72,13 @@ int	main(int argc, char *argv[])
 	unsigned int		ipAddress = 0;
 	char			ownHostName[MAXHOSTNAMELEN];
 	int			running = 1;
-	int			segmentLength;
-	char			*segment;
+	int			bufLength;
+	char			*buffers;
+	char			*segments[LTP_OUTBOUND_BATCH_SIZE];
+	int			lengths[LTP_OUTBOUND_BATCH_SIZE];
+	int			batchLimit;
+	int			batchLength;
+	int			i;
 	struct sockaddr		socketName;
 	struct sockaddr_in	*inetName;
 	int			linkSocket;
@@ -173,33 +178,53 @@ int	main(int argc, char *argv[])
 		writeMemo(txt);
 	}
 
+	/*	Segments are dequeued in batches, each batch in a
+	 *	single SDR transaction, except that they are dequeued
+	 *	one at a time when transmission is rate-limited.	*/
+
+	bufLength = vspan->maxXmitSegSize;
+	if (bufLength > AOSLSA_BUFSZ)
+	{
+		bufLength = AOSLSA_BUFSZ;
+	}
+
+	batchLimit = (txbps == 0 ? LTP_OUTBOUND_BATCH_SIZE : 1);
+	buffers = MTAKE(bufLength * batchLimit);
+	if (buffers == NULL)
+	{
+		closesocket(linkSocket);
+		putErrmsg("No space for segment buffer array.", NULL);
+		return 1;
+	}
+
+	for (i = 0; i < batchLimit; i++)
+	{
+		segments[i] = buffers + (i * bufLength);
+	}
+
 	while (running && !(sm_SemEnded(vspan->segSemaphore)))
 	{
-		segmentLength = ltpDequeueOutboundSegment(vspan, &segment);
-		if (segmentLength < 0)
+		batchLength = ltpDequeueOutboundSegments(vspan, segments,
+				lengths, bufLength, batchLimit);
+		if (batchLength < 0)
 		{
 			running = 0;	/*	Terminate LSO.		*/
 			continue;
 		}
 
-		if (segmentLength == 0)	/*	Interrupted.		*/
+		if (batchLength == 0)	/*	Interrupted.		*/
 		{
 			continue;
 		}
 
-		if (segmentLength > AOSLSA_BUFSZ)
-		{
-			putErrmsg("Segment is too big for AOS LSO.",
-				itoa(segmentLength));
-			running = 0;	/*	Terminate LSO.		*/
-		}
-		else
+		for (i = 0; i < batchLength; i++)
 		{
-			bytesSent = sendSegmentByAOS(linkSocket, segment,
-				segmentLength);
-			if (bytesSent < segmentLength)
+			bytesSent = sendSegmentByAOS(linkSocket, segments[i],
+					lengths[i]);
+			if (bytesSent < lengths[i])
 			{
 				running = 0;	/*	Terminate LSO.	*/
+				break;
 			}
 		}
 
@@ -226,6 +251,7 @@ int	main(int argc, char *argv[])
 		sm_TaskYield();
 	}
 
+	MRELEASE(buffers);
 	closesocket(linkSocket);
 	writeErrmsgMemos();
 	writeMemo("[i] aoslso duct has ended.");
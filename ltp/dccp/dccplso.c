@@ -296,10 +296,13 @@ int	main(int argc, char *argv[])
 	unsigned short		portNbr = 0;
 	unsigned int		ipAddress = 0;
 	int					running = 1;
-	int					segmentLength;
-	char				*segment;
+	int					bufLength;
+	char				*buffers;
+	char				*segments[LTP_OUTBOUND_BATCH_SIZE];
+	int					lengths[LTP_OUTBOUND_BATCH_SIZE];
+	int					batchLength;
+	int					i;
 	struct sockaddr_in	*inetName;
-	int					bytesSent;
 	pthread_t			keepalive_thread;
 	lso_state			itp;
 
@@ -379,49 +382,70 @@ int	main(int argc, char *argv[])
 		return 1;
 	}
 	
+	/*	Segments are dequeued in batches, each batch in a
+	 *	single SDR transaction.					*/
+	bufLength = vspan->maxXmitSegSize;
+	if (bufLength > DCCPLSA_BUFSZ)
+	{
+		bufLength = DCCPLSA_BUFSZ;
+	}
+
+	buffers = MTAKE(bufLength * LTP_OUTBOUND_BATCH_SIZE);
+	if (buffers == NULL)
+	{
+		putErrmsg("No space for segment buffer array.", NULL);
+		pthread_mutex_lock(&itp.mutex);
+		itp.done = 1;
+		pthread_mutex_unlock(&itp.mutex);
+		pthread_join(keepalive_thread, NULL);
+		pthread_mutex_destroy(&itp.mutex);
+		return 1;
+	}
+
+	for (i = 0; i < LTP_OUTBOUND_BATCH_SIZE; i++)
+	{
+		segments[i] = buffers + (i * bufLength);
+	}
+
 	/*	Can now begin transmitting to remote engine.		*/
 	writeMemo("[i] dccplso is running.");
 	while (running && !(sm_SemEnded(vspan->segSemaphore)))
 	{
-		
-		segmentLength = ltpDequeueOutboundSegment(vspan, &segment);
-		if (segmentLength < 0)
+		batchLength = ltpDequeueOutboundSegments(vspan, segments,
+				lengths, bufLength, LTP_OUTBOUND_BATCH_SIZE);
+		if (batchLength < 0)
 		{
 			running = 0;
 			continue;
 			/*	Take down LSO				*/
 		}
 
-		if (segmentLength == 0)
+		if (batchLength == 0)
 		{
 			/*	Interrupted.				*/
 			continue;
 		}
 
-		if (segmentLength > DCCPLSA_BUFSZ)
+		pthread_mutex_lock(&itp.mutex);
+		for (i = 0; i < batchLength; i++)
 		{
-			/* Segment Too Big				*/
-			putErrmsg("Segment is too big for DCCPLSO.",
-					itoa(segmentLength));
-			running = 0;
-			continue;
-			/* Take down LSO				*/
+			if (sendSegmentByDCCP(&itp, segments[i], lengths[i])
+					< 0)
+			{
+				running = 0;
+				break;
+				/* Take down LSO			*/
+			}
 		}
 
-		pthread_mutex_lock(&itp.mutex);
-		bytesSent = sendSegmentByDCCP(&itp, segment, segmentLength);
 		pthread_mutex_unlock(&itp.mutex);
-		if (bytesSent < 0)
-		{
-			running = 0;
-			continue;
-			/* Take down LSO				*/
-		}
 
 		/*	Make sure other tasks have a chance to run.	*/
 		sm_TaskYield();
 	}
 
+	MRELEASE(buffers);
+
 	/* LSO is exiting						*/
 	writeMemo("[i] dccplso duct done sending.");
 	pthread_mutex_lock(&itp.mutex);
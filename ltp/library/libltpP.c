@@ -3395,63 +3395,169 @@ static int	setTimer(LtpTimer *timer, Address timerAddr, time_t currentSec,
 	return 0;
 }
 
-static int	readFromExportBlock(char *buffer, Object svcDataObjects,
-			unsigned int offset, unsigned int length)
+static int	seekExportCursor(Sdr sdr, LtpExportCursor *cursor,
+			unsigned int sessionNbr, Object svcDataObjects,
+			unsigned int offset)
 {
-	Sdr		sdr = getIonsdr();
 	Object		elt;
-	Object		sdu;	/*	Each member of list is a ZCO.	*/
-	unsigned int	sduLength;
-	int		totalBytesRead = 0;
-	ZcoReader	reader;
-	unsigned int	bytesToRead;
-	int		bytesRead;
+	unsigned int	sduStart;
+	unsigned int	sduLength = 0;
 
-	for (elt = sdr_list_first(sdr, svcDataObjects); elt;
-			elt = sdr_list_next(sdr, elt))
+	if (cursor->sessionNbr == sessionNbr
+	&& cursor->svcDataObjects == svcDataObjects)
 	{
-		sdu = sdr_list_data(sdr, elt);
-		sduLength = zco_length(sdr, sdu);
-		if (offset >= sduLength)
+		if (offset == cursor->offset)
 		{
-			offset -= sduLength;	/*	Skip over SDU.	*/
-			continue;
+			return 0;	/*	Already in position.	*/
 		}
 
-		zco_start_transmitting(sdu, &reader);
-		zco_track_file_offset(&reader);
-		if (offset > 0)
+		if (offset > cursor->offset
+		&& offset < cursor->sduStart + cursor->sduLength)
 		{
-			if (zco_transmit(sdr, &reader, offset, NULL) < 0)
+			/*	Skip forward within the current SDU.	*/
+
+			if (zco_transmit(sdr, &cursor->reader,
+					offset - cursor->offset, NULL) < 0)
 			{
+				cursor->sessionNbr = 0;
 				putErrmsg("Failed skipping offset.", NULL);
 				return -1;
 			}
 
-			sduLength -= offset;
-			offset = 0;
+			cursor->offset = offset;
+			return 0;
+		}
+	}
+
+	/*	Must locate the SDU containing the offset.  Search
+	 *	forward from the current SDU when possible, else
+	 *	from the start of the block.				*/
+
+	if (cursor->sessionNbr == sessionNbr
+	&& cursor->svcDataObjects == svcDataObjects
+	&& offset >= cursor->sduStart)
+	{
+		elt = cursor->sduElt;
+		sduStart = cursor->sduStart;
+	}
+	else
+	{
+		elt = sdr_list_first(sdr, svcDataObjects);
+		sduStart = 0;
+	}
+
+	cursor->sessionNbr = 0;
+	for (; elt; elt = sdr_list_next(sdr, elt))
+	{
+		sduLength = zco_length(sdr, sdr_list_data(sdr, elt));
+		if (offset < sduStart + sduLength)
+		{
+			break;
+		}
+
+		sduStart += sduLength;	/*	Skip over SDU.		*/
+	}
+
+	if (elt == 0)
+	{
+		putErrmsg("Offset is beyond end of block.", utoa(offset));
+		return -1;
+	}
+
+	zco_start_transmitting(sdr_list_data(sdr, elt), &cursor->reader);
+	zco_track_file_offset(&cursor->reader);
+	if (offset > sduStart)
+	{
+		if (zco_transmit(sdr, &cursor->reader, offset - sduStart,
+				NULL) < 0)
+		{
+			putErrmsg("Failed skipping offset.", NULL);
+			return -1;
+		}
+	}
+
+	cursor->sessionNbr = sessionNbr;
+	cursor->svcDataObjects = svcDataObjects;
+	cursor->sduElt = elt;
+	cursor->sduStart = sduStart;
+	cursor->sduLength = sduLength;
+	cursor->offset = offset;
+	return 0;
+}
+
+int	ltpReadExportBlock(LtpExportCursor *cursor, unsigned int sessionNbr,
+		Object svcDataObjects, unsigned int offset,
+		unsigned int length, char *buffer)
+{
+	Sdr		sdr = getIonsdr();
+	Object		elt;
+	int		totalBytesRead = 0;
+	unsigned int	bytesToRead;
+	int		bytesRead;
+
+	CHKERR(cursor);
+	CHKERR(buffer);
+	if (length == 0)
+	{
+		return 0;
+	}
+
+	if (seekExportCursor(sdr, cursor, sessionNbr, svcDataObjects, offset)
+			< 0)
+	{
+		return -1;
+	}
+
+	while (length > 0)
+	{
+		if (cursor->offset == cursor->sduStart + cursor->sduLength)
+		{
+			/*	Current SDU is exhausted; move on to
+			 *	the next SDU in the block.		*/
+
+			cursor->sduStart += cursor->sduLength;
+			cursor->sduLength = 0;
+			elt = cursor->sduElt;
+			while (cursor->sduLength == 0)
+			{
+				elt = sdr_list_next(sdr, elt);
+				if (elt == 0)
+				{
+					cursor->sessionNbr = 0;
+					putErrmsg("Segment is beyond end of \
+block.", utoa(cursor->offset));
+					return -1;
+				}
+
+				cursor->sduLength = zco_length(sdr,
+						sdr_list_data(sdr, elt));
+			}
+
+			cursor->sduElt = elt;
+			zco_start_transmitting(sdr_list_data(sdr, elt),
+					&cursor->reader);
+			zco_track_file_offset(&cursor->reader);
 		}
 
-		bytesToRead = length;
-		if (bytesToRead > sduLength)
+		bytesToRead = (cursor->sduStart + cursor->sduLength)
+				- cursor->offset;
+		if (bytesToRead > length)
 		{
-			bytesToRead = sduLength;
+			bytesToRead = length;
 		}
 
-		bytesRead = zco_transmit(sdr, &reader, bytesToRead,
+		bytesRead = zco_transmit(sdr, &cursor->reader, bytesToRead,
 				buffer + totalBytesRead);
 		if (bytesRead != bytesToRead)
 		{
+			cursor->sessionNbr = 0;
 			putErrmsg("Failed reading SDU.", NULL);
 			return -1;
 		}
 
+		cursor->offset += bytesRead;
 		totalBytesRead += bytesRead;
 		length -= bytesRead;
-		if (length == 0)	/*	Have read enough.	*/
-		{
-			break;
-		}
 	}
 
 	return totalBytesRead;
@@ -3499,15 +3605,23 @@ static int	serializeTrailer(LtpXmitSeg *segment, char *segmentBuffer)
 	return 0;
 }
 
-int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
+/*	serializeOutboundSegment removes the outbound segment reference
+ *	at elt from the span's segments queue and serializes the
+ *	referenced segment into buf, within the caller's transaction.
+ *	bytesAhead is the total length of the segments serialized
+ *	ahead of this one in the same batch, which will be radiated
+ *	before this one.  Returns the length of the segment, 0 if the
+ *	segment was discarded because its session has been closed,
+ *	-1 on any error (in which case the caller must cancel the
+ *	transaction).							*/
+
+static int	serializeOutboundSegment(LtpVspan *vspan, Object spanObj,
+			LtpSpan *spanBuf, Object elt, char *buf, int bufLength,
+			int bytesAhead)
 {
 	Sdr				sdr = getIonsdr();
 	LtpVdb				*ltpvdb = _ltpvdb(NULL);
 	LtpDB				*ltpConstants = _ltpConstants();
-	Object				spanObj;
-	LtpSpan				spanBuf;
-	Object				elt;
-	char				memo[64];
 	Object				segRefAddr;
 	LtpXmitSegRef			segRef;
 	Object				sessionObj;
@@ -3528,41 +3642,6 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 	ewchar[1] = '\0';
 #endif
 
-	CHKERR(vspan);
-	CHKERR(buf);
-	*buf = (char *) psp(getIonwm(), vspan->segmentBuffer);
-	CHKERR(sdr_begin_xn(sdr));
-	spanObj = sdr_list_data(sdr, vspan->spanElt);
-	sdr_stage(sdr, (char *) &spanBuf, spanObj, sizeof(LtpSpan));
-	elt = sdr_list_first(sdr, spanBuf.segments);
-	while (elt == 0 || vspan->localXmitRate == 0)
-	{
-		sdr_exit_xn(sdr);
-
-		/*	Wait until ltpmeter has announced an outbound
-		 *	segment by giving span's segSemaphore.		*/
-
-		if (sm_SemTake(vspan->segSemaphore) < 0)
-		{
-			putErrmsg("LSO can't take segment semaphore.",
-					itoa(vspan->engineId));
-			return -1;
-		}
-
-		if (sm_SemEnded(vspan->segSemaphore))
-		{
-			isprintf(memo, sizeof memo,
-			"[i] LSO to engine " UVAST_FIELDSPEC " is stopped.",
-					vspan->engineId);
-			writeMemo(memo);
-			return 0;
-		}
-
-		CHKERR(sdr_begin_xn(sdr));
-		sdr_stage(sdr, (char *) &spanBuf, spanObj, sizeof(LtpSpan));
-		elt = sdr_list_first(sdr, spanBuf.segments);
-	}
-
 	/*	Got next outbound segment reference.  Remove it from
 	 *	the queue for this span and delete it.			*/
 
@@ -3621,17 +3700,25 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 
 	segmentLength = segment.pdu.headerLength + segment.pdu.contentLength
 			+ segment.pdu.trailerLength;
+	if (segmentLength > bufLength)
+	{
+		putErrmsg("Segment is too big for buffer.",
+				itoa(segmentLength));
+		return -1;
+	}
+
 	if (segment.segmentClass == LtpDataSeg)
 	{
 		/*	Load client service data at the end of the
 		 *	segment first, before filling in the header.	*/
 
-		if (readFromExportBlock((*buf) + segment.pdu.headerLength
-				+ segment.pdu.ohdLength, segment.pdu.block,
-				segment.pdu.offset, segment.pdu.length) < 0)
+		if (ltpReadExportBlock(&vspan->exportCursor,
+				segment.sessionNbr, segment.pdu.block,
+				segment.pdu.offset, segment.pdu.length,
+				buf + segment.pdu.headerLength
+				+ segment.pdu.ohdLength) < 0)
 		{
 			putErrmsg("Can't read data from export block.", NULL);
-			sdr_cancel_xn(sdr);
 			return -1;
 		}
 	}
@@ -3682,10 +3769,10 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 		timer = &segment.pdu.timer;
 		if (setTimer(timer,
 			segRef.segAddr + FLD_OFFSET(timer, &segment),
-			currentTime, vspan, segmentLength, &event) < 0)
+			currentTime, vspan, bytesAhead + segmentLength,
+			&event) < 0)
 		{
 			putErrmsg("Can't schedule event.", NULL);
-			sdr_cancel_xn(sdr);
 			return -1;
 		}
 
@@ -3720,10 +3807,10 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 		timer = &segment.pdu.timer;
 		if (setTimer(timer,
 			segRef.segAddr + FLD_OFFSET(timer, &segment),
-			currentTime, vspan, segmentLength, &event) < 0)
+			currentTime, vspan, bytesAhead + segmentLength,
+			&event) < 0)
 		{
 			putErrmsg("Can't schedule event.", NULL);
-			sdr_cancel_xn(sdr);
 			return -1;
 		}
 
@@ -3778,10 +3865,9 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 		timer = &(xsessionBuf.timer);
 		if (setTimer(timer, sessionObj + FLD_OFFSET(timer,
 				&xsessionBuf), currentTime, vspan,
-				segmentLength, &event) < 0)
+				bytesAhead + segmentLength, &event) < 0)
 		{
 			putErrmsg("Can't schedule event.", NULL);
-			sdr_cancel_xn(sdr);
 			return -1;
 		}
 
@@ -3819,10 +3905,9 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 		timer = &(rsessionBuf.timer);
 		if (setTimer(timer, sessionObj + FLD_OFFSET(timer,
 				&rsessionBuf), currentTime, vspan,
-				segmentLength, &event) < 0)
+				bytesAhead + segmentLength, &event) < 0)
 		{
 			putErrmsg("Can't schedule event.", NULL);
-			sdr_cancel_xn(sdr);
 			return -1;
 		}
 
@@ -3856,11 +3941,10 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 			{
 				putErrmsg("Can't post XmitComplete notice.",
 						NULL);
-				sdr_cancel_xn(sdr);
 				return -1;
 			}
 
-			sdr_write(sdr, spanObj, (char *) &spanBuf,
+			sdr_write(sdr, spanObj, (char *) spanBuf,
 					sizeof(LtpSpan));
 		}
 
@@ -3912,18 +3996,18 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 	if (segment.pdu.segTypeCode < 8)
 	{
 		ltpSpanTally(vspan, OUT_SEG_POPPED, segment.pdu.length);
-		serializeDataSegment(&segment, *buf);
+		serializeDataSegment(&segment, buf);
 	}
 	else
 	{
 		switch (segment.pdu.segTypeCode)
 		{
 			case 8:		/*	Report.			*/
-				serializeReportSegment(&segment, *buf);
+				serializeReportSegment(&segment, buf);
 				break;
 
 			case 9:		/*	Report acknowledgment.	*/
-				serializeReportAckSegment(&segment, *buf);
+				serializeReportAckSegment(&segment, buf);
 #if defined (EWCHAR)
 			/* RAS - report ACK */
 			isprintf(ewchar,sizeof(ewchar),"(ras%u)g",segment.sessionNbr);
@@ -3932,12 +4016,12 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 
 			case 12:	/*	Cancel by sender.	*/
 			case 14:	/*	Cancel by receiver.	*/
-				serializeCancelSegment(&segment, *buf);
+				serializeCancelSegment(&segment, buf);
 				break;
 
 			case 13:	/*	Cancel acknowledgment.	*/
 			case 15:	/*	Cancel acknowledgment.	*/
-				serializeCancelAckSegment(&segment, *buf);
+				serializeCancelAckSegment(&segment, buf);
 #if defined (EWCHAR)
 			/* CAR or CAS - cancel ACK */
 			isprintf(ewchar,sizeof(ewchar),"(ca%u)g",segment.sessionNbr);
@@ -3949,16 +4033,9 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 		}
 	}
 
-	if (serializeTrailer(&segment, *buf) < 0)
+	if (serializeTrailer(&segment, buf) < 0)
 	{
 		putErrmsg("Can't serialize segment trailer.", NULL);
-		sdr_cancel_xn(sdr);
-		return -1;
-	}
-
-	if (sdr_end_xn(sdr))
-	{
-		putErrmsg("Can't get outbound segment for span.", NULL);
 		return -1;
 	}
 
@@ -3974,6 +4051,112 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 	return segmentLength;
 }
 
+int	ltpDequeueOutboundSegments(LtpVspan *vspan, char **bufs, int *lengths,
+		int bufLength, int maxCount)
+{
+	Sdr	sdr = getIonsdr();
+	Object	spanObj;
+	LtpSpan	spanBuf;
+	Object	elt;
+	char	memo[64];
+	int	count = 0;
+	int	bytesAhead = 0;
+	int	segmentLength;
+
+	CHKERR(vspan);
+	CHKERR(bufs);
+	CHKERR(lengths);
+	CHKERR(maxCount > 0);
+	CHKERR(sdr_begin_xn(sdr));
+	spanObj = sdr_list_data(sdr, vspan->spanElt);
+	sdr_stage(sdr, (char *) &spanBuf, spanObj, sizeof(LtpSpan));
+	elt = sdr_list_first(sdr, spanBuf.segments);
+	while (elt == 0 || vspan->localXmitRate == 0)
+	{
+		sdr_exit_xn(sdr);
+
+		/*	Wait until ltpmeter has announced an outbound
+		 *	segment by giving span's segSemaphore.		*/
+
+		if (sm_SemTake(vspan->segSemaphore) < 0)
+		{
+			putErrmsg("LSO can't take segment semaphore.",
+					itoa(vspan->engineId));
+			return -1;
+		}
+
+		if (sm_SemEnded(vspan->segSemaphore))
+		{
+			isprintf(memo, sizeof memo,
+			"[i] LSO to engine " UVAST_FIELDSPEC " is stopped.",
+					vspan->engineId);
+			writeMemo(memo);
+			return 0;
+		}
+
+		CHKERR(sdr_begin_xn(sdr));
+		sdr_stage(sdr, (char *) &spanBuf, spanObj, sizeof(LtpSpan));
+		elt = sdr_list_first(sdr, spanBuf.segments);
+	}
+
+	/*	Serialize as many of the queued segments as will fit
+	 *	in the batch, all in this one transaction.  Segments
+	 *	of closed sessions are discarded without using up any
+	 *	of the caller's buffers.				*/
+
+	while (elt && count < maxCount && vspan->localXmitRate > 0)
+	{
+		segmentLength = serializeOutboundSegment(vspan, spanObj,
+				&spanBuf, elt, bufs[count], bufLength,
+				bytesAhead);
+		if (segmentLength < 0)
+		{
+			putErrmsg("Can't serialize outbound segment.", NULL);
+			sdr_cancel_xn(sdr);
+			return -1;
+		}
+
+		if (segmentLength > 0)
+		{
+			lengths[count] = segmentLength;
+			bytesAhead += segmentLength;
+			count++;
+		}
+
+		sdr_stage(sdr, (char *) &spanBuf, spanObj, sizeof(LtpSpan));
+		elt = sdr_list_first(sdr, spanBuf.segments);
+	}
+
+	if (sdr_end_xn(sdr))
+	{
+		putErrmsg("Can't get outbound segments for span.", NULL);
+		return -1;
+	}
+
+	return count;
+}
+
+int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
+{
+	int	segmentLength;
+
+	CHKERR(vspan);
+	CHKERR(buf);
+	*buf = (char *) psp(getIonwm(), vspan->segmentBuffer);
+	switch (ltpDequeueOutboundSegments(vspan, buf, &segmentLength,
+			vspan->maxXmitSegSize, 1))
+	{
+	case -1:
+		return -1;
+
+	case 0:
+		return 0;		/*	Interrupted.		*/
+
+	default:
+		return segmentLength;
+	}
+}
+
 /*	*	Control segment construction functions		*	*/
 
 static void	signalLso(unsigned int engineId)
@@ -7981,6 +8164,54 @@ int	ltpHandleInboundSegment(char *buf, int length)
 	return result;		/*	Ignore the segment.		*/
 }
 
+int	ltpHandleInboundSegments(char **bufs, int *lengths, int count)
+{
+	Sdr	sdr = getIonsdr();
+	int	i = 0;
+	int	batchEnd;
+
+	CHKERR(bufs);
+	CHKERR(lengths);
+	CHKERR(count >= 0);
+
+	/*	Handle the segments in batches, each within a single
+	 *	enclosing SDR transaction: the transactions begun by
+	 *	ltpHandleInboundSegment are nested within it, so the
+	 *	SDR is locked and the transaction is committed only
+	 *	once per batch.						*/
+
+	while (i < count)
+	{
+		batchEnd = i + LTP_INBOUND_BATCH_SIZE;
+		if (batchEnd > count)
+		{
+			batchEnd = count;
+		}
+
+		CHKERR(sdr_begin_xn(sdr));
+		while (i < batchEnd)
+		{
+			if (ltpHandleInboundSegment(bufs[i], lengths[i]) < 0)
+			{
+				sdr_cancel_xn(sdr);
+				putErrmsg("Can't handle inbound segment batch.",
+						itoa(i));
+				return -1;
+			}
+
+			i++;
+		}
+
+		if (sdr_end_xn(sdr) < 0)
+		{
+			putErrmsg("Can't handle inbound segment batch.", NULL);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 /*	*	*	Functions that respond to events	*	*/
 
 void	ltpStartXmit(LtpVspan *vspan)
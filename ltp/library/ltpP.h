@@ -58,6 +58,27 @@
 #endif	/*	End of #if (defined(linux) && !(defined(bionic)))	*/
 #endif	/*	End if #ifdef UDP_MULTISEND				*/
 
+/*	LTP_INBOUND_BATCH_SIZE is the maximum number of received
+ *	segments that ltpHandleInboundSegments will handle within
+ *	a single SDR transaction.  Larger batches reduce the number
+ *	of SDR lock acquisitions and log flushes at high segment
+ *	rates but hold the SDR lock longer, delaying other tasks.	*/
+
+#ifndef LTP_INBOUND_BATCH_SIZE
+#define	LTP_INBOUND_BATCH_SIZE	(32)
+#endif
+
+/*	LTP_OUTBOUND_BATCH_SIZE is the maximum number of outbound
+ *	segments that a link service output task obtains from each
+ *	call to ltpDequeueOutboundSegments, i.e., within a single
+ *	SDR transaction.  (In UDP_MULTISEND mode, udplso instead
+ *	dequeues as many segments as it sends in one sendmmsg()
+ *	call; see MULTISEND_BATCH_LIMIT.)				*/
+
+#ifndef LTP_OUTBOUND_BATCH_SIZE
+#define	LTP_OUTBOUND_BATCH_SIZE	(32)
+#endif
+
 #include "rfx.h"
 #include "lyst.h"
 #include "smlist.h"
@@ -515,6 +536,30 @@ typedef struct
 	Tally		tallies[LTP_SPAN_STATS];
 } LtpSpanStats;
 
+/*	An export cursor records the position, within the block of
+ *	an export session, just past the end of the client service
+ *	data most recently copied into a data segment by the LSO
+ *	task.  When the next segment's data begins at that position,
+ *	as it does whenever a block is transmitted for the first
+ *	time, the data are read from the cursor's ZcoReader without
+ *	again locating the segment's SDU in the block's list of
+ *	service data objects and skipping to the segment's offset
+ *	within that SDU; the cursor is repositioned only when the
+ *	LSO task switches sessions or sends a retransmission extent.
+ *	The cursor is only a hint: a cursor that doesn't match the
+ *	segment's session and offset is simply repositioned.		*/
+
+typedef struct
+{
+	unsigned int	sessionNbr;	/*	0 if cursor is unset.	*/
+	Object		svcDataObjects;	/*	The session's block.	*/
+	Object		sduElt;		/*	Current SDU's list elt.	*/
+	unsigned int	sduStart;	/*	Block offset of SDU.	*/
+	unsigned int	sduLength;
+	unsigned int	offset;		/*	Block offset of reader.	*/
+	ZcoReader	reader;
+} LtpExportCursor;
+
 /* The volatile span object encapsulates the current volatile state
  * of the corresponding LtpSpan. 					*/
 
@@ -549,6 +594,7 @@ typedef struct
 	/*	*	*	Work area	*	*	*	*/
 
 	PsmAddress	segmentBuffer;	/*	Holds one max-size seg.	*/
+	LtpExportCursor	exportCursor;	/*	Used only by the LSO.	*/
 
 	/*	The bufOpenRedSemaphore and bufOpenGreenSemaphore
 	 *	of an LtpVspan are given by the span's ltpmeter task
@@ -595,9 +641,10 @@ typedef struct
 	 *	signifies that the LSO task may now obtain a segment
 	 *	from the LtpSpan's segments list and transmit it
 	 *	-- thus eliminating polling from LTP transmission
-	 *	processing.  The ltpDequeueOutboundSegment function
-	 *	takes this semaphore before the LSO task proceeds to
-	 *	transmit the segment via its link service protocol.	*/
+	 *	processing.  The ltpDequeueOutboundSegments function
+	 *	takes this semaphore, when no segment is queued, before
+	 *	the LSO task proceeds to transmit the segments via its
+	 *	link service protocol.					*/
 
 	sm_SemId	segSemaphore;	/*	For outbound segments.	*/
 } LtpVspan;
@@ -779,8 +826,21 @@ extern int		getMaxReports(int redPartLength,
 				LtpVspan *vspan,
 				int asReceiver);
 
+extern int		ltpReadExportBlock(LtpExportCursor *cursor,
+				unsigned int sessionNbr,
+				Object svcDataObjects,
+				unsigned int offset,
+				unsigned int length,
+				char *buffer);
 extern int		ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf);
+extern int		ltpDequeueOutboundSegments(LtpVspan *vspan,
+				char **bufs,
+				int *lengths,
+				int bufLength,
+				int maxCount);
 extern int		ltpHandleInboundSegment(char *buf, int length);
+extern int		ltpHandleInboundSegments(char **bufs, int *lengths,
+				int count);
 
 extern void		ltpStartXmit(LtpVspan *vspan);
 extern void		ltpStopXmit(LtpVspan *vspan);
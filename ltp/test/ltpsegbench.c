@@ -0,0 +1,317 @@
+/*
+
+	ltpsegbench.c:	benchmark for the rate at which the client
+			service data of a large LTP export block can
+			be copied into data segments.
+
+	Builds an export block -- an SDR list of ZCOs, as aggregated
+	by ltp_send -- comprising SDUs of the indicated size that are
+	sourced from successive extents of a single file, and then
+	reads the block's data one segment at a time, in one SDR
+	transaction per segment, exactly as the LSO task does when
+	transmitting the block's data segments.  Reports the rate at
+	which segments are read in sequence, as for the initial
+	transmission of a block, and the rate at which segments at
+	random offsets are read, as for retransmission, verifying
+	the content of every segment.  Must be run on an ION node
+	that is running.
+									*/
+#include "ltpP.h"
+
+#define	DEFAULT_MEGABYTES	(64)
+#define	DEFAULT_SDU_SIZE	(16384)
+#define	DEFAULT_SEGMENT_SIZE	(1400)
+#define	RANDOM_SEGMENTS		(1000)
+#define	FILL_BUFFER_SIZE	(65536)
+#define	TEST_FILE_NAME		"ltpsegbench.dat"
+
+static int	createTestFile(char *fileName, unsigned int length)
+{
+	char		buffer[FILL_BUFFER_SIZE];
+	int		fd;
+	unsigned int	bytesRemaining = length;
+	int		len;
+	int		i;
+
+	for (i = 0; i < FILL_BUFFER_SIZE; i++)
+	{
+		buffer[i] = i & 0xff;
+	}
+
+	fd = iopen(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0)
+	{
+		putSysErrmsg("Can't create test file", fileName);
+		return -1;
+	}
+
+	while (bytesRemaining > 0)
+	{
+		len = (bytesRemaining < FILL_BUFFER_SIZE ? bytesRemaining
+				: FILL_BUFFER_SIZE);
+		if (write(fd, buffer, len) != len)
+		{
+			putSysErrmsg("Can't write test file", fileName);
+			close(fd);
+			return -1;
+		}
+
+		bytesRemaining -= len;
+	}
+
+	close(fd);
+	return 0;
+}
+
+static Object	createBlock(Sdr sdr, char *fileName, unsigned int length,
+			unsigned int sduSize)
+{
+	Object		block;
+	Object		fileRef;
+	Object		zco;
+	unsigned int	offset;
+	unsigned int	sduLength;
+
+	/*	The file is removed when the last ZCO is destroyed.	*/
+
+	CHKZERO(sdr_begin_xn(sdr));
+	block = sdr_list_create(sdr);
+	fileRef = zco_create_file_ref(sdr, fileName, "", ZcoOutbound);
+	if (block == 0 || fileRef == 0)
+	{
+		sdr_cancel_xn(sdr);
+		oK(unlink(fileName));
+		putErrmsg("Can't create export block.", fileName);
+		return 0;
+	}
+
+	for (offset = 0; offset < length; offset += sduLength)
+	{
+		sduLength = (length - offset < sduSize ? length - offset
+				: sduSize);
+		zco = zco_create(sdr, ZcoFileSource, fileRef, offset,
+				sduLength, ZcoOutbound);
+		if (zco == 0 || zco == (Object) ERROR
+		|| sdr_list_insert_last(sdr, block, zco) == 0)
+		{
+			break;
+		}
+	}
+
+	zco_destroy_file_ref(sdr, fileRef);
+	if (sdr_end_xn(sdr) < 0 || offset < length)
+	{
+		putErrmsg("Can't create SDUs.", NULL);
+		return 0;
+	}
+
+	return block;
+}
+
+static void	destroyBlock(Sdr sdr, Object block)
+{
+	Object	elt;
+
+	if (sdr_begin_xn(sdr))
+	{
+		while ((elt = sdr_list_first(sdr, block)) != 0)
+		{
+			zco_destroy(sdr, sdr_list_data(sdr, elt));
+			sdr_list_delete(sdr, elt, NULL, NULL);
+		}
+
+		sdr_list_destroy(sdr, block, NULL, NULL);
+		oK(sdr_end_xn(sdr));
+	}
+}
+
+static int	readSegment(Sdr sdr, LtpExportCursor *cursor, Object block,
+			unsigned int offset, unsigned int length,
+			char *buffer)
+{
+	unsigned int	i;
+
+	CHKERR(sdr_begin_xn(sdr));
+	if (ltpReadExportBlock(cursor, 1, block, offset, length, buffer)
+			!= length)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("Can't read from export block.", utoa(offset));
+		return -1;
+	}
+
+	/*	Reading may record file transmission progress.		*/
+
+	if (sdr_end_xn(sdr) < 0)
+	{
+		putErrmsg("Can't read from export block.", utoa(offset));
+		return -1;
+	}
+
+	for (i = 0; i < length; i++)
+	{
+		if (buffer[i] != (char) ((offset + i) & 0xff))
+		{
+			putErrmsg("Segment content is corrupt.",
+					utoa(offset + i));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void	reportRate(char *label, unsigned long segments,
+			struct timeval *start)
+{
+	struct timeval	end;
+	double		seconds;
+	char		value[64];
+
+	getCurrentTime(&end);
+	seconds = (end.tv_sec - start->tv_sec)
+			+ ((end.tv_usec - start->tv_usec) / 1000000.0);
+	isprintf(value, sizeof value, "%.0f", seconds > 0.0 ?
+			segments / seconds : 0.0);
+	PUTMEMO(label, value);
+}
+
+static int	run_ltpsegbench(unsigned int megabytes, unsigned int sduSize,
+			unsigned int segmentSize)
+{
+	unsigned int	length = megabytes * 1024 * 1024;
+	unsigned int	segmentCount;
+	char		fileName[MAXPATHLEN + 1];
+	char		cwd[MAXPATHLEN + 1];
+	Sdr		sdr;
+	Object		block;
+	LtpExportCursor	cursor;
+	char		*buffer;
+	unsigned int	offset;
+	unsigned int	len;
+	unsigned long	segments = 0;
+	int		failed = 0;
+	struct timeval	start;
+	char		value[80];
+
+	if (igetcwd(cwd, sizeof cwd) == NULL)
+	{
+		putErrmsg("Can't get current working directory.", NULL);
+		return 1;
+	}
+
+	isprintf(fileName, sizeof fileName, "%s%c%s", cwd,
+			ION_PATH_DELIMITER, TEST_FILE_NAME);
+	if (ionAttach() < 0)
+	{
+		putErrmsg("Can't attach to ION.", NULL);
+		return 1;
+	}
+
+	sdr = getIonsdr();
+	buffer = malloc(segmentSize);
+	if (buffer == NULL)
+	{
+		putErrmsg("Can't allocate segment buffer.", NULL);
+		ionDetach();
+		return 1;
+	}
+
+	if (createTestFile(fileName, length) < 0
+	|| (block = createBlock(sdr, fileName, length, sduSize)) == 0)
+	{
+		free(buffer);
+		writeErrmsgMemos();
+		ionDetach();
+		return 1;
+	}
+
+	isprintf(value, sizeof value, "%u MB in %u-byte SDUs, %u-byte \
+segments", megabytes, sduSize, segmentSize);
+	PUTMEMO("Export block", value);
+
+	/*	Initial transmission: segments in sequence.		*/
+
+	memset((char *) &cursor, 0, sizeof(LtpExportCursor));
+	getCurrentTime(&start);
+	for (offset = 0; offset < length; offset += len)
+	{
+		len = (length - offset < segmentSize ? length - offset
+				: segmentSize);
+		if (readSegment(sdr, &cursor, block, offset, len, buffer) < 0)
+		{
+			failed = 1;
+			break;
+		}
+
+		segments++;
+	}
+
+	if (!failed)
+	{
+		reportRate("Sequential segments per second", segments, &start);
+	}
+
+	/*	Retransmission: segments at random offsets.		*/
+
+	segmentCount = (length + segmentSize - 1) / segmentSize;
+	segments = 0;
+	srand(1);
+	getCurrentTime(&start);
+	while (!failed && segments < RANDOM_SEGMENTS)
+	{
+		offset = (rand() % segmentCount) * segmentSize;
+		len = (length - offset < segmentSize ? length - offset
+				: segmentSize);
+		if (readSegment(sdr, &cursor, block, offset, len, buffer) < 0)
+		{
+			failed = 1;
+			break;
+		}
+
+		segments++;
+	}
+
+	if (!failed)
+	{
+		reportRate("Random segments per second", segments, &start);
+	}
+
+	destroyBlock(sdr, block);
+	free(buffer);
+	writeErrmsgMemos();
+	ionDetach();
+	return failed;
+}
+
+#if defined (ION_LWT)
+int	ltpsegbench(saddr a1, saddr a2, saddr a3, saddr a4, saddr a5,
+		saddr a6, saddr a7, saddr a8, saddr a9, saddr a10)
+{
+	unsigned long	megabytes = (a1 == 0 ? DEFAULT_MEGABYTES :
+				strtoul((char *) a1, NULL, 0));
+	unsigned long	sduSize = (a2 == 0 ? DEFAULT_SDU_SIZE :
+				strtoul((char *) a2, NULL, 0));
+	unsigned long	segmentSize = (a3 == 0 ? DEFAULT_SEGMENT_SIZE :
+				strtoul((char *) a3, NULL, 0));
+#else
+int	main(int argc, char **argv)
+{
+	unsigned long	megabytes = (argc > 1 ? strtoul(argv[1], NULL, 0)
+				: DEFAULT_MEGABYTES);
+	unsigned long	sduSize = (argc > 2 ? strtoul(argv[2], NULL, 0)
+				: DEFAULT_SDU_SIZE);
+	unsigned long	segmentSize = (argc > 3 ? strtoul(argv[3], NULL, 0)
+				: DEFAULT_SEGMENT_SIZE);
+#endif
+	if (megabytes == 0 || megabytes > 2048 || sduSize == 0
+	|| segmentSize == 0 || segmentSize > 65536)
+	{
+		PUTS("Usage:  ltpsegbench [<megabytes> [<SDU size> \
+[<segment size>]]]");
+		return 0;
+	}
+
+	return run_ltpsegbench((unsigned int) megabytes,
+			(unsigned int) sduSize, (unsigned int) segmentSize);
+}
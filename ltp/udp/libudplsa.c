@@ -24,7 +24,10 @@ void	*udplsa_handle_datagrams(void *parm)
 	char			*buffers;
 	struct iovec		*iovecs;
 	struct mmsghdr		*msgs;
+	char			*segments[MULTIRECV_BUFFER_COUNT];
+	int			segmentLengths[MULTIRECV_BUFFER_COUNT];
 	unsigned int		batchLength;
+	int			segmentCount;
 	int			i;
 
 	snooze(1);	/*	Let main thread become interruptable.	*/
@@ -88,6 +91,7 @@ void	*udplsa_handle_datagrams(void *parm)
 		}
 
 		buffer = buffers;
+		segmentCount = 0;
 		for (i = 0; i < batchLength; i++)
 		{
 			segmentLength = msgs[i].msg_len;
@@ -99,18 +103,23 @@ void	*udplsa_handle_datagrams(void *parm)
 				break;
 			}
 
-			if (ltpHandleInboundSegment(buffer, segmentLength) < 0)
-			{
-				putErrmsg("Can't handle inbound segment.",
-						NULL);
-				ionKillMainThread(procName);
-				rtp->running = 0;
-				break;
-			}
-
+			segments[segmentCount] = buffer;
+			segmentLengths[segmentCount] = segmentLength;
+			segmentCount++;
 			buffer += (UDPLSA_BUFSZ + 1);
 		}
 
+		/*	Handle all segments received in this batch,
+		 *	in as few SDR transactions as possible.		*/
+
+		if (ltpHandleInboundSegments(segments, segmentLengths,
+				segmentCount) < 0)
+		{
+			putErrmsg("Can't handle inbound segments.", NULL);
+			ionKillMainThread(procName);
+			rtp->running = 0;
+		}
+
 		/*	Make sure other tasks have a chance to run.	*/
 
 		sm_TaskYield();
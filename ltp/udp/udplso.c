@@ -20,6 +20,21 @@
 
 #define IPHDR_SIZE	(sizeof(struct iphdr) + sizeof(struct udphdr))
 
+/*	Where the kernel supports it, udplso stamps each segment
+ *	(SO_TXTIME, CLOCK_MONOTONIC) with the time at which it is to
+ *	depart, as computed from the current transmission rate.  The
+ *	stamp is only advice: the segment is actually held until that
+ *	time only if the outbound interface uses the fq queueing
+ *	discipline; otherwise it departs at once, and the software
+ *	pacing horizon (below) is all that limits the rate.  Build
+ *	with -DUDP_NO_TXTIME to pace by microsnooze only.		*/
+
+#if defined(SO_TXTIME) && !defined(UDP_MULTISEND) && !defined(UDP_NO_TXTIME)
+#define	UDP_TXTIME_PACING
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
+#endif
+
 #elif defined(mingw)
 
 #define IPHDR_SIZE	(20 + 8)
@@ -131,6 +146,10 @@ typedef struct
 	uvast			remoteEngineId;
 	IonNeighbor		*neighbor;
 	unsigned int		prevPaid;
+#ifdef UDP_TXTIME_PACING
+	int			txTimePacing;	/*	Boolean.	*/
+	uvast			nextTxTime;	/*	Nanoseconds.	*/
+#endif
 } RateControlState;
 
 static void	applyRateControl(RateControlState *rc, int bytesSent)
@@ -200,6 +219,172 @@ static void	applyRateControl(RateControlState *rc, int bytesSent)
 	microsnooze(balanceDue);
 	rc->prevPaid = balanceDue;
 }
+
+#ifdef UDP_TXTIME_PACING
+
+/*	When segments are stamped with departure times, udplso itself
+ *	sleeps only when it gets more than UDP_PACING_HORIZON
+ *	microseconds ahead of the departure schedule.  This bounds the
+ *	burst of segments released by an interface whose queueing
+ *	discipline ignores departure times (such as the loopback
+ *	device), while the long-term transmission rate is still the
+ *	configured rate.  The horizon is also the limit on the time
+ *	by which a segment's departure may be advanced to make up for
+ *	lateness of the LSO task itself; such a departure time is in
+ *	the past, which fq treats as "send now".			*/
+
+#ifndef UDP_PACING_HORIZON
+#define	UDP_PACING_HORIZON	(2000)
+#endif
+
+static uvast	getNsecTimestamp()
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (((uvast) ts.tv_sec) * 1000000000) + ts.tv_nsec;
+}
+
+static int	enableTxTimePacing(int linkSocket)
+{
+	struct sock_txtime	txtime;
+
+	/*	A queueing discipline that rejects a segment's departure
+	 *	time (as etf does for CLOCK_MONOTONIC stamps or stamps
+	 *	in the past) drops the segment and, because of
+	 *	SOF_TXTIME_REPORT_ERRORS, reports the drop on the
+	 *	socket's error queue.					*/
+
+	memset((char *) &txtime, 0, sizeof txtime);
+	txtime.clockid = CLOCK_MONOTONIC;
+	txtime.flags = SOF_TXTIME_REPORT_ERRORS;
+	if (setsockopt(linkSocket, SOL_SOCKET, SO_TXTIME, (char *) &txtime,
+			sizeof txtime) < 0)
+	{
+		return 0;		/*	Fall back to microsnooze.	*/
+	}
+
+	return 1;
+}
+
+static int	countTxTimeErrors(int linkSocket)
+{
+	char			control[CMSG_SPACE(sizeof(struct
+					sock_extended_err))];
+	struct msghdr		msg;
+	struct cmsghdr		*cmsg;
+	struct sock_extended_err	*err;
+	int			errors = 0;
+
+	/*	Drain the socket's error queue, counting the segments
+	 *	that were dropped because of their departure times.	*/
+
+	while (1)
+	{
+		memset((char *) &msg, 0, sizeof msg);
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof control;
+		if (recvmsg(linkSocket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+		{
+			return errors;	/*	Queue is empty.		*/
+		}
+
+		for (cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+				cmsg = CMSG_NXTHDR(&msg, cmsg))
+		{
+			err = (struct sock_extended_err *) CMSG_DATA(cmsg);
+			if (err->ee_origin == SO_EE_ORIGIN_TXTIME)
+			{
+				errors++;
+			}
+		}
+	}
+}
+
+static uvast	scheduleTxTime(RateControlState *rc, int bytesToSend)
+{
+	uvast		horizon = UDP_PACING_HORIZON * (uvast) 1000;
+	uvast		currentTime;
+	PsmAddress	nextElt;
+	uvast		txTime;
+
+	if (rc->neighbor == NULL)
+	{
+		rc->neighbor = findNeighbor(getIonVdb(), rc->remoteEngineId,
+				&nextElt);
+	}
+
+	currentTime = getNsecTimestamp();
+	if (rc->neighbor == NULL || rc->neighbor->xmitRate == 0)
+	{
+		/*	No link service rate control.			*/
+
+		rc->nextTxTime = currentTime;
+		return currentTime;
+	}
+
+	txTime = rc->nextTxTime;
+	if (txTime + horizon < currentTime)
+	{
+		txTime = currentTime - horizon;
+	}
+
+	rc->nextTxTime = txTime + ((((uvast) bytesToSend) * 1000000000)
+			/ rc->neighbor->xmitRate);
+	if (txTime > currentTime + horizon)
+	{
+		microsnooze((txTime - currentTime - horizon) / 1000);
+	}
+
+	return txTime;
+}
+
+static int	sendSegmentAtTxTime(int linkSocket, char *from, int length,
+			struct sockaddr_in *destAddr, uvast txTime)
+{
+	char		control[CMSG_SPACE(sizeof(uvast))];
+	struct iovec	iov;
+	struct msghdr	msg;
+	struct cmsghdr	*cmsg;
+	int		bytesWritten;
+
+	iov.iov_base = from;
+	iov.iov_len = length;
+	memset((char *) &msg, 0, sizeof msg);
+	msg.msg_name = destAddr;
+	msg.msg_namelen = sizeof(struct sockaddr_in);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	memset(control, 0, sizeof control);
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof control;
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_TXTIME;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(uvast));
+	memcpy(CMSG_DATA(cmsg), (char *) &txTime, sizeof(uvast));
+	while (1)	/*	Continue until not interrupted.		*/
+	{
+		bytesWritten = sendmsg(linkSocket, &msg, 0);
+		if (bytesWritten < 0)
+		{
+			if (errno == EINTR)	/*	Interrupted.	*/
+			{
+				continue;	/*	Retry.		*/
+			}
+
+			if (errno == ENETUNREACH)
+			{
+				return length;	/*	Just data loss.	*/
+			}
+
+			putSysErrmsg("udplso sendmsg() error", itoa(length));
+		}
+
+		return bytesWritten;
+	}
+}
+#endif	/*	UDP_TXTIME_PACING					*/
 #endif
 
 #if defined (ION_LWT)
@@ -229,22 +414,21 @@ int	main(int argc, char *argv[])
 	socklen_t		nameLength;
 	ReceiverThreadParms	rtp;
 	pthread_t		receiverThread;
-	int			segmentLength;
-	char			*segment;
+	int			bufLength;
+	int			batchLimit;
+	char			*buffers;
+	char			**segments;
+	int			*lengths;
+	int			batchLength;
+	int			i;
 	int			bytesSent;
 	int			fd;
 	char			quit = '\0';
 #ifdef UDP_MULTISEND
 	Object			spanObj;
 	LtpSpan			spanBuf;
-	unsigned int		batchLimit;
-	char			*buffers;
-	char			*buffer;
 	struct iovec		*iovecs;
-	struct iovec		*iovec;
 	struct mmsghdr		*msgs;
-	struct mmsghdr		*msg;
-	unsigned int		batchLength;
 #else
 	RateControlState	rc;
 #endif
@@ -396,19 +580,36 @@ compatibility, but it is ignored.");
 		writeMemo(memoBuf);
 	}
 
-#ifdef UDP_MULTISEND
-	spanObj = sdr_list_data(sdr, vspan->spanElt);
-	sdr_read(sdr, (char *) &spanBuf, spanObj, sizeof(LtpSpan));
+	/*	Segments are dequeued in batches, each batch in a
+	 *	single SDR transaction.  For multi-send, each batch
+	 *	is then sent in a single system call.			*/
+
+	bufLength = vspan->maxXmitSegSize;
+	if (bufLength > UDPLSA_BUFSZ)
+	{
+		bufLength = UDPLSA_BUFSZ;
+	}
 
+#ifdef UDP_MULTISEND
 	/*	For multi-send, we normally send about one LTP block
 	 *	per system call.  But this can be overridden.		*/
 
 #ifdef MULTISEND_BATCH_LIMIT
 	batchLimit = MULTISEND_BATCH_LIMIT;
 #else
+	spanObj = sdr_list_data(sdr, vspan->spanElt);
+	sdr_read(sdr, (char *) &spanBuf, spanObj, sizeof(LtpSpan));
 	batchLimit = spanBuf.aggrSizeLimit / spanBuf.maxSegmentSize;
 #endif
-	buffers = MTAKE(spanBuf.maxSegmentSize * batchLimit);
+#else
+	batchLimit = LTP_OUTBOUND_BATCH_SIZE;
+#endif
+	if (batchLimit < 1)
+	{
+		batchLimit = 1;
+	}
+
+	buffers = MTAKE(bufLength * batchLimit);
 	if (buffers == NULL)
 	{
 		closesocket(rtp.linkSocket);
@@ -416,9 +617,36 @@ compatibility, but it is ignored.");
 		return 1;
 	}
 
+	segments = MTAKE(sizeof(char *) * batchLimit);
+	if (segments == NULL)
+	{
+		MRELEASE(buffers);
+		closesocket(rtp.linkSocket);
+		putErrmsg("No space for segment pointer array.", NULL);
+		return 1;
+	}
+
+	lengths = MTAKE(sizeof(int) * batchLimit);
+	if (lengths == NULL)
+	{
+		MRELEASE(segments);
+		MRELEASE(buffers);
+		closesocket(rtp.linkSocket);
+		putErrmsg("No space for segment length array.", NULL);
+		return 1;
+	}
+
+	for (i = 0; i < batchLimit; i++)
+	{
+		segments[i] = buffers + (i * bufLength);
+	}
+
+#ifdef UDP_MULTISEND
 	iovecs = MTAKE(sizeof(struct iovec) * batchLimit);
 	if (iovecs == NULL)
 	{
+		MRELEASE(lengths);
+		MRELEASE(segments);
 		MRELEASE(buffers);
 		closesocket(rtp.linkSocket);
 		putErrmsg("No space for iovec array.", NULL);
@@ -429,6 +657,8 @@ compatibility, but it is ignored.");
 	if (msgs == NULL)
 	{
 		MRELEASE(iovecs);
+		MRELEASE(lengths);
+		MRELEASE(segments);
 		MRELEASE(buffers);
 		closesocket(rtp.linkSocket);
 		putErrmsg("No space for mmsghdr array.", NULL);
@@ -436,145 +666,148 @@ compatibility, but it is ignored.");
 	}
 
 	memset(msgs, 0, sizeof(struct mmsghdr) * batchLimit);
-	batchLength = 0;
-	buffer = buffers;
+	for (i = 0; i < batchLimit; i++)
+	{
+		iovecs[i].iov_base = segments[i];
+		msgs[i].msg_hdr.msg_name = (struct sockaddr *) peerInetName;
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr);
+		msgs[i].msg_hdr.msg_iov = iovecs + i;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
 	while (rtp.running && !(sm_SemEnded(vspan->segSemaphore)))
 	{
-		if (sdr_list_length(sdr, spanBuf.segments) == 0)
+		batchLength = ltpDequeueOutboundSegments(vspan, segments,
+				lengths, bufLength, batchLimit);
+		if (batchLength < 0)
 		{
-			/*	No segments ready to append to batch.	*/
-
-			microsnooze(100000);	/*	Wait .1 sec.	*/
-			if (sdr_list_length(sdr, spanBuf.segments) == 0)
-			{
-				/*	Still nothing read to add to
-				 *	batch.  Send partial batch,
-				 *	if any.				*/
-
-				if (batchLength > 0)
-				{
-					bytesSent = sendBatch(rtp.linkSocket,
-							msgs, batchLength);
-					if (bytesSent < 0)
-					{
-						putErrmsg("Failed sending \
-segment batch.", NULL);
-						rtp.running = 0;
-						continue;
-					}
-
-					batchLength = 0;
-					buffer = buffers;
-
-					/*	Let other tasks run.	*/
-
-					sm_TaskYield();
-				}
-				else
-				{
-					snooze(1);
-				}
-			}
-
-			/*	Now see if a segment is waiting.	*/
-
+			rtp.running = 0;	/*	Terminate LSO.	*/
 			continue;
 		}
 
-		/*	A segment is waiting to be appended to batch.	*/
-
-		segmentLength = ltpDequeueOutboundSegment(vspan, &segment);
-		if (segmentLength < 0)
+		if (batchLength == 0)		/*	Interrupted.	*/
 		{
-			rtp.running = 0;	/*	Terminate LSO.	*/
 			continue;
 		}
 
-		if (segmentLength == 0)		/*	Interrupted.	*/
+		for (i = 0; i < batchLength; i++)
 		{
-			continue;
+			iovecs[i].iov_len = lengths[i];
 		}
 
-		/*	Append this segment to current batch.		*/
-
-		memcpy(buffer, segment, segmentLength);
-		iovec = iovecs + batchLength;
-		iovec->iov_base = buffer;
-		iovec->iov_len = segmentLength;
-		msg = msgs + batchLength;
-		msg->msg_hdr.msg_name = (struct sockaddr *) peerInetName;
-		msg->msg_hdr.msg_namelen = sizeof(struct sockaddr);
-		msg->msg_hdr.msg_iov = iovec;
-		msg->msg_hdr.msg_iovlen = 1;
-		batchLength++;
-		buffer += spanBuf.maxSegmentSize;
-		if (batchLength >= batchLimit)
+		bytesSent = sendBatch(rtp.linkSocket, msgs, batchLength);
+		if (bytesSent < 0)
 		{
-			bytesSent = sendBatch(rtp.linkSocket, msgs,
-					batchLength);
-			if (bytesSent < 0)
-			{
-				putErrmsg("Failed sending segment batch.",
-						NULL);
-				rtp.running = 0;
-				continue;
-			}
-
-			batchLength = 0;
-			buffer = buffers;
+			putErrmsg("Failed sending segment batch.", NULL);
+			rtp.running = 0;
+			continue;
+		}
 
-			/*	Let other tasks run.			*/
+		/*	Let other tasks run.				*/
 
-			sm_TaskYield();
-		}
+		sm_TaskYield();
 	}
 
 	MRELEASE(msgs);
 	MRELEASE(iovecs);
-	MRELEASE(buffers);
 #else
 	rc.startTimestamp = getUsecTimestamp();
 	rc.prevPaid = 0;
 	rc.remoteEngineId = remoteEngineId;
 	rc.neighbor = NULL;
+#ifdef UDP_TXTIME_PACING
+	rc.nextTxTime = 0;
+	rc.txTimePacing = enableTxTimePacing(rtp.linkSocket);
+	if (rc.txTimePacing)
+	{
+		writeMemo("[i] udplso stamps segments with departure times \
+(SO_TXTIME); the kernel paces them only if the interface uses the fq qdisc.");
+	}
+#endif
 	while (rtp.running && !(sm_SemEnded(vspan->segSemaphore)))
 	{
-		segmentLength = ltpDequeueOutboundSegment(vspan, &segment);
-		if (segmentLength < 0)
+		/*	Dequeue no more segments at a time than can be
+		 *	radiated in about a tenth of a second, so that
+		 *	segments enqueued later (such as reports) are
+		 *	not delayed for long at low transmission rates.	*/
+
+		batchLength = vspan->localXmitRate / (bufLength * 10);
+		if (batchLength < 1)
 		{
-			rtp.running = 0;	/*	Terminate LSO.	*/
-			continue;
+			batchLength = 1;
 		}
-
-		if (segmentLength == 0)		/*	Interrupted.	*/
+		else if (batchLength > batchLimit)
 		{
-			continue;
+			batchLength = batchLimit;
 		}
 
-		if (segmentLength > UDPLSA_BUFSZ)
+		batchLength = ltpDequeueOutboundSegments(vspan, segments,
+				lengths, bufLength, batchLength);
+		if (batchLength < 0)
 		{
-			putErrmsg("Segment is too big for UDP LSO.",
-					itoa(segmentLength));
 			rtp.running = 0;	/*	Terminate LSO.	*/
 			continue;
 		}
 
-		bytesSent = sendSegmentByUDP(rtp.linkSocket, segment,
-				segmentLength, peerInetName);
-		if (bytesSent < segmentLength)
+		if (batchLength == 0)		/*	Interrupted.	*/
 		{
-			rtp.running = 0;	/*	Terminate LSO.	*/
 			continue;
 		}
 
-		bytesSent += IPHDR_SIZE;
-		applyRateControl(&rc, bytesSent);
+		for (i = 0; i < batchLength; i++)
+		{
+#ifdef UDP_TXTIME_PACING
+			if (rc.txTimePacing)
+			{
+				bytesSent = sendSegmentAtTxTime(rtp.linkSocket,
+					segments[i], lengths[i], peerInetName,
+					scheduleTxTime(&rc,
+					lengths[i] + IPHDR_SIZE));
+				if (bytesSent < lengths[i])
+				{
+					rtp.running = 0;
+					break;
+				}
+
+				continue;
+			}
+#endif
+			bytesSent = sendSegmentByUDP(rtp.linkSocket,
+					segments[i], lengths[i], peerInetName);
+			if (bytesSent < lengths[i])
+			{
+				rtp.running = 0;	/*	Terminate LSO.	*/
+				break;
+			}
+
+			bytesSent += IPHDR_SIZE;
+			applyRateControl(&rc, bytesSent);
+		}
+#ifdef UDP_TXTIME_PACING
+		if (rc.txTimePacing && countTxTimeErrors(rtp.linkSocket) > 0)
+		{
+			/*	The queueing discipline is dropping
+			 *	segments for their departure times.
+			 *	LTP will retransmit the lost data; stop
+			 *	stamping and pace by microsnooze.	*/
+
+			writeMemo("[?] udplso segments dropped by qdisc for \
+their SO_TXTIME stamps; pacing by microsnooze instead.");
+			rc.txTimePacing = 0;
+			rc.startTimestamp = getUsecTimestamp();
+			rc.prevPaid = 0;
+		}
+#endif
 
 		/*	Let other tasks run.				*/
 
 		sm_TaskYield();
 	}
 #endif
+	MRELEASE(lengths);
+	MRELEASE(segments);
+	MRELEASE(buffers);
+
 	/*	Time to shut down.					*/
 
 	rtp.running = 0;
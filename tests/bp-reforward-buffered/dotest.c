@@ -0,0 +1,158 @@
+/* Test for DEQUEUE-time processing of reforwarded bundles.
+ *
+ * Sends a bundle to neighbor node 2, whose outduct has no CLO, so
+ * the bundle waits in the outduct's transmission buffer.  Reforwards
+ * the buffered bundle twice, as flushing the buffer of a reliable
+ * outduct does, then dequeues it as a CLO would.  The dequeued
+ * bundle's hop count must have been incremented exactly once and it
+ * must carry exactly one BIB.					*/
+
+#include <bpP.h>
+#include <bei.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	DUCT_PROTOCOL	"udp"
+#define	DUCT_NAME	"127.0.0.1:4556"
+
+static char	srcEid[] = "ipn:1.1";
+static char	destEid[] = "ipn:2.1";
+static char	testLine[] = "Reforwarded bundle";
+
+static Object	bufferedBundle(Sdr sdr, VOutduct *vduct)
+{
+	Object	outductObj;
+	Outduct	outduct;
+	Object	elt;
+	Object	bundleObj;
+	int	i;
+
+	/*	Wait for bpclm to put the bundle into the buffer.	*/
+
+	for (i = 0; i < 100; i++)
+	{
+		CHKZERO(sdr_begin_xn(sdr));
+		outductObj = sdr_list_data(sdr, vduct->outductElt);
+		sdr_read(sdr, (char *) &outduct, outductObj, sizeof(Outduct));
+		elt = sdr_list_first(sdr, outduct.xmitBuffer);
+		bundleObj = elt ? sdr_list_data(sdr, elt) : 0;
+		sdr_exit_xn(sdr);
+		if (bundleObj)
+		{
+			return bundleObj;
+		}
+
+		microsnooze(100000);
+	}
+
+	return 0;
+}
+
+static int	countBlocks(Sdr sdr, Bundle *bundle, BpBlockType type)
+{
+	Object		elt;
+	ExtensionBlock	blk;
+	int		count = 0;
+
+	for (elt = sdr_list_first(sdr, bundle->extensions); elt;
+			elt = sdr_list_next(sdr, elt))
+	{
+		sdr_read(sdr, (char *) &blk, sdr_list_data(sdr, elt),
+				sizeof(ExtensionBlock));
+		if (blk.type == type)
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+int main(int argc, char **argv)
+{
+	Sdr		sdr;
+	BpSAP		sap;
+	VOutduct	*vduct;
+	PsmAddress	vductElt;
+	Object		extent;
+	Object		zco;
+	Object		newBundle;
+	Object		bundleObj;
+	Object		bundleZco;
+	BpAncillaryData	ancillaryData;
+	Bundle		bundle;
+	ExtensionDef	*def;
+	ExtensionBlock	blk;
+	int		i;
+
+	ionstart("reforward.ionrc", "reforward.ionsecrc", NULL,
+			"reforward.bprc", NULL, NULL);
+	_xadmin("bpsecadmin", "", "reforward.bpsecrc");
+	fail_unless(bp_attach() >= 0);
+	sdr = bp_get_sdr();
+	findOutduct(DUCT_PROTOCOL, DUCT_NAME, &vduct, &vductElt);
+	fail_unless(vductElt != 0, "Can't find outduct.");
+
+	/*	Send the bundle and wait for it to be buffered.		*/
+
+	CHKZERO(sdr_begin_xn(sdr));
+	extent = sdr_malloc(sdr, sizeof(testLine) - 1);
+	fail_unless(extent != 0);
+	sdr_write(sdr, extent, testLine, sizeof(testLine) - 1);
+	zco = ionCreateZco(ZcoSdrSource, extent, 0, sizeof(testLine) - 1,
+			0, 0, 0, NULL);
+	fail_unless(sdr_end_xn(sdr) >= 0 && zco != 0);
+	fail_unless(bp_open(srcEid, &sap) >= 0);
+	fail_unless(bp_send(sap, destEid, NULL, 300, BP_STD_PRIORITY,
+			NoCustodyRequested, 0, 0, NULL, zco, &newBundle) > 0);
+	bundleObj = bufferedBundle(sdr, vduct);
+	fail_unless(bundleObj != 0, "Bundle was never buffered.");
+
+	/*	The hop count block is not offered by default, so
+	 *	attach one to the buffered bundle.			*/
+
+	def = findExtensionDef(HopCountBlk);
+	fail_unless(def != NULL && def->offer != NULL);
+	CHKZERO(sdr_begin_xn(sdr));
+	sdr_stage(sdr, (char *) &bundle, bundleObj, sizeof(Bundle));
+	memset((char *) &blk, 0, sizeof(ExtensionBlock));
+	blk.type = HopCountBlk;
+	blk.crcType = NoCRC;
+	fail_unless(def->offer(&blk, &bundle) >= 0);
+	fail_unless(attachExtensionBlock(HopCountBlk, &blk, &bundle) != 0);
+	sdr_write(sdr, bundleObj, (char *) &bundle, sizeof(Bundle));
+	fail_unless(sdr_end_xn(sdr) >= 0);
+
+	/*	Reforward it from the buffer, twice.			*/
+
+	for (i = 0; i < 2; i++)
+	{
+		CHKZERO(sdr_begin_xn(sdr));
+		fail_unless(bpReforwardBundle(bundleObj) >= 0);
+		fail_unless(sdr_end_xn(sdr) >= 0);
+		fail_unless(bufferedBundle(sdr, vduct) == bundleObj,
+				"Reforwarded bundle was not rebuffered.");
+	}
+
+	/*	Dequeue it, accepting stewardship so that the bundle
+	 *	survives for inspection.				*/
+
+	fail_unless(bpDequeue(vduct, &bundleZco, &ancillaryData, -1) >= 0);
+	fail_unless(bundleZco > 1, "Bundle was not dequeued.");
+	CHKZERO(sdr_begin_xn(sdr));
+	sdr_read(sdr, (char *) &bundle, bundleObj, sizeof(Bundle));
+	fail_unless(bundle.hopCount == 1, "Hop count is %u, not 1.",
+			bundle.hopCount);
+	fail_unless(countBlocks(sdr, &bundle, HopCountBlk) == 1);
+	fail_unless(countBlocks(sdr, &bundle, BlockIntegrityBlk) == 1,
+			"Bundle has %d BIBs, not 1.",
+			countBlocks(sdr, &bundle, BlockIntegrityBlk));
+	sdr_exit_xn(sdr);
+	fail_unless(bpHandleXmitSuccess(bundleZco) >= 0);
+
+	bp_close(sap);
+	writeErrmsgMemos();
+	bp_detach();
+	ionstop();
+	CHECK_FINISH;
+}
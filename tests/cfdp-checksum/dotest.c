@@ -0,0 +1,108 @@
+/* Test for the block CFDP checksum computation.
+ *
+ * Checks that adding a block of file data to a CFDP modular checksum
+ * in one call produces the same checksum and final file offset as
+ * adding the data one octet at a time, for blocks of many lengths,
+ * memory alignments, and starting file offsets, including checksums
+ * accumulated over several calls.  Also checks that the CRC-32C
+ * checksum of a block matches the checksum accumulated octet by
+ * octet.								*/
+
+#include <platform.h>
+#include <cfdpP.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	BUFFER_SIZE	(4096)
+
+static unsigned int	modularReference(unsigned char *data, int length,
+				vast fileOffset)
+{
+	unsigned int	checksum = 0;
+
+	while (length > 0)
+	{
+		checksum += ((unsigned int) *data)
+				<< ((3 - (fileOffset & 0x03)) << 3);
+		data++;
+		fileOffset++;
+		length--;
+	}
+
+	return checksum;
+}
+
+int	main(int argc, char **argv)
+{
+	static unsigned char	buffer[BUFFER_SIZE];
+	int			align;
+	int			start;
+	int			length;
+	int			split;
+	int			i;
+	vast			offset;
+	unsigned int		expected;
+	unsigned int		checksum;
+
+	srand(1);
+	for (i = 0; i < BUFFER_SIZE; i++)
+	{
+		buffer[i] = rand();
+	}
+
+	for (align = 0; align < 8; align++)
+	{
+		for (start = 0; start < 8; start++)
+		{
+			for (length = 0; length < BUFFER_SIZE - align;
+					length += (length < 300 ? 1 : 97))
+			{
+				expected = modularReference(buffer + align,
+						length, start);
+
+				offset = start;
+				checksum = 0;
+				addDataToChecksum(buffer + align, length,
+						&offset, &checksum,
+						ModularChecksum);
+				fail_unless(checksum == expected);
+				fail_unless(offset == start + length);
+
+				/*	Accumulating over two calls.	*/
+
+				split = length / 3;
+				offset = start;
+				checksum = 0;
+				addDataToChecksum(buffer + align, split,
+						&offset, &checksum,
+						ModularChecksum);
+				addDataToChecksum(buffer + align + split,
+						length - split, &offset,
+						&checksum, ModularChecksum);
+				fail_unless(checksum == expected);
+				fail_unless(offset == start + length);
+			}
+		}
+	}
+
+	/*	CRC-32C of a block equals CRC-32C built up per octet.	*/
+
+	for (length = 0; length < BUFFER_SIZE; length += 61)
+	{
+		offset = 0;
+		expected = 0;
+		for (i = 0; i < length; i++)
+		{
+			addDataToChecksum(buffer + i, 1, &offset, &expected,
+					CRC32CChecksum);
+		}
+
+		offset = 0;
+		checksum = 0;
+		addDataToChecksum(buffer, length, &offset, &checksum,
+				CRC32CChecksum);
+		fail_unless(checksum == expected);
+	}
+
+	CHECK_FINISH;
+}
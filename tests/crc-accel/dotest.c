@@ -0,0 +1,116 @@
+/* Test for the processor-accelerated CRC functions.
+ *
+ * Checks that the standard check values are computed with and without
+ * processor CRC instructions, and that every supported combination of
+ * those instructions computes the same CRCs as the lookup tables for
+ * buffers of many lengths and alignments, including CRCs accumulated
+ * over several calls.							*/
+
+#include <platform.h>
+#include <crc.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	BUFFER_SIZE	(4096)
+
+static char	check[] = "123456789";
+
+static uint32_t	crc32c(const char *data, uint32_t dLen, uint32_t crc)
+{
+#ifdef ENABLE_HIGH_SPEED
+	return ion_CRC32_1EDC6F41_C_slice(data, dLen, crc);
+#else
+	return ion_CRC32_1EDC6F41_C(data, dLen, crc);
+#endif
+}
+
+static uint32_t	crc32(const char *data, uint32_t dLen, uint32_t crc)
+{
+#ifdef ENABLE_HIGH_SPEED
+	return ion_CRC32_04C11DB7_slice(data, dLen, crc);
+#else
+	return ion_CRC32_04C11DB7(data, dLen, crc);
+#endif
+}
+
+static void	checkValues()
+{
+	fail_unless(ion_CRC16_1021_X25(check, 9, 0) == 0x906e);
+	fail_unless(crc32c(check, 9, 0) == 0xe3069283);
+	fail_unless(crc32(check, 9, 0) == 0xcbf43926);
+}
+
+int	main(int argc, char **argv)
+{
+	static char	buffer[BUFFER_SIZE];
+	int		supported;
+	int		features;
+	int		offset;
+	int		length;
+	int		split;
+	int		i;
+	uint16_t	crc16Table;
+	uint32_t	crc32cTable;
+	uint32_t	crc32Table;
+	uint16_t	crc16Accumulated;
+
+	srand(1);
+	for (i = 0; i < BUFFER_SIZE; i++)
+	{
+		buffer[i] = rand();
+	}
+
+	supported = ion_CRC_hw_accel(-1);
+	checkValues();
+	for (features = 0; features <= supported; features++)
+	{
+		if ((features & supported) != features)
+		{
+			continue;
+		}
+
+		for (offset = 0; offset < 8; offset++)
+		{
+			for (length = 0; length < BUFFER_SIZE - offset;
+					length += (length < 300 ? 1 : 97))
+			{
+				oK(ion_CRC_hw_accel(0));
+				crc16Table = ion_CRC16_1021_X25(buffer + offset,
+						length, 0);
+				crc32cTable = crc32c(buffer + offset, length,
+						0);
+				crc32Table = crc32(buffer + offset, length, 0);
+				fail_unless(ion_CRC_hw_accel(features)
+						== features);
+				fail_unless(ion_CRC16_1021_X25(buffer + offset,
+						length, 0) == crc16Table);
+				fail_unless(crc32c(buffer + offset, length, 0)
+						== crc32cTable);
+				fail_unless(crc32(buffer + offset, length, 0)
+						== crc32Table);
+
+				/*	Accumulating over two calls.	*/
+
+				split = length / 3;
+				crc16Accumulated = ion_CRC16_1021_X25(buffer
+						+ offset, split, 0);
+				fail_unless(ion_CRC16_1021_X25(buffer + offset
+						+ split, length - split,
+						crc16Accumulated) == crc16Table);
+				fail_unless(crc32c(buffer + offset + split,
+						length - split, crc32c(buffer
+						+ offset, split, 0))
+						== crc32cTable);
+				fail_unless(crc32(buffer + offset + split,
+						length - split, crc32(buffer
+						+ offset, split, 0))
+						== crc32Table);
+			}
+		}
+
+		checkValues();
+	}
+
+	oK(ion_CRC_hw_accel(-1));
+	CHECK_FINISH;
+}
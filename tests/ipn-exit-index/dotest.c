@@ -0,0 +1,151 @@
+/* Test for the IPN exit index.
+ *
+ * Adds exits with randomly chosen, nested and overlapping, node
+ * ranges and checks that, for every node number, ipn_lookupExit
+ * selects the gateway of the narrowest exit that encompasses it
+ * (or of the first such exit in node number order, among exits of
+ * the same size), as a search of all the exits would.  Then checks
+ * the same after some of the exits are removed.		*/
+
+#include <ipnfw.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	EXITS		(300)
+#define	MAX_NODE_NBR	(10000)
+
+typedef struct
+{
+	uvast	firstNodeNbr;
+	uvast	lastNodeNbr;
+	int	gateway;
+	int	removed;
+} TestExit;
+
+static TestExit	exits[EXITS + 1];
+static int	exitCount = 0;
+
+static int	expectedGateway(uvast nodeNbr)
+{
+	TestExit	*best = NULL;
+	TestExit	*exit;
+	int		i;
+
+	for (i = 0; i < exitCount; i++)
+	{
+		exit = exits + i;
+		if (exit->removed || exit->firstNodeNbr > nodeNbr
+		|| exit->lastNodeNbr < nodeNbr)
+		{
+			continue;
+		}
+
+		if (best == NULL
+		|| exit->lastNodeNbr - exit->firstNodeNbr
+			< best->lastNodeNbr - best->firstNodeNbr
+		|| (exit->lastNodeNbr - exit->firstNodeNbr
+			== best->lastNodeNbr - best->firstNodeNbr
+			&& exit->firstNodeNbr < best->firstNodeNbr))
+		{
+			best = exit;
+		}
+	}
+
+	return (best ? best->gateway : 0);
+}
+
+static int	lookedUpGateway(Sdr sdr, uvast nodeNbr)
+{
+	char	eid[SDRSTRING_BUFSZ];
+	int	found;
+	int	gateway = 0;
+
+	CHKZERO(sdr_begin_xn(sdr));
+	found = ipn_lookupExit(nodeNbr, eid);
+	sdr_exit_xn(sdr);
+	if (found == 1)
+	{
+		fail_unless(sscanf(eid, "ipn:%d.0", &gateway) == 1);
+	}
+
+	return gateway;
+}
+
+static void	addExit(uvast firstNodeNbr, uvast lastNodeNbr)
+{
+	char	eid[32];
+	int	gateway = exitCount + 1;
+
+	isprintf(eid, sizeof eid, "ipn:%d.0", gateway);
+	if (ipn_addExit(firstNodeNbr, lastNodeNbr, eid) == 1)
+	{
+		exits[exitCount].firstNodeNbr = firstNodeNbr;
+		exits[exitCount].lastNodeNbr = lastNodeNbr;
+		exits[exitCount].gateway = gateway;
+		exits[exitCount].removed = 0;
+		exitCount++;
+	}
+}
+
+static void	checkAllNodes(Sdr sdr, char *when)
+{
+	uvast	nodeNbr;
+	int	mismatches = 0;
+
+	for (nodeNbr = 1; nodeNbr <= MAX_NODE_NBR + 1; nodeNbr++)
+	{
+		if (lookedUpGateway(sdr, nodeNbr) != expectedGateway(nodeNbr))
+		{
+			mismatches++;
+		}
+	}
+
+	fail_unless(mismatches == 0, "Wrong exit for %d nodes %s.",
+			mismatches, when);
+	fail_unless(lookedUpGateway(sdr, (uvast) -1)
+			== expectedGateway((uvast) -1));
+}
+
+int main(int argc, char **argv)
+{
+	Sdr	sdr;
+	uvast	first;
+	uvast	last;
+	int	i;
+
+	_xadmin("ionadmin", "", "exit.ionrc");
+	sleep(2);
+	fail_unless(ionAttach() >= 0);
+	fail_unless(ipnInit() >= 0);
+	sdr = getIonsdr();
+	fail_unless(lookedUpGateway(sdr, 1) == 0, "Exit found with no exits.");
+
+	/*	Mostly narrow ranges, some wide ones, one that extends
+	 *	to the largest node number.				*/
+
+	srand(1);
+	while (exitCount < EXITS - 1)
+	{
+		first = 1 + (rand() % MAX_NODE_NBR);
+		last = first + (rand() % (exitCount % 10 == 0 ? 5000 : 50));
+		addExit(first, last);
+	}
+
+	addExit(MAX_NODE_NBR / 2, (uvast) -1);
+	fail_unless(exitCount == EXITS);
+	checkAllNodes(sdr, "after adding exits");
+
+	/*	Remove every third exit.				*/
+
+	for (i = 0; i < exitCount; i += 3)
+	{
+		fail_unless(ipn_removeExit(exits[i].firstNodeNbr,
+				exits[i].lastNodeNbr) == 1);
+		exits[i].removed = 1;
+	}
+
+	checkAllNodes(sdr, "after removing exits");
+	ionDetach();
+	ionstop();
+	CHECK_FINISH;
+}
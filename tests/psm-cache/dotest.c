@@ -0,0 +1,224 @@
+/* Test for the per-process PSM small-block cache.
+ *
+ * Checks that small blocks freed by a process are cached and reused
+ * by that process, that psm_usage counts cached blocks as free, that
+ * psm_audit accepts the cache after heavy multi-threaded churn, and
+ * that psm_flush_cache returns every cached block to the partition,
+ * and that the cache of a process that exits without flushing is
+ * reclaimed the next time the partition is managed.			*/
+
+#include <sys/wait.h>
+#include <psm.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	PARTITION_SIZE	(1024 * 1024)
+#define	BLOCKS		(100)
+#define	THREADS		(4)
+#define	CHURNS		(20000)
+
+static PsmPartition	wm = NULL;
+
+static void	*churn(void *parm)
+{
+	PsmAddress	held[16];
+	unsigned int	seed = (unsigned int) (uaddr) parm;
+	int		i;
+	int		j;
+
+	memset((char *) held, 0, sizeof held);
+	for (i = 0; i < CHURNS; i++)
+	{
+		j = rand_r(&seed) % 16;
+		if (held[j])
+		{
+			psm_free(wm, held[j]);
+			held[j] = 0;
+		}
+		else
+		{
+			held[j] = psm_zalloc(wm, 1 + (rand_r(&seed) % 200));
+		}
+	}
+
+	for (j = 0; j < 16; j++)
+	{
+		if (held[j])
+		{
+			psm_free(wm, held[j]);
+		}
+	}
+
+	return NULL;
+}
+
+static size_t	cachedBlocks(PsmUsageSummary *usage)
+{
+	size_t	total = 0;
+	int	i;
+
+	for (i = 0; i < SMALL_SIZES; i++)
+	{
+		total += usage->smallPoolCachedBlockCount[i];
+	}
+
+	return total;
+}
+
+static size_t	freeBlocks(PsmUsageSummary *usage)
+{
+	size_t	total = 0;
+	int	i;
+
+	for (i = 0; i < SMALL_SIZES; i++)
+	{
+		total += usage->smallPoolFreeBlockCount[i];
+	}
+
+	return total;
+}
+
+/*	Runs in a separate process (ION task identity is the pid as
+ *	of first use, so the child must be exec'd rather than simply
+ *	forked): fill this process's cache, then exit without flushing.	*/
+
+static int	fillCacheAndExit(int key)
+{
+	char		*space = NULL;
+	uaddr		id;
+	PsmMgtOutcome	outcome;
+	PsmAddress	blocks[BLOCKS];
+	PsmUsageSummary	usage;
+	int		i;
+
+	if (sm_ipc_init() < 0
+	|| sm_ShmAttach(key, PARTITION_SIZE, &space, &id) < 0
+	|| psm_manage(space, PARTITION_SIZE, "psmcache", &wm, &outcome) < 0
+	|| outcome != Redundant)
+	{
+		return 1;
+	}
+
+	for (i = 0; i < BLOCKS; i++)
+	{
+		blocks[i] = psm_zalloc(wm, 24);
+	}
+
+	for (i = 0; i < BLOCKS; i++)
+	{
+		psm_free(wm, blocks[i]);
+	}
+
+	psm_usage(wm, &usage);
+	return (cachedBlocks(&usage) > 0 ? 0 : 1);
+}
+
+int	main(int argc, char **argv)
+{
+	char		*space = NULL;
+	PsmMgtOutcome	outcome;
+	PsmAddress	blocks[BLOCKS];
+	PsmAddress	block;
+	PsmUsageSummary	usage;
+	size_t		freeBefore;
+	pthread_t	threads[THREADS];
+	int		key;
+	uaddr		id;
+	pid_t		pid;
+	int		status;
+	int		i;
+
+	if (argc > 1)
+	{
+		return fillCacheAndExit(atoi(argv[1]));
+	}
+
+	fail_unless(sm_ipc_init() == 0);
+	key = sm_GetUniqueKey();
+	fail_unless(sm_ShmAttach(key, PARTITION_SIZE, &space, &id) >= 0);
+	fail_unless(psm_manage(space, PARTITION_SIZE, "psmcache", &wm,
+			&outcome) == 0 && outcome == Okay);
+
+	/*	Freed blocks are cached and reused.			*/
+
+	for (i = 0; i < BLOCKS; i++)
+	{
+		blocks[i] = psm_zalloc(wm, 24);
+		fail_unless(blocks[i] != 0);
+	}
+
+	for (i = 0; i < BLOCKS; i++)
+	{
+		psm_free(wm, blocks[i]);
+	}
+
+	psm_usage(wm, &usage);
+	fail_unless(cachedBlocks(&usage) > 0, "No blocks were cached.");
+	fail_unless(usage.smallPoolFree + usage.smallPoolAllocated
+			== usage.smallPoolSize);
+	block = psm_zalloc(wm, 24);
+	fail_unless(block == blocks[BLOCKS - 1], "Cached block not reused.");
+	psm_free(wm, block);
+	psm_audit(wm);
+
+	/*	Several threads contend for the cache.			*/
+
+	for (i = 0; i < THREADS; i++)
+	{
+		pthread_begin(&threads[i], NULL, churn, (void *) (uaddr) (i + 1),
+				"churn");
+	}
+
+	for (i = 0; i < THREADS; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	psm_audit(wm);
+	psm_usage(wm, &usage);
+	fail_unless(usage.smallPoolFree + usage.smallPoolAllocated
+			== usage.smallPoolSize);
+
+	/*	Flushing empties the cache, and every small block is
+	 *	then on a free list again.				*/
+
+	freeBefore = freeBlocks(&usage) + cachedBlocks(&usage);
+	psm_flush_cache(wm);
+	psm_usage(wm, &usage);
+	fail_unless(cachedBlocks(&usage) == 0, "Cache not flushed.");
+	fail_unless(usage.smallPoolCached == 0);
+	fail_unless(freeBlocks(&usage) == freeBefore,
+			"Cached blocks lost in flush.");
+	psm_audit(wm);
+
+	/*	A child process fills its own cache and exits without
+	 *	flushing; managing the partition again reclaims it.	*/
+
+	pid = fork();
+	fail_unless(pid >= 0);
+	if (pid == 0)
+	{
+		execl(argv[0], argv[0], itoa(key), NULL);
+		_exit(1);
+	}
+
+	/*	SIGCHLD is ignored, so the child is reaped implicitly;
+	 *	success is evident from the cache it leaves behind.	*/
+
+	oK(waitpid(pid, &status, 0));
+	psm_usage(wm, &usage);
+	fail_unless(cachedBlocks(&usage) > 0, "Child's cache not retained.");
+	fail_unless(psm_manage(space, PARTITION_SIZE, "psmcache", &wm,
+			&outcome) == 0 && outcome == Redundant);
+	psm_usage(wm, &usage);
+	fail_unless(cachedBlocks(&usage) == 0, "Child's cache not reclaimed.");
+	fail_unless(usage.smallPoolCached == 0);
+	fail_unless(freeBlocks(&usage) == freeBefore,
+			"Child's cached blocks lost in reclamation.");
+	psm_audit(wm);
+
+	psm_erase(wm);
+	sm_ShmDetach(space);
+	sm_ShmDestroy(id);
+	CHECK_FINISH;
+}
@@ -0,0 +1,137 @@
+/* Test for shared (read-only) SDR transactions.
+ *
+ * Checks that several threads can be in shared transactions on the
+ * ION SDR at the same time, that an exclusive transaction waits for
+ * all shared transactions to end, that a shared transaction begun
+ * while a writer is waiting waits for the writer, and that an
+ * exclusive transaction can't be begun within a shared one.	*/
+
+#include <ion.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	PATIENCE	(5000000)	/*	Microseconds.		*/
+#define	DELAY		(500000)	/*	Microseconds.		*/
+
+static Sdr		sdr;
+static volatile int	readerIn[2];
+static volatile int	readersMayExit;
+static volatile int	writerIn;
+static volatile int	writerMayExit;
+
+static int	awaitFlag(volatile int *flag)
+{
+	int	waited = 0;
+
+	while (*flag == 0)
+	{
+		if (waited >= PATIENCE)
+		{
+			return 0;
+		}
+
+		microsnooze(10000);
+		waited += 10000;
+	}
+
+	return 1;
+}
+
+static void	*reader(void *parm)
+{
+	int	idx = (int) (uaddr) parm;
+
+	if (sdr_begin_read_xn(sdr) == 0)
+	{
+		return NULL;
+	}
+
+	readerIn[idx] = 1;
+	oK(awaitFlag(&readersMayExit));
+	sdr_exit_xn(sdr);
+	readerIn[idx] = 0;
+	return NULL;
+}
+
+static void	*writer(void *parm)
+{
+	if (sdr_begin_xn(sdr) == 0)
+	{
+		return NULL;
+	}
+
+	writerIn = 1;
+	oK(awaitFlag(&writerMayExit));
+	sdr_exit_xn(sdr);
+	writerIn = 0;
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t	readerThread[2];
+	pthread_t	writerThread;
+
+	_xadmin("ionadmin", "", "sdr.ionrc");
+	sleep(2);
+	fail_unless(ionAttach() >= 0);
+	sdr = getIonsdr();
+
+	/*	A shared transaction permits reading but not writing,
+	 *	and can't be upgraded to an exclusive transaction.	*/
+
+	fail_unless(sdr_begin_read_xn(sdr) == 1);
+	fail_unless(sdr_in_xn(sdr) == 0);
+	fail_unless(sdr_begin_read_xn(sdr) == 1);	/*	Nested.	*/
+	sdr_exit_xn(sdr);
+	fail_unless(sdr_find(sdr, "iondb", NULL) != 0);
+	fail_unless(sdr_begin_xn(sdr) == 0);
+	sdr_exit_xn(sdr);
+
+	/*	A shared transaction nested in an exclusive one is
+	 *	simply part of the exclusive transaction.		*/
+
+	fail_unless(sdr_begin_xn(sdr) == 1);
+	fail_unless(sdr_begin_read_xn(sdr) == 1);
+	sdr_exit_xn(sdr);
+	fail_unless(sdr_in_xn(sdr) == 1);
+	sdr_exit_xn(sdr);
+	fail_unless(sdr_in_xn(sdr) == 0);
+
+	/*	Readers share the SDR.					*/
+
+	readersMayExit = 0;
+	pthread_begin(&readerThread[0], NULL, reader, (void *) 0, "reader0");
+	fail_unless(awaitFlag(&readerIn[0]));
+	pthread_begin(&readerThread[1], NULL, reader, (void *) 1, "reader1");
+	fail_unless(awaitFlag(&readerIn[1]), "Readers didn't share the SDR.");
+
+	/*	A writer waits for all readers to leave, and a reader
+	 *	arriving while the writer waits must wait as well.	*/
+
+	writerMayExit = 0;
+	pthread_begin(&writerThread, NULL, writer, NULL, "writer");
+	microsnooze(DELAY);
+	fail_unless(writerIn == 0, "Writer didn't wait for readers.");
+	readersMayExit = 1;
+	pthread_join(readerThread[0], NULL);
+	pthread_join(readerThread[1], NULL);
+	fail_unless(awaitFlag(&writerIn), "Writer never got the SDR.");
+	readersMayExit = 0;
+	pthread_begin(&readerThread[0], NULL, reader, (void *) 0, "reader0");
+	microsnooze(DELAY);
+	fail_unless(readerIn[0] == 0, "Reader didn't wait for writer.");
+	writerMayExit = 1;
+	pthread_join(writerThread, NULL);
+	fail_unless(awaitFlag(&readerIn[0]), "Reader never got the SDR.");
+	readersMayExit = 1;
+	pthread_join(readerThread[0], NULL);
+
+	/*	And the SDR is once again available to all.		*/
+
+	fail_unless(sdr_begin_xn(sdr) == 1);
+	sdr_exit_xn(sdr);
+	ionDetach();
+	ionstop();
+	CHECK_FINISH;
+}